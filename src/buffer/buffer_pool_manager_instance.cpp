@@ -12,59 +12,309 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cmath>
+#include <future>  // NOLINT
+#include <new>
+#include <utility>
+#include <vector>
+
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     const FrameMemoryOptions &frame_memory)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, frame_memory) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type,
+                                                     const FrameMemoryOptions &frame_memory)
     : pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
-      next_page_id_(instance_index),
+      frames_(pool_size * PAGE_SIZE, frame_memory),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(pool_size) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // The buffer pool is one consecutive memory space. Frames are aligned to PAGE_SIZE so that they can be handed to
+  // the disk manager as they are, even when it does direct I/O. Constructing the pages zeroes the frames, which is
+  // what places their memory.
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(frames_.GetData() + i * PAGE_SIZE);
+  }
+  io_done_ = new std::condition_variable[pool_size_];
+  switch (replacer_type) {
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerType::TWO_Q:
+      replacer_ = new TwoQReplacer(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
     pages_[i].page_id_ = INVALID_PAGE_ID;
     pages_[i].is_dirty_ = false;
-    pages_[i].pin_count_ = 0;
+    pages_[i].pin_count_ = CLAIMED;
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopBackgroundFlusher();
+  {
+    // Prefetch completions still refer to our frames.
+    std::unique_lock<std::mutex> lock(latch_);
+    prefetches_done_.wait(lock, [this] { return prefetches_in_flight_ == 0; });
+  }
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
+  delete[] io_done_;
   delete replacer_;
 }
 
+BufferPoolStats BufferPoolManagerInstance::GetStats() {
+  BufferPoolStats stats;
+  stats.hits_ = num_hits_;
+  stats.misses_ = num_misses_;
+  stats.dirty_evictions_ = num_dirty_evictions_;
+  stats.clean_evictions_ = num_clean_evictions_;
+  stats.prefetches_ = num_prefetches_;
+  stats.background_flushes_ = num_background_flushes_;
+  stats.latch_waits_ = num_latch_waits_;
+  stats.read_errors_ = num_read_errors_;
+  return stats;
+}
+
+void BufferPoolManagerInstance::StartBackgroundFlusher(const BackgroundFlusherOptions &options) {
+  BUSTUB_ASSERT(options.target_clean_fraction_ >= 0 && options.target_clean_fraction_ <= 1,
+                "The target fraction of clean frames must be between 0 and 1.");
+  BUSTUB_ASSERT(options.max_batch_size_ > 0, "The flusher must be allowed to write at least one page per batch.");
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (flusher_running_) {
+    return;
+  }
+  flusher_options_ = options;
+  flusher_running_ = true;
+  flusher_stop_ = false;
+  flusher_thread_ = std::thread(&BufferPoolManagerInstance::RunFlusher, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundFlusher() {
+  {
+    std::lock_guard<std::mutex> lock_guard(latch_);
+    if (!flusher_running_) {
+      return;
+    }
+    flusher_stop_ = true;
+    flusher_wakeup_.notify_all();
+  }
+  flusher_thread_.join();
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  flusher_running_ = false;
+}
+
+void BufferPoolManagerInstance::RunFlusher() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!flusher_stop_) {
+    flush_requested_ = false;
+    if (FlushDirtyFrames(&lock) == 0) {
+      flusher_wakeup_.wait_for(lock, flusher_options_.interval_, [this] { return flusher_stop_ || flush_requested_; });
+    }
+  }
+}
+
+size_t BufferPoolManagerInstance::FlushDirtyFrames(std::unique_lock<std::mutex> *lock) {
+  // Look for pages to write back without latch_. The flags may change under us, which is fine: a page is checked
+  // again once its frame has been claimed. Every round starts where the last one left off, so that no frame is
+  // favoured.
+  lock->unlock();
+  size_t num_dirty = 0;
+  std::vector<frame_id_t> candidates;
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto frame_id = static_cast<frame_id_t>((flusher_cursor_ + i) % pool_size_);
+    auto &page = pages_[frame_id];
+    if (page.is_dirty_) {
+      num_dirty++;
+      if (page.pin_count_ == 0 && !page.io_in_progress_) {
+        candidates.push_back(frame_id);
+      }
+    }
+  }
+  auto min_clean = static_cast<size_t>(std::ceil(flusher_options_.target_clean_fraction_ * pool_size_));
+  auto num_clean = pool_size_ - num_dirty;
+  lock->lock();
+  if (num_clean >= min_clean || candidates.empty()) {
+    return 0;
+  }
+  candidates.resize(std::min({candidates.size(), min_clean - num_clean, flusher_options_.max_batch_size_}));
+  flusher_cursor_ = (candidates.back() + 1) % pool_size_;
+
+  // Like a dirty victim in FindFreshPage(), a page stays in the page table, unclaimed, while it is written back.
+  // Fetchers wait for the write to finish, so that nobody changes the page meanwhile.
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  for (auto frame_id : candidates) {
+    if (!ClaimFrame(frame_id)) {
+      continue;
+    }
+    auto &page = pages_[frame_id];
+    // The log records of a page have to be on disk before the page is (WAL).
+    bool log_persistent =
+        !enable_logging || log_manager_ == nullptr || page.GetLSN() <= log_manager_->GetPersistentLSN();
+    if (page.is_dirty_ && !page.io_in_progress_ && log_persistent) {
+      page.is_dirty_ = false;
+      page.io_in_progress_ = true;
+      batch.emplace_back(page.page_id_, frame_id);
+    }
+    page.pin_count_ = 0;
+  }
+  if (batch.empty()) {
+    return 0;
+  }
+
+  // Writes that are submitted together go to the disk together, in page id order.
+  std::sort(batch.begin(), batch.end());
+  lock->unlock();
+  std::vector<std::future<bool>> writes;
+  writes.reserve(batch.size());
+  for (auto [page_id, frame_id] : batch) {
+    writes.push_back(disk_manager_->SubmitWritePage(page_id, pages_[frame_id].GetData()));
+  }
+  std::vector<bool> written;
+  written.reserve(writes.size());
+  for (auto &write : writes) {
+    written.push_back(write.get());
+  }
+  lock->lock();
+  for (size_t i = 0; i < batch.size(); i++) {
+    auto frame_id = batch[i].second;
+    auto &page = pages_[frame_id];
+    if (!written[i]) {
+      page.is_dirty_ = true;
+    }
+    page.io_in_progress_ = false;
+    io_done_[frame_id].notify_all();
+    // An eviction that picked the page meanwhile skipped it, and took it out of the replacer.
+    if (page.pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+  num_background_flushes_ += std::count(written.begin(), written.end(), true);
+  return batch.size();
+}
+
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
-  std::lock_guard<std::mutex> lock_guard(latch_);
-  if (page_table_.count(page_id) == 0) {
+  auto lock = LockLatch();
+  auto frame_id = FindPage(page_id);
+  while (frame_id != -1 && pages_[frame_id].io_in_progress_) {
+    // The page may be evicted while we wait, so look it up again.
+    WaitForIo(frame_id, &lock);
+    frame_id = FindPage(page_id);
+  }
+  if (frame_id == -1) {
     return false;
   }
-  FlushPg(page_id);
-  pages_[page_table_[page_id]].is_dirty_ = false;
+  auto &page = pages_[frame_id];
+  if (!page.is_dirty_) {
+    return true;
+  }
+  // Like WriteBackDirtyPages(), clear the dirty flag before the write, so that an unpin that dirties the page again
+  // meanwhile is not lost, and mark the page io_in_progress_ so that it can be neither fetched nor evicted while it is
+  // written without latch_.
+  page.is_dirty_ = false;
+  page.io_in_progress_ = true;
+  lock.unlock();
+  bool written = disk_manager_->WritePage(page_id, page.GetData());
+  lock.lock();
+  page.io_in_progress_ = false;
+  io_done_[frame_id].notify_all();
+  if (!written) {
+    // The page is still only in memory. It stays out of the replacer until it is next unpinned, as evicting it would
+    // only fail the same way.
+    page.is_dirty_ = true;
+    if (page.pin_count_ == 0) {
+      replacer_->Pin(frame_id);
+    }
+    return false;
+  }
+  // An eviction that picked the page meanwhile skipped it, and took it out of the replacer.
+  if (page.pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   // You can do it!
-  for (const auto &page : page_table_) {
-    FlushPgImp(page.first);
+  WriteBackDirtyPages();
+  disk_manager_->SyncDbFile();
+}
+
+void BufferPoolManagerInstance::WriteBackDirtyPages() {
+  // Take a snapshot of the dirty pages in one go. Like a dirty victim in FindFreshPage(), each of them is marked
+  // io_in_progress_ while it is written, so that it can be neither fetched nor evicted meanwhile. Writes that are
+  // already in progress are waited for, so that every page that is dirty now is on disk when we return.
+  auto lock = LockLatch();
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    auto &page = pages_[frame_id];
+    WaitForIo(frame_id, &lock);
+    if (page.page_id_ != INVALID_PAGE_ID && page.is_dirty_) {
+      page.is_dirty_ = false;
+      page.io_in_progress_ = true;
+      dirty_pages.emplace_back(page.page_id_, frame_id);
+    }
+  }
+  if (dirty_pages.empty()) {
+    return;
+  }
+  lock.unlock();
+
+  // Sort by page id, so that runs of consecutive pages go out as one write.
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+  std::vector<const char *> run;
+  std::vector<bool> written(dirty_pages.size());
+  for (size_t i = 0; i < dirty_pages.size(); i++) {
+    run.push_back(pages_[dirty_pages[i].second].GetData());
+    if (i + 1 == dirty_pages.size() || dirty_pages[i + 1].first != dirty_pages[i].first + 1) {
+      bool success = disk_manager_->WritePages(dirty_pages[i].first - static_cast<page_id_t>(run.size()) + 1, run);
+      std::fill(written.begin() + (i + 1 - run.size()), written.begin() + (i + 1), success);
+      run.clear();
+    }
+  }
+
+  lock.lock();
+  for (size_t i = 0; i < dirty_pages.size(); i++) {
+    auto frame_id = dirty_pages[i].second;
+    // A run that failed may be only partly on disk, so all of its pages are still dirty.
+    if (!written[i]) {
+      pages_[frame_id].is_dirty_ = true;
+    }
+    pages_[frame_id].io_in_progress_ = false;
+    io_done_[frame_id].notify_all();
+    // An eviction that picked the page meanwhile skipped it, and took it out of the replacer.
+    if (pages_[frame_id].pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
   }
 }
 
@@ -74,18 +324,22 @@ Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::lock_guard<std::mutex> lock_guard(latch_);
-  auto frame_id = FindFreshPage();
+  auto lock = LockLatch();
+  auto frame_id = FindFreshPage(&lock);
   if (frame_id == -1) {
     return nullptr;
   }
-  pages_[frame_id].pin_count_++;
-  pages_[frame_id].page_id_ = AllocatePage();
-  page_table_[pages_[frame_id].page_id_] = frame_id;
+  auto &page = pages_[frame_id];
+  page.page_id_ = AllocatePage();
+  memset(page.GetData(), 0, PAGE_SIZE);
+  page_table_.Insert(page.page_id_, frame_id);
+  replacer_->RecordAccess(frame_id, page.page_id_);
+  // Setting the pin count releases the claim on the frame.
+  page.pin_count_ = 1;
+  num_pinned_frames_++;
 
-  *page_id = pages_[frame_id].GetPageId();
-  memset(pages_[frame_id].GetData(), 0, PAGE_SIZE);
-  return &pages_[frame_id];
+  *page_id = page.GetPageId();
+  return &page;
 }
 
 Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
@@ -96,105 +350,351 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::lock_guard<std::mutex> lock_guard(latch_);
-  auto frame_id = FindPage(page_id);
+  // A hit only needs latch_ if it has to wait for I/O. If the lock-free lookup misses P, look again under latch_.
+  auto frame_id = page_table_.Find(page_id);
+  if (frame_id != -1 && TryPinFrame(frame_id, page_id)) {
+    if (pages_[frame_id].io_in_progress_) {
+      auto lock = LockLatch();
+      WaitForIo(frame_id, &lock);
+      if (pages_[frame_id].page_id_ != page_id) {
+        // The read we waited for failed.
+        UnpinFrame(frame_id);
+        return nullptr;
+      }
+    }
+    num_hits_++;
+    return &pages_[frame_id];
+  }
+
+  auto lock = LockLatch();
+  frame_id = FindPage(page_id);
   if (frame_id != -1) {
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
-    pages_[frame_id].is_dirty_ = true;
+    if (!PinFrame(frame_id, &lock)) {
+      return nullptr;
+    }
+    num_hits_++;
     return &pages_[frame_id];
   }
 
-  frame_id = FindFreshPage();
+  frame_id = FindFreshPage(&lock);
   if (frame_id == -1) {
     return nullptr;
   }
-  page_table_[page_id] = frame_id;
-  replacer_->Pin(page_table_[page_id]);
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].pin_count_++;
-  pages_[frame_id].is_dirty_ = false;
-  disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+  // Writing back the victim released the latch, so somebody else may have brought P in by now.
+  auto existing_frame_id = FindPage(page_id);
+  if (existing_frame_id != -1) {
+    free_list_.push_front(frame_id);
+    if (!PinFrame(existing_frame_id, &lock)) {
+      return nullptr;
+    }
+    num_hits_++;
+    return &pages_[existing_frame_id];
+  }
+
+  // P goes into the page table before it is read, so that concurrent fetchers of P wait for this read instead of
+  // issuing their own.
+  auto &page = pages_[frame_id];
+  page.page_id_ = page_id;
+  page.is_dirty_ = false;
+  page.io_in_progress_ = true;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->RecordAccess(frame_id, page_id);
+  page.pin_count_ = 1;
+  num_pinned_frames_++;
+  num_misses_++;
+  lock.unlock();
+  bool success = disk_manager_->ReadPage(page_id, page.GetData());
+  lock.lock();
+  if (!success) {
+    // The page is corrupted or could not be read, and must not be handed out. Anybody waiting for it gets nullptr too.
+    if (page.pin_count_.fetch_sub(1) == 1) {
+      num_pinned_frames_--;
+    }
+    DropUnreadPage(frame_id);
+    return nullptr;
+  }
+  page.io_in_progress_ = false;
+  io_done_[frame_id].notify_all();
+
+  return &page;
+}
+
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id) {
+  auto lock = LockLatch();
+  if (FindPage(page_id) != -1) {
+    return;
+  }
+  auto frame_id = FindFreshPage(&lock);
+  if (frame_id == -1) {
+    return;
+  }
+  if (FindPage(page_id) != -1) {
+    free_list_.push_front(frame_id);
+    return;
+  }
 
-  return &pages_[frame_id];
+  // Like a miss in FetchPgImp, except that nobody holds a pin: the frame is kept out of the replacer until the read
+  // completes, and anyone fetching the page meanwhile waits for it.
+  auto &page = pages_[frame_id];
+  page.page_id_ = page_id;
+  page.is_dirty_ = false;
+  page.io_in_progress_ = true;
+  page_table_.Insert(page_id, frame_id);
+  page.pin_count_ = 0;
+  prefetches_in_flight_++;
+  num_prefetches_++;
+  lock.unlock();
+  disk_manager_->SubmitReadPage(page_id, page.GetData(), [this, frame_id](bool success) {
+    std::scoped_lock latch(latch_);
+    auto &page = pages_[frame_id];
+    if (!success) {
+      DropUnreadPage(frame_id);
+    } else {
+      page.io_in_progress_ = false;
+      if (page.pin_count_ == 0) {
+        replacer_->Unpin(frame_id);
+      }
+      io_done_[frame_id].notify_all();
+    }
+    if (--prefetches_in_flight_ == 0) {
+      prefetches_done_.notify_all();
+    }
+  });
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
+  // 1.   If P does not exist, return whether it was allocated, so that deleting a page twice fails.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  std::lock_guard<std::mutex> lock_guard(latch_);
-  DeallocatePage(page_id);
+  auto lock = LockLatch();
   auto frame_id = FindPage(page_id);
+  while (frame_id != -1 && pages_[frame_id].io_in_progress_) {
+    WaitForIo(frame_id, &lock);
+    frame_id = FindPage(page_id);
+  }
   if (frame_id != -1) {
-    if (pages_[frame_id].GetPinCount() != 0) {
+    if (!ClaimFrame(frame_id)) {
       return false;
     }
-    page_table_.erase(page_id);
+    replacer_->Remove(frame_id);
+    page_table_.Erase(page_id);
     pages_[frame_id].page_id_ = INVALID_PAGE_ID;
     pages_[frame_id].is_dirty_ = false;
     memset(pages_[frame_id].GetData(), 0, PAGE_SIZE);
     free_list_.push_back(frame_id);
   }
-  return true;
+  // Only now that nobody can be using it may the page be handed out again.
+  return DeallocatePage(page_id);
 }
 
 bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  std::lock_guard<std::mutex> lock_guard(latch_);
-  auto frame_id = FindPage(page_id);
-  if (frame_id == -1 || pages_[frame_id].pin_count_ == 0) {
+  // The caller's pin keeps the page in its frame, but the lock-free lookup can miss it while Erase() moves it.
+  auto frame_id = page_table_.Find(page_id);
+  if (frame_id == -1 || pages_[frame_id].page_id_ != page_id) {
+    auto lock = LockLatch();
+    frame_id = FindPage(page_id);
+  }
+  if (frame_id == -1) {
+    return false;
+  }
+  auto &page = pages_[frame_id];
+  auto pin_count = page.pin_count_.load();
+  if (pin_count <= 0) {
     return false;
   }
-  pages_[frame_id].is_dirty_ = is_dirty;
-  if (--pages_[frame_id].pin_count_ == 0) {
+  // Only ever set the dirty flag here: a clean unpin must not hide the changes of an earlier dirty one. The page is
+  // written back when it is evicted or flushed. It is set before the pin is dropped, so that whoever claims the
+  // frame next sees it.
+  if (is_dirty) {
+    page.is_dirty_ = true;
+  }
+  while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+    if (pin_count <= 0) {
+      return false;
+    }
+  }
+  if (pin_count == 1) {
+    num_pinned_frames_--;
     replacer_->Unpin(frame_id);
-    FlushPg(page_id);
   }
   return true;
 }
 
+uint32_t BufferPoolManagerInstance::InstanceOf(page_id_t page_id, uint32_t num_instances) {
+  auto group = static_cast<uint32_t>(page_id) / num_instances;
+  return (static_cast<uint32_t>(page_id) % num_instances + GroupShift(group, num_instances)) % num_instances;
+}
+
+uint32_t BufferPoolManagerInstance::GroupShift(uint32_t group, uint32_t num_instances) {
+  // Fibonacci hashing. Group 0 is not shifted, so that a parallel BPM starts out with page 0 in instance 0.
+  return ((group * 2654435761U) >> 16) % num_instances;
+}
+
 page_id_t BufferPoolManagerInstance::AllocatePage() {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
+  // The disk manager is shared by all instances of a parallel BPM, we can only take the pages that route to us.
+  const page_id_t next_page_id = disk_manager_->AllocatePage(
+      [this](page_id_t page_id) { return InstanceOf(page_id, num_instances_) == instance_index_; });
   ValidatePageId(next_page_id);
   return next_page_id;
 }
 
+bool BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) { return disk_manager_->DeallocatePage(page_id); }
+
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
-  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+  assert(InstanceOf(page_id, num_instances_) == instance_index_);  // allocated pages route back to this BPI
 }
 
-frame_id_t BufferPoolManagerInstance::FindFreshPage() {
+frame_id_t BufferPoolManagerInstance::FindFreshPage(std::unique_lock<std::mutex> *lock) {
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
+  while (true) {
+    if (!free_list_.empty()) {
+      frame_id = free_list_.front();
+      free_list_.pop_front();
+      return frame_id;
+    }
+    if (!replacer_->Victim(&frame_id)) {
+      return -1;
+    }
+    // Pins taken without latch_ do not wait for the replacer to catch up, so the victim may have been pinned since.
+    // Its pin will hand it back to the replacer once it is dropped.
+    if (!ClaimFrame(frame_id)) {
+      continue;
+    }
+    auto &page = pages_[frame_id];
+    if (page.io_in_progress_) {
+      // A prefetch is still reading it in, or the background flusher or FlushAllPages() is writing it back. Each of
+      // them hands the frame back to the replacer once done.
+      page.pin_count_ = 0;
+      continue;
+    }
+    if (!page.is_dirty_) {
+      num_clean_evictions_++;
+    } else {
+      // The background flusher has fallen behind, have it start its next round now.
+      if (flusher_running_) {
+        flush_requested_ = true;
+        flusher_wakeup_.notify_all();
+      }
+      // The victim stays in the page table, unclaimed, while it is written back, so its page can still be fetched
+      // (fetchers wait for the write to finish). Clearing the dirty flag first lets us notice if it is dirtied again
+      // meanwhile.
+      page.is_dirty_ = false;
+      page.io_in_progress_ = true;
+      page.pin_count_ = 0;
+      lock->unlock();
+      bool written = disk_manager_->WritePage(page.page_id_, page.GetData());
+      lock->lock();
+      page.io_in_progress_ = false;
+      io_done_[frame_id].notify_all();
+      if (!written) {
+        // The victim stays in the buffer pool, dirty and out of the replacer until it is next unpinned, and the
+        // caller gets no frame.
+        page.is_dirty_ = true;
+        return -1;
+      }
+      if (!ClaimFrame(frame_id)) {
+        // Somebody wants the victim after all, it goes back to the replacer once it is unpinned.
+        continue;
+      }
+      if (page.is_dirty_) {
+        // It was pinned and unpinned again, which already handed it back to the replacer.
+        page.pin_count_ = 0;
+        continue;
+      }
+      num_dirty_evictions_++;
+    }
+    // It may already be back in the replacer if it was pinned and unpinned while we were writing.
+    replacer_->Remove(frame_id);
+    page_table_.Erase(page.page_id_);
+    page.page_id_ = INVALID_PAGE_ID;
     return frame_id;
   }
-  if (replacer_->Victim(&frame_id)) {
-    auto page_id = pages_[frame_id].page_id_;
-    FlushPg(page_id);
-    page_table_.erase(page_id);
-    pages_[frame_id].is_dirty_ = false;
-    return frame_id;
+}
+
+bool BufferPoolManagerInstance::PinFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  // Pin first, so that the frame cannot be evicted while we wait. Frames in the page table are only ever claimed
+  // under latch_, so this one is not.
+  page_id_t page_id = pages_[frame_id].page_id_;
+  if (pages_[frame_id].pin_count_++ == 0) {
+    num_pinned_frames_++;
+    replacer_->Pin(frame_id);
+  }
+  replacer_->RecordAccess(frame_id, page_id);
+  WaitForIo(frame_id, lock);
+  if (pages_[frame_id].page_id_ != page_id) {
+    UnpinFrame(frame_id);
+    return false;
   }
-  return -1;
+  return true;
 }
 
-void BufferPoolManagerInstance::FlushPg(page_id_t page_id) {
-  auto frame_id = FindPage(page_id);
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+bool BufferPoolManagerInstance::TryPinFrame(frame_id_t frame_id, page_id_t page_id) {
+  auto &page = pages_[frame_id];
+  auto pin_count = page.pin_count_.load();
+  do {
+    if (pin_count == CLAIMED) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  if (pin_count == 0) {
+    num_pinned_frames_++;
+  }
+  // The frame cannot be claimed while we hold the pin, but it may have been given to another page before we got it.
+  if (page.page_id_ != page_id) {
+    UnpinFrame(frame_id);
+    return false;
+  }
+  if (pin_count == 0) {
+    replacer_->Pin(frame_id);
   }
+  replacer_->RecordAccess(frame_id, page_id);
+  return true;
 }
 
-frame_id_t BufferPoolManagerInstance::FindPage(page_id_t page_id) {
-  auto iter = page_table_.find(page_id);
-  if (iter != page_table_.cend()) {
-    return iter->second;
+void BufferPoolManagerInstance::DropUnreadPage(frame_id_t frame_id) {
+  auto &page = pages_[frame_id];
+  num_read_errors_++;
+  page_table_.Erase(page.page_id_);
+  page.page_id_ = INVALID_PAGE_ID;
+  memset(page.GetData(), 0, PAGE_SIZE);
+  page.io_in_progress_ = false;
+  io_done_[frame_id].notify_all();
+  // Whoever still pins the frame hands it to the replacer when they let go of it.
+  if (ClaimFrame(frame_id)) {
+    replacer_->Remove(frame_id);
+    free_list_.push_back(frame_id);
   }
-  return -1;
+}
+
+void BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) {
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    num_pinned_frames_--;
+    replacer_->Unpin(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, CLAIMED);
+}
+
+std::unique_lock<std::mutex> BufferPoolManagerInstance::LockLatch() {
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    num_latch_waits_++;
+    lock.lock();
+  }
+  return lock;
+}
+
+void BufferPoolManagerInstance::WaitForIo(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  io_done_[frame_id].wait(*lock, [this, frame_id] { return !pages_[frame_id].io_in_progress_; });
+}
+
+frame_id_t BufferPoolManagerInstance::FindPage(page_id_t page_id) {
+  // Under latch_ nobody is changing the page table, so the lookup cannot miss.
+  return page_table_.Find(page_id);
 }
 }  // namespace bustub
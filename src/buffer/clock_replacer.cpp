@@ -14,16 +14,48 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : frames_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
-
-void ClockReplacer::Pin(frame_id_t frame_id) {}
-
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
-
-size_t ClockReplacer::Size() { return 0; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // Without concurrent unpins two sweeps are enough: the first one clears every reference bit.
+  while (size_.load() != 0) {
+    auto frame = hand_.fetch_add(1) % frames_.size();
+    auto bits = frames_[frame].load();
+    if ((bits & IN_REPLACER) == 0) {
+      continue;
+    }
+    if ((bits & REFERENCED) != 0) {
+      // If this fails the frame was pinned or unpinned meanwhile, so it has been used and deserves another round.
+      frames_[frame].compare_exchange_strong(bits, IN_REPLACER);
+      continue;
+    }
+    if (frames_[frame].compare_exchange_strong(bits, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  *frame_id = INVALID_PAGE_ID;
+  return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if ((frames_[frame_id].fetch_and(static_cast<uint8_t>(~IN_REPLACER)) & IN_REPLACER) != 0) {
+    size_--;
+  }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  // Count the frame before it can be found, and uncount it only after it is gone, so that size_ never drops below
+  // the number of frames in the replacer.
+  size_++;
+  if ((frames_[frame_id].fetch_or(IN_REPLACER | REFERENCED) & IN_REPLACER) != 0) {
+    size_--;
+  }
+}
+
+size_t ClockReplacer::Size() { return size_.load(); }
 
 }  // namespace bustub
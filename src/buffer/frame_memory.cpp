@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_memory.cpp
+//
+// Identification: src/buffer/frame_memory.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_memory.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/mempolicy.h>)
+#define BUSTUB_HAS_MBIND
+#include <linux/mempolicy.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** Size of the huge pages we ask for. */
+static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+FrameMemory::FrameMemory(size_t size, const FrameMemoryOptions &options) {
+  if (options.huge_pages_) {
+    mapped_size_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *data = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<char *>(data);
+      uses_huge_pages_ = true;
+    } else if (MapAligned(HUGE_PAGE_SIZE)) {
+      // No huge pages are reserved, ask for transparent ones. The mapping is aligned so that every 2MB of it can be.
+      uses_huge_pages_ = madvise(data_, mapped_size_, MADV_HUGEPAGE) == 0;
+    }
+    if (!uses_huge_pages_) {
+      LOG_WARN("huge pages are not available, the buffer pool uses ordinary pages");
+    }
+  }
+  if (data_ == nullptr) {
+    mapped_size_ = size;
+    [[maybe_unused]] bool mapped = MapAligned(PAGE_SIZE);
+    BUSTUB_ASSERT(mapped, "Couldn't allocate the buffer pool frames.");
+  }
+
+  if (options.numa_node_ >= 0) {
+#ifdef BUSTUB_HAS_MBIND
+    constexpr size_t bits_per_word = 8 * sizeof(unsigned long);  // NOLINT
+    std::vector<unsigned long> node_mask(options.numa_node_ / bits_per_word + 1, 0);  // NOLINT
+    node_mask[options.numa_node_ / bits_per_word] |= 1UL << (options.numa_node_ % bits_per_word);
+    is_bound_to_node_ = syscall(SYS_mbind, data_, mapped_size_, MPOL_BIND, node_mask.data(),
+                                node_mask.size() * bits_per_word + 1, 0) == 0;
+#endif
+    if (!is_bound_to_node_) {
+      LOG_WARN("couldn't bind the buffer pool to NUMA node %d", options.numa_node_);
+    }
+  }
+}
+
+FrameMemory::~FrameMemory() { munmap(data_, mapped_size_); }
+
+bool FrameMemory::MapAligned(size_t alignment) {
+  // Over-allocate by the alignment and unmap what sticks out on either side.
+  auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  mapped_size_ = (mapped_size_ + os_page_size - 1) / os_page_size * os_page_size;
+  size_t padded_size = mapped_size_ + alignment;
+  void *data = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  auto begin = reinterpret_cast<uintptr_t>(data);
+  auto aligned = (begin + alignment - 1) / alignment * alignment;
+  if (aligned != begin) {
+    munmap(data, aligned - begin);
+  }
+  size_t tail = begin + padded_size - (aligned + mapped_size_);
+  if (tail != 0) {
+    munmap(reinterpret_cast<void *>(aligned + mapped_size_), tail);
+  }
+  data_ = reinterpret_cast<char *>(aligned);
+  return true;
+}
+
+}  // namespace bustub
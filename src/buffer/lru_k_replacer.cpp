@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_reference_period)
+    : k_(k),
+      correlated_reference_period_(correlated_reference_period != 0 ? correlated_reference_period : num_pages),
+      frames_(num_pages) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (evictable_.empty()) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+  *frame_id = std::get<2>(*evictable_.begin());
+  MakeUnevictable(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  MakeUnevictable(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  if (frame.accesses_.empty()) {
+    // Read in without being accessed (i.e. prefetched), it ages from now on.
+    frame.last_access_ = ++current_time_;
+  }
+  frame.evictable_ = true;
+  frame.key_ = MakeKey(frame_id);
+  evictable_.insert(frame.key_);
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  return evictable_.size();
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  auto &frame = frames_[frame_id];
+  auto now = ++current_time_;
+  bool correlated = !frame.accesses_.empty() && now - frame.last_access_ <= correlated_reference_period_;
+  frame.last_access_ = now;
+  if (correlated) {
+    return;
+  }
+  frame.accesses_.push_back(now);
+  if (frame.accesses_.size() > k_) {
+    frame.accesses_.pop_front();
+  }
+  if (frame.evictable_) {
+    evictable_.erase(frame.key_);
+    frame.key_ = MakeKey(frame_id);
+    evictable_.insert(frame.key_);
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  MakeUnevictable(frame_id);
+  frames_[frame_id].accesses_.clear();
+  frames_[frame_id].last_access_ = 0;
+}
+
+LRUKReplacer::Key LRUKReplacer::MakeKey(frame_id_t frame_id) const {
+  const auto &frame = frames_[frame_id];
+  if (frame.accesses_.empty()) {
+    return {false, frame.last_access_, frame_id};
+  }
+  return {frame.accesses_.size() == k_, frame.accesses_.front(), frame_id};
+}
+
+void LRUKReplacer::MakeUnevictable(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  if (!frame.evictable_) {
+    return;
+  }
+  evictable_.erase(frame.key_);
+  frame.evictable_ = false;
+}
+
+}  // namespace bustub
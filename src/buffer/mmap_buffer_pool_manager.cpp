@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(const std::string &db_file) {
+  // A compressed database file (see DiskManager) does not hold its pages at page_id * PAGE_SIZE.
+  std::string::size_type n = db_file.rfind('.');
+  if (n != std::string::npos && access((db_file.substr(0, n) + ".map").c_str(), F_OK) == 0) {
+    throw Exception("can't map a compressed db file");
+  }
+
+  int fd = open(db_file.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd == -1 || fstat(fd, &file_stat) == -1) {
+    if (fd != -1) {
+      close(fd);
+    }
+    throw Exception("can't open db file");
+  }
+  num_pages_ = file_stat.st_size / PAGE_SIZE;
+  if (num_pages_ > 0) {
+    void *data = mmap(nullptr, num_pages_ * PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw Exception("can't map db file");
+    }
+    data_ = static_cast<char *>(data);
+  }
+  // The mapping stays valid without the file descriptor.
+  close(fd);
+
+  pages_ = std::make_unique<std::atomic<Page *>[]>(num_pages_);
+  for (size_t i = 0; i < num_pages_; i++) {
+    pages_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  for (size_t i = 0; i < num_pages_; i++) {
+    delete pages_[i].load(std::memory_order_relaxed);
+  }
+  if (data_ != nullptr) {
+    munmap(data_, num_pages_ * PAGE_SIZE);
+  }
+}
+
+BufferPoolStats MmapBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  stats.hits_ = num_fetches_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+Page *MmapBufferPoolManager::FetchPgImp(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return nullptr;
+  }
+  num_fetches_.fetch_add(1, std::memory_order_relaxed);
+  Page *page = pages_[page_id].load(std::memory_order_acquire);
+  if (page != nullptr) {
+    return page;
+  }
+  // Fetching a page for the first time. If another thread gets there at the same time, use its view.
+  auto *view = new Page(data_ + static_cast<size_t>(page_id) * PAGE_SIZE, page_id);
+  if (pages_[page_id].compare_exchange_strong(page, view, std::memory_order_acq_rel)) {
+    return view;
+  }
+  delete view;
+  return page;
+}
+
+bool MmapBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  if (is_dirty) {
+    LOG_WARN("page %d was unpinned as dirty, but it is read-only", page_id);
+    return false;
+  }
+  return true;
+}
+
+bool MmapBufferPoolManager::FlushPgImp(page_id_t page_id) {
+  return page_id >= 0 && static_cast<size_t>(page_id) < num_pages_;
+}
+
+Page *MmapBufferPoolManager::NewPgImp(page_id_t *page_id) {
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool MmapBufferPoolManager::DeletePgImp(page_id_t page_id) { return false; }
+
+void MmapBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return;
+  }
+  // madvise() wants an address aligned to the operating system's page size, which may be larger than PAGE_SIZE.
+  static const auto os_page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto begin = reinterpret_cast<uintptr_t>(data_ + static_cast<size_t>(page_id) * PAGE_SIZE);
+  auto aligned_begin = begin / os_page_size * os_page_size;
+  madvise(reinterpret_cast<void *>(aligned_begin), begin + PAGE_SIZE - aligned_begin, MADV_WILLNEED);
+}
+
+}  // namespace bustub
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.cpp
+//
+// Identification: src/buffer/page_guard.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_guard.h"
+
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+ReadPageGuard::ReadPageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page) {
+  if (page_ != nullptr) {
+    page_->RLatch();
+  }
+}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_), page_(std::exchange(other.page_, nullptr)) {}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = std::exchange(other.page_, nullptr);
+  }
+  return *this;
+}
+
+void ReadPageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  auto page_id = page_->GetPageId();
+  page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  page_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page) {
+  if (page_ != nullptr) {
+    page_->WLatch();
+  }
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(std::exchange(other.page_, nullptr)),
+      is_dirty_(std::exchange(other.is_dirty_, false)) {}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = std::exchange(other.page_, nullptr);
+    is_dirty_ = std::exchange(other.is_dirty_, false);
+  }
+  return *this;
+}
+
+void WritePageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  auto page_id = page_->GetPageId();
+  page_->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, is_dirty_);
+  page_ = nullptr;
+  is_dirty_ = false;
+}
+
+}  // namespace bustub
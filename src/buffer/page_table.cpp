@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : hash_bits_(1) {
+  while ((size_t{1} << hash_bits_) < 2 * num_frames) {
+    hash_bits_++;
+  }
+  mask_ = (size_t{1} << hash_bits_) - 1;
+  slots_.reset(new std::atomic<uint64_t>[mask_ + 1]);
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+frame_id_t PageTable::Find(page_id_t page_id) const {
+  // The table is never full, so there always is an empty slot to stop at.
+  for (size_t i = HomeOf(page_id);; i = (i + 1) & mask_) {
+    auto slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return -1;
+    }
+    if (PageIdOf(slot) == page_id) {
+      return FrameIdOf(slot);
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  for (size_t i = HomeOf(page_id);; i = (i + 1) & mask_) {
+    if (slots_[i].load(std::memory_order_relaxed) == EMPTY_SLOT) {
+      slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  size_t hole = HomeOf(page_id);
+  while (true) {
+    auto slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return;
+    }
+    if (PageIdOf(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Rather than leaving a tombstone, move later entries of the same probe sequence back into the hole. An entry is
+  // copied into the hole before its old slot is reused or emptied, but a Find() that had already passed the hole
+  // when it was filled misses it.
+  for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_) {
+    auto slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    // The entry must stay if its home lies cyclically in (hole, i].
+    size_t home = HomeOf(PageIdOf(slot));
+    bool stays = hole <= i ? hole < home && home <= i : hole < home || home <= i;
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_release);
+      hole = i;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+}
+
+size_t PageTable::HomeOf(page_id_t page_id) const {
+  // Fibonacci hashing, so that the page ids of an instance, which are consecutive or evenly spaced, spread out.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                             (64 - hash_bits_));
+}
+
+}  // namespace bustub
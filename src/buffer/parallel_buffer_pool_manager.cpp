@@ -12,15 +12,25 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <utility>
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : bpmis_{num_instances}, pool_size_(pool_size) {
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     const FrameMemoryOptions &frame_memory,
+                                                     const std::vector<int> &numa_nodes)
+    : bpmis_{num_instances}, disk_manager_(disk_manager), pool_size_(pool_size) {
   // Allocate and create individual BufferPoolManagerInstances
   for (uint32_t instance_index = 0; instance_index < num_instances; instance_index++) {
-    bpmis_[instance_index] =
-        new BufferPoolManagerInstance(pool_size, num_instances, instance_index, disk_manager, log_manager);
+    auto instance_frame_memory = frame_memory;
+    if (!numa_nodes.empty()) {
+      instance_frame_memory.numa_node_ = numa_nodes[instance_index % numa_nodes.size()];
+    }
+    bpmis_[instance_index] = new BufferPoolManagerInstance(pool_size, num_instances, instance_index, disk_manager,
+                                                           log_manager, replacer_type, instance_frame_memory);
   }
 }
 
@@ -36,9 +46,29 @@ size_t ParallelBufferPoolManager::GetPoolSize() {
   return bpmis_.size() * pool_size_;
 }
 
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto &bpmi : bpmis_) {
+    stats += bpmi->GetStats();
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(const BackgroundFlusherOptions &options) {
+  for (auto &bpmi : bpmis_) {
+    bpmi->StartBackgroundFlusher(options);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto &bpmi : bpmis_) {
+    bpmi->StopBackgroundFlusher();
+  }
+}
+
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  return bpmis_[page_id % bpmis_.size()];
+  return bpmis_[BufferPoolManagerInstance::InstanceOf(page_id, bpmis_.size())];
 }
 
 Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
@@ -57,22 +87,28 @@ bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
 }
 
 Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
-  // create new page. We will request page allocation in a round robin manner from the underlying
-  // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
-  uint32_t start_index = last_alloc_index_;
-  do {
-    auto page = bpmis_[start_index % bpmis_.size()]->NewPage(page_id);
+  // create new page. We will request page allocation from the least loaded BufferPoolManagerInstance, i.e. the one
+  // with the fewest pinned frames, so that no instance fills up while others sit idle.
+  // 1.   Skip the instances whose frames are all pinned, NewPage() would fail on them anyway.
+  // 2.   Try the others from the least loaded one on, until one succeeds. The counts may be out of date by then.
+  // 3.   Break ties round robin, starting one instance further on every call.
+  const auto num_instances = static_cast<uint32_t>(bpmis_.size());
+  const uint32_t start_index = next_alloc_index_++;
+  std::vector<std::pair<size_t, uint32_t>> candidates;
+  candidates.reserve(num_instances);
+  for (uint32_t i = 0; i < num_instances; i++) {
+    auto num_pinned_frames = bpmis_[(start_index + i) % num_instances]->GetNumPinnedFrames();
+    if (num_pinned_frames < pool_size_) {
+      candidates.emplace_back(num_pinned_frames, i);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (auto [num_pinned_frames, i] : candidates) {
+    auto page = bpmis_[(start_index + i) % num_instances]->NewPage(page_id);
     if (page != nullptr) {
-      last_alloc_index_ = (last_alloc_index_ + 1) % bpmis_.size();
       return page;
     }
-    start_index = (start_index + 1) % bpmis_.size();
-  } while (start_index != last_alloc_index_);
-  last_alloc_index_ = (last_alloc_index_ + 1) % bpmis_.size();
+  }
   return nullptr;
 }
 
@@ -81,11 +117,22 @@ bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
   return GetBufferPoolManager(page_id)->DeletePage(page_id);
 }
 
+void ParallelBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  // Prefetch page_id into responsible BufferPoolManagerInstance
+  GetBufferPoolManager(page_id)->PrefetchPage(page_id);
+}
+
 void ParallelBufferPoolManager::FlushAllPgsImp() {
   // flush all pages from all BufferPoolManagerInstances
-  for (auto &bpmi : bpmis_) {
-    bpmi->FlushAllPages();
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < bpmis_.size(); i++) {
+    threads.emplace_back([bpmi = bpmis_[i]] { bpmi->WriteBackDirtyPages(); });
+  }
+  bpmis_[0]->WriteBackDirtyPages();
+  for (auto &thread : threads) {
+    thread.join();
   }
+  disk_manager_->SyncDbFile();
 }
 
 }  // namespace bustub
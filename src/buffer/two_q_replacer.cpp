@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_pages)
+    : max_a1in_size_(std::max<size_t>(num_pages / 4, 1)),
+      max_a1out_size_(std::max<size_t>(num_pages / 2, 1)),
+      frames_(num_pages) {}
+
+TwoQReplacer::~TwoQReplacer() = default;
+
+bool TwoQReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (a1in_.empty() && am_.empty()) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+  bool from_a1in = !a1in_.empty() && (a1in_size_ > max_a1in_size_ || am_.empty());
+  *frame_id = from_a1in ? a1in_.begin()->second : am_.begin()->second;
+  MakeUnevictable(*frame_id);
+  if (from_a1in) {
+    RememberInA1out(frames_[*frame_id].page_id_);
+  }
+  return true;
+}
+
+void TwoQReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  MakeUnevictable(frame_id);
+}
+
+void TwoQReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  if (frame.queue_ == Queue::NONE) {
+    // Read in without being accessed (i.e. prefetched).
+    frame.queue_ = Queue::A1IN;
+    frame.time_ = ++current_time_;
+    a1in_size_++;
+  }
+  frame.evictable_ = true;
+  EvictableOf(frame)->emplace(frame.time_, frame_id);
+}
+
+size_t TwoQReplacer::Size() {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  return a1in_.size() + am_.size();
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::A1IN && frame.page_id_ != INVALID_PAGE_ID) {
+    // Accesses while in A1in are correlated with the first one.
+    return;
+  }
+  bool evictable = frame.evictable_;
+  MakeUnevictable(frame_id);
+  auto now = ++current_time_;
+  if (frame.queue_ == Queue::AM) {
+    frame.time_ = now;
+  } else {
+    // The first access since the page was read in.
+    frame.page_id_ = page_id;
+    auto it = a1out_index_.find(page_id);
+    if (it != a1out_index_.end()) {
+      a1out_.erase(it->second);
+      a1out_index_.erase(it);
+      if (frame.queue_ == Queue::A1IN) {
+        a1in_size_--;
+      }
+      frame.queue_ = Queue::AM;
+      frame.time_ = now;
+    } else if (frame.queue_ == Queue::NONE) {
+      frame.queue_ = Queue::A1IN;
+      frame.time_ = now;
+      a1in_size_++;
+    }
+  }
+  if (evictable) {
+    frame.evictable_ = true;
+    EvictableOf(frame)->emplace(frame.time_, frame_id);
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  MakeUnevictable(frame_id);
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::A1IN) {
+    a1in_size_--;
+  }
+  frame = FrameState{};
+}
+
+void TwoQReplacer::MakeUnevictable(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  if (!frame.evictable_) {
+    return;
+  }
+  EvictableOf(frame)->erase({frame.time_, frame_id});
+  frame.evictable_ = false;
+}
+
+void TwoQReplacer::RememberInA1out(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || a1out_index_.count(page_id) != 0) {
+    return;
+  }
+  a1out_.push_front(page_id);
+  a1out_index_[page_id] = a1out_.begin();
+  if (a1out_.size() > max_a1out_size_) {
+    a1out_index_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_util.cpp
+//
+// Identification: src/common/util/checksum_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include <array>
+#include <cstring>
+
+#include "common/util/checksum_util.h"
+
+namespace bustub {
+
+/** The CRC32C polynomial, bit-reversed as the crc32 instruction uses it. */
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+static const std::array<uint32_t, 256> &Crc32cTable() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) != 0 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+      }
+      table[i] = crc;
+    }
+    return table;
+  }();
+  return table;
+}
+
+uint32_t ChecksumUtil::Crc32cSoftware(const char *data, size_t length, uint32_t crc) {
+  const auto &table = Crc32cTable();
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+#ifdef __SSE4_2__
+
+/**
+ * The crc32 instruction has a latency of three cycles but can start one every cycle, so a long buffer is checksummed
+ * as three interleaved blocks whose checksums are combined afterwards. 1360 bytes make a 4KB page three blocks and 16
+ * bytes.
+ */
+static constexpr size_t CRC32C_BLOCK_SIZE = 1360;
+
+/** @return a * b modulo the CRC32C polynomial, both bit-reversed */
+static uint32_t MultiplyModPoly(uint32_t a, uint32_t b) {
+  uint32_t product = 0;
+  for (uint32_t bit = 1U << 31; bit != 0; bit >>= 1) {
+    if ((a & bit) != 0) {
+      product ^= b;
+    }
+    b = (b & 1) != 0 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+  }
+  return product;
+}
+
+/** @return x^(8 * length) modulo the CRC32C polynomial, which moves a crc past length bytes of zeros */
+static uint32_t ZerosOperator(size_t length) {
+  uint32_t result = 1U << 31;  // x^0
+  uint32_t power = 1U << 30;   // x^1, squared for every bit of 8 * length
+  for (size_t n = 8 * length; n != 0; n >>= 1) {
+    if ((n & 1) != 0) {
+      result = MultiplyModPoly(result, power);
+    }
+    power = MultiplyModPoly(power, power);
+  }
+  return result;
+}
+
+/**
+ * Multiplying by a fixed operator is linear in the crc, so it can be looked up a byte of the crc at a time. That is
+ * much faster than MultiplyModPoly(), which the combining of the interleaved blocks would otherwise be bound by.
+ */
+class ShiftTable {
+ public:
+  explicit ShiftTable(uint32_t op) {
+    for (size_t byte = 0; byte < 4; byte++) {
+      for (uint32_t value = 0; value < 256; value++) {
+        table_[byte][value] = MultiplyModPoly(op, value << (8 * byte));
+      }
+    }
+  }
+
+  uint32_t Shift(uint32_t crc) const {
+    return table_[0][crc & 0xFF] ^ table_[1][(crc >> 8) & 0xFF] ^ table_[2][(crc >> 16) & 0xFF] ^ table_[3][crc >> 24];
+  }
+
+ private:
+  uint32_t table_[4][256];
+};
+
+static uint64_t LoadWord(const char *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+uint32_t ChecksumUtil::Crc32c(const char *data, size_t length, uint32_t crc) {
+  static const ShiftTable skip_one_block(ZerosOperator(CRC32C_BLOCK_SIZE));
+  static const ShiftTable skip_two_blocks(ZerosOperator(2 * CRC32C_BLOCK_SIZE));
+  // Work on the raw crc register; the inversions cancel out of the combining, which is linear.
+  uint64_t crc0 = ~crc;
+  while (length >= 3 * CRC32C_BLOCK_SIZE) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t i = 0; i < CRC32C_BLOCK_SIZE; i += sizeof(uint64_t)) {
+      crc0 = _mm_crc32_u64(crc0, LoadWord(data + i));
+      crc1 = _mm_crc32_u64(crc1, LoadWord(data + CRC32C_BLOCK_SIZE + i));
+      crc2 = _mm_crc32_u64(crc2, LoadWord(data + 2 * CRC32C_BLOCK_SIZE + i));
+    }
+    crc0 = skip_two_blocks.Shift(static_cast<uint32_t>(crc0)) ^ skip_one_block.Shift(static_cast<uint32_t>(crc1)) ^
+           crc2;
+    data += 3 * CRC32C_BLOCK_SIZE;
+    length -= 3 * CRC32C_BLOCK_SIZE;
+  }
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    crc0 = _mm_crc32_u64(crc0, LoadWord(data));
+  }
+  auto crc32 = static_cast<uint32_t>(crc0);
+  for (; length > 0; data++, length--) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+
+#else
+
+uint32_t ChecksumUtil::Crc32c(const char *data, size_t length, uint32_t crc) {
+  return Crc32cSoftware(data, length, crc);
+}
+
+#endif
+
+}  // namespace bustub
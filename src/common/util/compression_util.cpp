@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.cpp
+//
+// Identification: src/common/util/compression_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/util/compression_util.h"
+
+namespace bustub {
+
+/** Matches are at least this long, shorter ones are not worth the 3 bytes they cost. */
+static constexpr size_t MIN_MATCH = 4;
+/** The LZ4 format wants the last 5 bytes to be literals, and the last match to start 12 bytes before the end. */
+static constexpr size_t LAST_LITERALS = 5;
+static constexpr size_t MATCH_FIND_LIMIT = 12;
+/** Matches are found through a hash table of the last position each 4-byte sequence was seen at. */
+static constexpr int HASH_BITS = 12;
+/** A match is referred to by a 16-bit offset. */
+static constexpr size_t MAX_OFFSET = 65535;
+/** Lengths that do not fit into the 4 bits of a token are continued in extra bytes. */
+static constexpr size_t RUN_MASK = 15;
+
+static uint32_t Load32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static uint32_t HashOf(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append the part of a length beyond RUN_MASK, as bytes of 255 and a final byte below 255. */
+static bool PutLength(size_t length, uint8_t **op, const uint8_t *op_end) {
+  for (; length >= 255; length -= 255) {
+    if (*op >= op_end) {
+      return false;
+    }
+    *(*op)++ = 255;
+  }
+  if (*op >= op_end) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+/** Read what PutLength() appended, adding it to *length. */
+static bool GetLength(const uint8_t **ip, const uint8_t *ip_end, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= ip_end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Append a run of literals followed by a match, or by nothing if match_length is 0 (the last sequence). */
+static bool PutSequence(const uint8_t *literals, size_t literal_length, size_t offset, size_t match_length,
+                        uint8_t **op, const uint8_t *op_end) {
+  if (*op >= op_end) {
+    return false;
+  }
+  uint8_t *token = (*op)++;
+  *token = static_cast<uint8_t>(std::min(literal_length, RUN_MASK) << 4);
+  if (literal_length >= RUN_MASK && !PutLength(literal_length - RUN_MASK, op, op_end)) {
+    return false;
+  }
+  if (static_cast<size_t>(op_end - *op) < literal_length) {
+    return false;
+  }
+  memcpy(*op, literals, literal_length);
+  *op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+  if (op_end - *op < 2) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(offset & 0xFF);
+  *(*op)++ = static_cast<uint8_t>(offset >> 8);
+  match_length -= MIN_MATCH;
+  *token |= static_cast<uint8_t>(std::min(match_length, RUN_MASK));
+  return match_length < RUN_MASK || PutLength(match_length - RUN_MASK, op, op_end);
+}
+
+size_t CompressionUtil::Compress(const char *src, size_t src_length, char *dst, size_t dst_capacity) {
+  const auto *base = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *end = base + src_length;
+  const uint8_t *anchor = base;
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *op_end = op + dst_capacity;
+
+  if (src_length > MATCH_FIND_LIMIT) {
+    // Positions relative to base. Stale or empty entries are harmless, every candidate is checked.
+    uint32_t last_seen[1 << HASH_BITS] = {};
+    const uint8_t *match_limit = end - MATCH_FIND_LIMIT;
+    const uint8_t *match_end = end - LAST_LITERALS;
+    const uint8_t *ip = base;
+    while (ip < match_limit) {
+      uint32_t sequence = Load32(ip);
+      auto &entry = last_seen[HashOf(sequence)];
+      const uint8_t *ref = base + entry;
+      entry = static_cast<uint32_t>(ip - base);
+      if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_OFFSET || Load32(ref) != sequence) {
+        ip++;
+        continue;
+      }
+      // The match may start before where we found it.
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      size_t match_length = MIN_MATCH;
+      while (ip + match_length < match_end && ip[match_length] == ref[match_length]) {
+        match_length++;
+      }
+      if (!PutSequence(anchor, ip - anchor, ip - ref, match_length, &op, op_end)) {
+        return 0;
+      }
+      ip += match_length;
+      anchor = ip;
+    }
+  }
+  if (!PutSequence(anchor, end - anchor, 0, 0, &op, op_end)) {
+    return 0;
+  }
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+bool CompressionUtil::Decompress(const char *src, size_t src_length, char *dst, size_t dst_length) {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip_end = ip + src_length;
+  auto *base = reinterpret_cast<uint8_t *>(dst);
+  uint8_t *op = base;
+  const uint8_t *op_end = base + dst_length;
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == RUN_MASK && !GetLength(&ip, ip_end, &literal_length)) {
+      return false;
+    }
+    if (static_cast<size_t>(ip_end - ip) < literal_length || static_cast<size_t>(op_end - op) < literal_length) {
+      return false;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == ip_end) {
+      // The last sequence has no match.
+      return op == op_end;
+    }
+
+    if (ip_end - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    size_t match_length = token & RUN_MASK;
+    if (match_length == RUN_MASK && !GetLength(&ip, ip_end, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - base) || static_cast<size_t>(op_end - op) < match_length) {
+      return false;
+    }
+    const uint8_t *match = op - offset;
+    if (offset >= match_length) {
+      memcpy(op, match, match_length);
+    } else {
+      // The match overlaps what it produces, e.g. a run of one repeated byte.
+      for (size_t i = 0; i < match_length; i++) {
+        op[i] = match[i];
+      }
+    }
+    op += match_length;
+  }
+  return false;
+}
+
+}  // namespace bustub
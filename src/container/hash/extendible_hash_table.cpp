@@ -19,6 +19,7 @@
 #include "common/logger.h"
 #include "common/rid.h"
 #include "container/hash/extendible_hash_table.h"
+#include "storage/index/varlen_key.h"
 
 namespace bustub {
 
@@ -26,14 +27,14 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                      const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  auto dir_page = buffer_pool_manager_->NewPage(&directory_page_id_);
-  auto dir_page_data = reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData());
+  WritePageGuard dir_guard = buffer_pool_manager_->NewPageWrite(&directory_page_id_);
+  auto dir_page_data = dir_guard.AsMut<HashTableDirectoryPage>();
 
   // initially, there should be two buckets
   page_id_t bucket_0_page_id;
   page_id_t bucket_1_page_id;
-  buffer_pool_manager_->NewPage(&bucket_0_page_id);
-  buffer_pool_manager_->NewPage(&bucket_1_page_id);
+  buffer_pool_manager_->NewPageWrite(&bucket_0_page_id);
+  buffer_pool_manager_->NewPageWrite(&bucket_1_page_id);
   dir_page_data->SetBucketPageId(0, bucket_0_page_id);
   dir_page_data->SetLocalDepth(0, 1);
   dir_page_data->SetBucketPageId(1, bucket_1_page_id);
@@ -42,11 +43,6 @@ HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager
   // remeber update directory page
   dir_page_data->IncrGlobalDepth();
   dir_page_data->SetPageId(directory_page_id_);
-
-  // unpin the pages
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
-  buffer_pool_manager_->UnpinPage(bucket_0_page_id, false);
-  buffer_pool_manager_->UnpinPage(bucket_1_page_id, false);
 }
 
 /*****************************************************************************
@@ -65,27 +61,15 @@ uint32_t HASH_TABLE_TYPE::Hash(KeyType key) {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) {
+inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, const HashTableDirectoryPage *dir_page) {
   return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline page_id_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) {
+inline page_id_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, const HashTableDirectoryPage *dir_page) {
   return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
-HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
-  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
-}
-
-template <typename KeyType, typename ValueType, typename KeyComparator>
-std::pair<Page *, HASH_TABLE_BUCKET_TYPE *> HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
-  auto bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
-  return std::pair<Page *, HASH_TABLE_BUCKET_TYPE *>(bucket_page, bucket_page_data);
-}
-
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::Pow(uint32_t base, uint32_t power) const {
   return static_cast<uint32_t>(std::pow(static_cast<long double>(base), static_cast<long double>(power)));
@@ -98,14 +82,12 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
   table_latch_.RLock();
 
-  auto dir_page_data = FetchDirectoryPage();
-  auto bucket_page_id = KeyToPageId(key, dir_page_data);
-  auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-  bucket_page->RLatch();
-  auto success = bucket_page_data->GetValue(key, comparator_, result);
-  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  bucket_page->RUnlatch();
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  auto bucket_page_id = KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>());
+  ReadPageGuard bucket_guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+  auto success = bucket_guard.As<HASH_TABLE_BUCKET_TYPE>()->GetValue(key, comparator_, result);
+  bucket_guard.Release();
+  dir_guard.Release();
 
   table_latch_.RUnlock();
   return success;
@@ -118,23 +100,25 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.RLock();
 
-  auto dir_page_data = FetchDirectoryPage();
-  auto bucket_page_id = KeyToPageId(key, dir_page_data);
-  auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-  bucket_page->WLatch();
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  auto bucket_page_id = KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>());
+  WritePageGuard bucket_guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
 
   // if the bucket is full, the insertion is handed over to SplitInsert() to complete.
-  if (bucket_page_data->IsFull()) {
-    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-    bucket_page->WUnlatch();
+  if (bucket_guard.As<HASH_TABLE_BUCKET_TYPE>()->IsFull()) {
+    bucket_guard.Release();
+    dir_guard.Release();
     table_latch_.RUnlock();
     return SplitInsert(transaction, key, value);
   }
-  auto success = bucket_page_data->Insert(key, value, comparator_);
-  buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  bucket_page->WUnlatch();
+  // Only a successful insert changes the bucket, so only then is it dirtied.
+  auto success =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_guard.GetPage()->GetData())->Insert(key, value, comparator_);
+  if (success) {
+    bucket_guard.SetDirty();
+  }
+  bucket_guard.Release();
+  dir_guard.Release();
 
   table_latch_.RUnlock();
   return success;
@@ -146,20 +130,22 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
 
   auto success = false;
   auto inserted = false;
-  auto is_growing = false;
-  auto dir_page_data = FetchDirectoryPage();
+  WritePageGuard dir_guard = buffer_pool_manager_->FetchPageWrite(directory_page_id_);
 
   // insert the key-value pair into the corresponding bucket.
   // If the bucket is full, split until it is successfully inserted into the bucket.
   while (!inserted) {
-    auto old_global_depth = dir_page_data->GetGlobalDepth();
-    auto bucket_idx = KeyToDirectoryIndex(key, dir_page_data);
-    auto bucket_page_id = KeyToPageId(key, dir_page_data);
-    auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-    bucket_page->WLatch();
+    auto bucket_idx = KeyToDirectoryIndex(key, dir_guard.As<HashTableDirectoryPage>());
+    auto bucket_page_id = KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>());
+    WritePageGuard bucket_guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
 
     // split the bucket
-    if (bucket_page_data->IsFull()) {
+    if (bucket_guard.As<HASH_TABLE_BUCKET_TYPE>()->IsFull()) {
+      auto dir_page_data = dir_guard.AsMut<HashTableDirectoryPage>();
+      auto bucket_page_data = bucket_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+      auto old_global_depth = dir_page_data->GetGlobalDepth();
+      auto is_growing = false;
+
       // first check whether we need to grow the directory
       if (dir_page_data->GetLocalDepth(bucket_idx) == dir_page_data->GetGlobalDepth()) {
         dir_page_data->IncrGlobalDepth();
@@ -170,8 +156,8 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
       dir_page_data->IncrLocalDepth(bucket_idx);
       auto split_bucket_idx = dir_page_data->GetSplitImageIndex(bucket_idx);
       page_id_t split_page_id;
-      auto split_page_data =
-          reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&split_page_id)->GetData());
+      WritePageGuard split_guard = buffer_pool_manager_->NewPageWrite(&split_page_id);
+      auto split_page_data = split_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
       dir_page_data->SetBucketPageId(split_bucket_idx, split_page_id);
       dir_page_data->SetLocalDepth(split_bucket_idx, dir_page_data->GetLocalDepth(bucket_idx));
 
@@ -191,7 +177,7 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
           num_read++;
         }
       }
-      buffer_pool_manager_->UnpinPage(split_page_id, true);
+      split_guard.Release();
 
       // redirect the reset of the buckets.
       // This loop only works for the directory extension case.
@@ -222,13 +208,15 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
       }
     } else {
       // the bucket is not full, so we can insert the key-value directly.
-      success = bucket_page_data->Insert(key, value, comparator_);
+      success = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_guard.GetPage()->GetData())
+                    ->Insert(key, value, comparator_);
+      if (success) {
+        bucket_guard.SetDirty();
+      }
       inserted = true;
     }
-    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-    bucket_page->WUnlatch();
   }
-  buffer_pool_manager_->UnpinPage(directory_page_id_, is_growing);
+  dir_guard.Release();
 
   table_latch_.WUnlock();
   return success;
@@ -241,26 +229,24 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.RLock();
 
-  auto dir_page_data = FetchDirectoryPage();
-  auto bucket_page_id = KeyToPageId(key, dir_page_data);
-  auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-  bucket_page->WLatch();
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  auto bucket_page_id = KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>());
+  WritePageGuard bucket_guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
+  // Only a successful remove changes the bucket, so only then is it dirtied.
+  auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_guard.GetPage()->GetData());
   auto success = bucket_page_data->Remove(key, value, comparator_);
+  if (success) {
+    bucket_guard.SetDirty();
+  }
+  auto is_empty = bucket_page_data->IsEmpty();
+  bucket_guard.Release();
+  dir_guard.Release();
+  table_latch_.RUnlock();
 
   // if the bucket is empty after removing, call Merge().
-  if (success && bucket_page_data->IsEmpty()) {
-    buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-    bucket_page->WUnlatch();
-    table_latch_.RUnlock();
+  if (success && is_empty) {
     Merge(transaction, key, value);
-    return success;
   }
-  buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  bucket_page->WUnlatch();
-
-  table_latch_.RUnlock();
   return success;
 }
 
@@ -271,17 +257,17 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.WLock();
 
-  auto dir_page_data = FetchDirectoryPage();
+  WritePageGuard dir_guard = buffer_pool_manager_->FetchPageWrite(directory_page_id_);
 
   // traverse the directory page and merge all empty buckets.
-  for (uint32_t i = 0;i<dir_page_data->Size();i++) {
+  for (uint32_t i = 0; i < dir_guard.As<HashTableDirectoryPage>()->Size(); i++) {
     // after merging the buckets, the directory page may shrink.
     // so we have to check every time whether it is out of bounds.
-    auto old_local_depth = dir_page_data->GetLocalDepth(i);
-    auto bucket_page_id = dir_page_data->GetBucketPageId(i);
-    auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-    bucket_page->RLatch();
-    if (old_local_depth > 1 && bucket_page_data->IsEmpty()) {
+    auto old_local_depth = dir_guard.As<HashTableDirectoryPage>()->GetLocalDepth(i);
+    auto bucket_page_id = dir_guard.As<HashTableDirectoryPage>()->GetBucketPageId(i);
+    ReadPageGuard bucket_guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+    if (old_local_depth > 1 && bucket_guard.As<HASH_TABLE_BUCKET_TYPE>()->IsEmpty()) {
+      auto dir_page_data = dir_guard.AsMut<HashTableDirectoryPage>();
       auto split_bucket_idx = dir_page_data->GetSplitImageIndex(i);
       if (dir_page_data->GetLocalDepth(split_bucket_idx) == old_local_depth) {
         dir_page_data->DecrLocalDepth(i);
@@ -301,15 +287,17 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
             dir_page_data->SetBucketPageId(j, new_bucket_page_id);
           }
         }
+
+        // Nothing refers to the empty bucket any more, give its page back.
+        bucket_guard.Release();
+        buffer_pool_manager_->DeletePage(bucket_page_id);
       }
       if (dir_page_data->CanShrink()) {
         dir_page_data->DecrGlobalDepth();
       }
     }
-    bucket_page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
   }
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  dir_guard.Release();
 
   table_latch_.WUnlock();
 }
@@ -320,9 +308,9 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  uint32_t global_depth = dir_guard.As<HashTableDirectoryPage>()->GetGlobalDepth();
+  dir_guard.Release();
   table_latch_.RUnlock();
   return global_depth;
 }
@@ -333,9 +321,9 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  dir_guard.As<HashTableDirectoryPage>()->VerifyIntegrity();
+  dir_guard.Release();
   table_latch_.RUnlock();
 }
 
@@ -349,5 +337,7 @@ template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHashTable<VarlenKey<64>, RID, VarlenComparator<64>>;
+template class ExtendibleHashTable<VarlenKey<256>, RID, VarlenComparator<256>>;
 
 }  // namespace bustub
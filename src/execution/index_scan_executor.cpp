@@ -11,12 +11,58 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <vector>
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {
+  index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
+}
+
+void IndexScanExecutor::Init() {
+  const auto &low_key = plan_->GetLowKey();
+  const auto &high_key = plan_->GetHighKey();
+  scan_ = index_info_->index_->ScanRange(low_key.has_value() ? &*low_key : nullptr,
+                                         high_key.has_value() ? &*high_key : nullptr,
+                                         plan_->GetDirection() == ScanDirection::BACKWARD, exec_ctx_->GetTransaction());
+  rids_.clear();
+  tuples_.clear();
+  next_tuple_ = 0;
+}
 
-void IndexScanExecutor::Init() {}
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema &schema = table_info_->schema_;
+  while (true) {
+    while (next_tuple_ == tuples_.size()) {
+      if (!NextBatch()) {
+        return false;
+      }
+    }
+    const Tuple &row = tuples_[next_tuple_++];
+    if (plan_->GetPredicate() != nullptr && !plan_->GetPredicate()->Evaluate(&row, &schema).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema()->GetColumnCount());
+    for (const Column &column : GetOutputSchema()->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&row, &schema));
+    }
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = row.GetRid();
+    return true;
+  }
+}
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool IndexScanExecutor::NextBatch() {
+  rids_.clear();
+  tuples_.clear();
+  next_tuple_ = 0;
+  if (!scan_->NextBatch(&rids_)) {
+    return false;
+  }
+  // A tuple that was deleted since its RID was scanned is left out.
+  return table_info_->table_->GetTuples(rids_, &tuples_, exec_ctx_->GetTransaction());
+}
 
 }  // namespace bustub
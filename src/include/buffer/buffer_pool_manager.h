@@ -17,12 +17,47 @@
 #include <unordered_map>
 
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * Counters describing how a buffer pool has been used since it was created.
+ */
+struct BufferPoolStats {
+  /** Number of fetches that found their page in the buffer pool. */
+  uint64_t hits_{0};
+  /** Number of fetches that had to read their page from disk. */
+  uint64_t misses_{0};
+  /** Number of evicted pages that had to be written back first. */
+  uint64_t dirty_evictions_{0};
+  /** Number of evicted pages that were dropped without a write. */
+  uint64_t clean_evictions_{0};
+  /** Number of pages read in by PrefetchPage(). */
+  uint64_t prefetches_{0};
+  /** Number of dirty pages written back by the background flusher. */
+  uint64_t background_flushes_{0};
+  /** Number of times the latch of a buffer pool instance was held by somebody else when it was needed. */
+  uint64_t latch_waits_{0};
+  /** Number of fetches and prefetches whose page could not be read, e.g. because it did not match its checksum. */
+  uint64_t read_errors_{0};
+
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    dirty_evictions_ += other.dirty_evictions_;
+    clean_evictions_ += other.clean_evictions_;
+    prefetches_ += other.prefetches_;
+    background_flushes_ += other.background_flushes_;
+    latch_waits_ += other.latch_waits_;
+    read_errors_ += other.read_errors_;
+    return *this;
+  }
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -84,9 +119,50 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page and take its read latch.
+   * @param page_id id of page to be fetched
+   * @return a guard that releases the latch and the pin, empty if the page could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id) { return ReadPageGuard(this, FetchPage(page_id)); }
+
+  /**
+   * Fetch a page and take its write latch.
+   * @param page_id id of page to be fetched
+   * @return a guard that releases the latch and the pin, empty if the page could not be fetched
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id) { return WritePageGuard(this, FetchPage(page_id)); }
+
+  /**
+   * Create a new page and take its write latch. The page is dirty from the start, as it is not on disk yet.
+   * @param[out] page_id id of created page
+   * @return a guard that releases the latch and the pin, empty if no new page could be created
+   */
+  WritePageGuard NewPageWrite(page_id_t *page_id) {
+    WritePageGuard guard(this, NewPage(page_id));
+    if (guard.IsValid()) {
+      guard.SetDirty();
+    }
+    return guard;
+  }
+
+  /**
+   * Start reading a page into the buffer pool in the background, without pinning it. A later FetchPage() of the page
+   * then does not have to wait for the disk, or only for the rest of the read. This is only a hint: nothing happens if
+   * the page is already in the buffer pool or no frame can be freed for it.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPage(page_id_t page_id) { PrefetchPgImp(page_id); }
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
+  /** @return the hit, miss and eviction counters of the buffer pool */
+  virtual BufferPoolStats GetStats() = 0;
+
+  /** @return true if pages can not be created or modified, so that nothing may be written to a fetched page */
+  virtual bool IsReadOnly() { return false; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -104,7 +180,8 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
-   * @return the requested page
+   * @return the requested page, or nullptr if no frame could be freed for it or it could not be read, e.g. because
+   * it does not match its checksum
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
@@ -133,7 +210,8 @@ class BufferPoolManager {
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
-   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @return false if the page is pinned or is not allocated (e.g. it has been deleted already), true if deletion
+   * succeeded
    */
   virtual bool DeletePgImp(page_id_t page_id) = 0;
 
@@ -141,5 +219,11 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Starts reading a page into the buffer pool without pinning it.
+   * @param page_id id of page to be prefetched
+   */
+  virtual void PrefetchPgImp(page_id_t page_id) = 0;
 };
 }  // namespace bustub
@@ -12,18 +12,38 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_memory.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/two_q_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * Settings of the background flusher of a buffer pool, see BufferPoolManagerInstance::StartBackgroundFlusher().
+ */
+struct BackgroundFlusherOptions {
+  /** The flusher writes back dirty pages until at least this fraction of the frames is clean or free. */
+  double target_clean_fraction_{0.25};
+  /** The most pages written back in one batch. */
+  size_t max_batch_size_{32};
+  /** How long the flusher sleeps when it has nothing to do, unless an eviction has to write back a dirty page. */
+  std::chrono::milliseconds interval_{10};
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -34,8 +54,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param frame_memory how to allocate the memory of the frames
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU,
+                            const FrameMemoryOptions &frame_memory = {});
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +67,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param frame_memory how to allocate the memory of the frames
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU,
+                            const FrameMemoryOptions &frame_memory = {});
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -55,9 +83,46 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override { return pool_size_; }
 
+  /** @return the hit, miss and eviction counters of this buffer pool instance */
+  BufferPoolStats GetStats() override;
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /** @return the number of frames that are pinned right now, i.e. that cannot be given to another page */
+  size_t GetNumPinnedFrames() const { return num_pinned_frames_; }
+
+  /**
+   * Find the instance a page belongs to in a parallel BPM. Page ids are dealt out in groups of num_instances
+   * consecutive ids, one to each instance. The order is shifted by a hash of the group, so that page id patterns
+   * with a stride (e.g. every num_instances-th page) still spread over all instances.
+   * @param page_id the page
+   * @param num_instances the number of instances in the parallel BPM
+   * @return the index of the instance that the page belongs to
+   */
+  static uint32_t InstanceOf(page_id_t page_id, uint32_t num_instances);
+
+  /** @return the memory holding the data of all the pages in the buffer pool */
+  const FrameMemory &GetFrameMemory() const { return frames_; }
+
+  /**
+   * Start a thread that writes back dirty, unpinned pages ahead of their eviction, so that misses seldom have to
+   * write back their victim themselves. Pages are written in batches, in page id order. With logging enabled, a page
+   * is only written once the log is persistent up to its LSN. Does nothing if the flusher is already running.
+   * @param options the settings of the flusher
+   */
+  void StartBackgroundFlusher(const BackgroundFlusherOptions &options = {});
+
+  /** Stop the background flusher and wait for it to finish its batch. Does nothing if it is not running. */
+  void StopBackgroundFlusher();
+
+  /**
+   * Write back every page that is dirty, in page id order and with runs of consecutive pages written together. The
+   * database file is not synced: FlushAllPages() is this followed by DiskManager::SyncDbFile(). The pages of a run
+   * whose write fails stay dirty.
+   */
+  void WriteBackDirtyPages();
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -91,28 +156,34 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
-   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @return false if the page is pinned or is not allocated (e.g. it has been deleted already), true if deletion
+   * succeeded
    */
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk, and syncs the database file once they are written.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Start reading a page into the buffer pool without pinning it.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Allocate a page on disk, reusing a deallocated one if there is one that routes to this BPI.
    * @return the id of the allocated page
    */
   page_id_t AllocatePage();
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that it can be allocated again.
    * @param page_id id of the page to deallocate
+   * @return false if the page was not allocated
    */
-  void DeallocatePage([[maybe_unused]] page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  bool DeallocatePage(page_id_t page_id);
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -127,42 +198,143 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
-  /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
-  std::atomic<page_id_t> next_page_id_ = instance_index_;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** The PAGE_SIZE aligned memory holding the data of all pages_, one PAGE_SIZE frame each. */
+  FrameMemory frames_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_[[maybe_unused]];
   /** Pointer to the log manager. */
   LogManager *log_manager_[[maybe_unused]];
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free, changes are made under latch_. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * Protects changes to the page table, the free list and the claiming of frames. Fetch hits and unpins do not take
+   * it: they pin and unpin with a compare-and-swap on the pin count, which fails once a frame has been claimed. It is
+   * never held across disk I/O: a frame whose page is being read in or written back is marked io_in_progress_ instead.
+   */
   std::mutex latch_;
+  /** Counters behind GetStats(). Atomic so that neither updating nor reading them needs latch_. */
+  std::atomic<uint64_t> num_hits_{0};
+  std::atomic<uint64_t> num_misses_{0};
+  std::atomic<uint64_t> num_dirty_evictions_{0};
+  std::atomic<uint64_t> num_clean_evictions_{0};
+  std::atomic<uint64_t> num_prefetches_{0};
+  std::atomic<uint64_t> num_background_flushes_{0};
+  std::atomic<uint64_t> num_latch_waits_{0};
+  std::atomic<uint64_t> num_read_errors_{0};
+  /** Number of frames whose pin count is above zero, kept up to date when it becomes or stops being zero. */
+  std::atomic<size_t> num_pinned_frames_{0};
+  /** Number of prefetch reads whose completion has not been handled yet, protected by latch_. */
+  size_t prefetches_in_flight_{0};
+  /** Signalled (under latch_) when prefetches_in_flight_ drops to zero. */
+  std::condition_variable prefetches_done_;
+  /** One condition per frame, signalled (under latch_) when the I/O in progress on that frame completes. */
+  std::condition_variable *io_done_;
+  /** The background flusher, if it has been started. */
+  std::thread flusher_thread_;
+  /** The settings of the background flusher. */
+  BackgroundFlusherOptions flusher_options_;
+  /**
+   * Whether the background flusher is running, and whether it should stop or start a round early. Protected by
+   * latch_.
+   */
+  bool flusher_running_{false};
+  bool flusher_stop_{false};
+  bool flush_requested_{false};
+  /** Signalled (under latch_) to stop the background flusher or to have it start a round early. */
+  std::condition_variable flusher_wakeup_;
+  /** The frame the next round of the background flusher starts looking at. Only used by the flusher. */
+  size_t flusher_cursor_{0};
 
  private:
   /**
-   * Find a fresh page.
-   * @return the frame id of the fresh page, or -1 if not found.
+   * Find a fresh page. A dirty victim is written back with latch_ released; if the victim is pinned or dirtied again
+   * in the meantime it is left alone and another one is tried.
+   * @param lock the held lock on latch_
+   * @return the frame id of the fresh page, or -1 if not found. The frame is neither in the page table nor in the
+   * replacer.
    */
-  frame_id_t FindFreshPage();
+  frame_id_t FindFreshPage(std::unique_lock<std::mutex> *lock);
 
   /**
-   * Flush the contents of page to disk.
-   * @param page_id the page id of the page to be flushed.
+   * Pin a frame that is in the page table, waiting until any I/O in progress on it has completed.
+   * @param frame_id the frame to pin
+   * @param lock the held lock on latch_
+   * @return true if the frame was pinned, false if its page could not be read in while we waited. The frame is not
+   * pinned then.
    */
-  void FlushPg(page_id_t page_id);
+  bool PinFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
 
   /**
-   * Find the page specified by page id
+   * Pin a frame without latch_, if it is not claimed and still holds the page. Does not wait for I/O.
+   * @param frame_id the frame to pin
+   * @param page_id the page the frame should hold
+   * @return true if the frame was pinned
+   */
+  bool TryPinFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Take a page whose read failed out of the page table, and wake up whoever waits for it. The frame goes back to the
+   * free list, unless somebody still pins it. Must be called under latch_.
+   * @param frame_id the frame the page was read into
+   */
+  void DropUnreadPage(frame_id_t frame_id);
+
+  /**
+   * Drop a pin on a frame, handing the frame to the replacer if that was the last one.
+   * @param frame_id the frame to unpin
+   */
+  void UnpinFrame(frame_id_t frame_id);
+
+  /**
+   * Claim an unpinned frame, so that it can no longer be pinned without latch_. Must be called under latch_.
+   * @param frame_id the frame to claim
+   * @return true if the frame was claimed, false if it is pinned
+   */
+  bool ClaimFrame(frame_id_t frame_id);
+
+  /** @return a held lock on latch_. Finding latch_ held by somebody else is counted in num_latch_waits_. */
+  std::unique_lock<std::mutex> LockLatch();
+
+  /**
+   * How far the instances are shifted in a group of page ids, see InstanceOf().
+   * @param group the group, i.e. the page id divided by num_instances
+   * @param num_instances the number of instances in the parallel BPM
+   * @return the shift, less than num_instances
+   */
+  static uint32_t GroupShift(uint32_t group, uint32_t num_instances);
+
+  /**
+   * Wait until no I/O is in progress on a frame.
+   * @param frame_id the frame to wait for
+   * @param lock the held lock on latch_
+   */
+  void WaitForIo(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /** The loop of the background flusher thread. */
+  void RunFlusher();
+
+  /**
+   * Write back one batch of dirty, unpinned pages if fewer frames are clean than the flusher is asked to keep.
+   * @param lock the held lock on latch_, released while looking for pages and while writing them
+   * @return the number of pages written back
+   */
+  size_t FlushDirtyFrames(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Find the page specified by page id. Must be called under latch_.
    * @param page_id the page id of the page to be found.
    * @return the frame id of the page, or -1 if not found.
    */
   frame_id_t FindPage(page_id_t page_id);
+
+  /** The pin count of a frame that is claimed: it is on the free list, or being (re)assigned under latch_. */
+  static constexpr int CLAIMED = -1;
 };
 }  // namespace bustub
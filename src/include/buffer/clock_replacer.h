@@ -12,8 +12,7 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +22,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * It is lock-free: each frame is a single atomic byte holding its "in the replacer" and reference bits, so Pin() and
+ * Unpin() are one atomic read-modify-write each and never block or allocate. Victim() moves the clock hand with
+ * fetch_add and claims or ages frames with compare-and-swap, so it may run alongside them.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -46,7 +49,17 @@ class ClockReplacer : public Replacer {
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** The frame is in the ClockReplacer, i.e. unpinned. */
+  static constexpr uint8_t IN_REPLACER = 1;
+  /** The reference bit, set when the frame is unpinned and cleared when the clock hand passes it. */
+  static constexpr uint8_t REFERENCED = 2;
+
+  /** The bits of each frame. */
+  std::vector<std::atomic<uint8_t>> frames_;
+  /** Ever increasing, the clock hand points to frame hand_ % frames_.size(). */
+  std::atomic<size_t> hand_{0};
+  /** Number of frames in the ClockReplacer. It may run ahead of the frames while they are being (un)pinned. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_memory.h
+//
+// Identification: src/include/buffer/frame_memory.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * How the memory behind the frames of a buffer pool is allocated.
+ */
+struct FrameMemoryOptions {
+  /**
+   * Back the frames with 2MB huge pages, so that a large pool needs far fewer TLB entries. Explicit (hugetlbfs) huge
+   * pages are tried first, then transparent huge pages through madvise(). If neither is available the frames get
+   * ordinary pages.
+   */
+  bool huge_pages_{false};
+  /** The NUMA node to bind the frames to, or -1 to leave placement to the OS. */
+  int numa_node_{-1};
+};
+
+/**
+ * FrameMemory owns the PAGE_SIZE aligned memory holding the frames of a buffer pool. The memory is mapped, and if
+ * requested bound to its NUMA node, before anybody touches it, so that it is placed where it was asked to be.
+ */
+class FrameMemory {
+ public:
+  /**
+   * Allocate the memory for a buffer pool.
+   * @param size the number of bytes to allocate
+   * @param options how to allocate them
+   */
+  FrameMemory(size_t size, const FrameMemoryOptions &options);
+
+  FrameMemory(const FrameMemory &) = delete;
+  FrameMemory &operator=(const FrameMemory &) = delete;
+
+  ~FrameMemory();
+
+  /** @return the allocated memory */
+  char *GetData() const { return data_; }
+
+  /** @return true if the memory is backed by huge pages, either explicit or transparent ones */
+  bool UsesHugePages() const { return uses_huge_pages_; }
+
+  /** @return true if the memory is bound to the requested NUMA node */
+  bool IsBoundToNode() const { return is_bound_to_node_; }
+
+ private:
+  /**
+   * Map anonymous memory aligned to alignment.
+   * @param alignment a power of two that is a multiple of the OS page size
+   * @return true if the memory was mapped
+   */
+  bool MapAligned(size_t alignment);
+
+  /** The allocated memory. */
+  char *data_{nullptr};
+  /** Number of bytes mapped at data_. */
+  size_t mapped_size_{0};
+  bool uses_huge_pages_{false};
+  bool is_bound_to_node_{false};
+};
+
+}  // namespace bustub
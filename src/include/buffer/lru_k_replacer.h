@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy: the victim is the frame whose K-th most recent access lies
+ * furthest in the past. Frames accessed fewer than K times count as infinitely far and go first, oldest access
+ * first, so that pages touched once by a large scan are evicted before pages that are used over and over.
+ *
+ * Accesses to a frame that follow its previous access within the correlated reference period are taken to be part of
+ * the same reference (e.g. a scan fetching the same page once per tuple) and do not add to its history.
+ * Time is counted in calls to RecordAccess().
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses remembered per frame
+   * @param correlated_reference_period accesses at most this many ticks apart count as one, defaults to num_pages
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2, size_t correlated_reference_period = 0);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+ private:
+  /** (has K accesses, time of the K-th most recent or of the oldest access, frame id), victims come first. */
+  using Key = std::tuple<bool, uint64_t, frame_id_t>;
+
+  struct FrameHistory {
+    /** Times of the uncorrelated accesses, oldest first, at most k_ of them. */
+    std::deque<uint64_t> accesses_;
+    /** Time of the most recent access, correlated or not. */
+    uint64_t last_access_{0};
+    /** Whether the frame is in evictable_, and under which key. */
+    bool evictable_{false};
+    Key key_;
+  };
+
+  Key MakeKey(frame_id_t frame_id) const;
+
+  /** Take a frame out of evictable_, if it is there. */
+  void MakeUnevictable(frame_id_t frame_id);
+
+  const size_t k_;
+  const uint64_t correlated_reference_period_;
+  uint64_t current_time_{0};
+  std::vector<FrameHistory> frames_;
+  /** The unpinned frames, ordered by their keys. */
+  std::set<Key> evictable_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
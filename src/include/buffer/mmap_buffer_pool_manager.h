@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager serves the pages of a database file that nobody writes, e.g. on an analytical replica, straight
+ * from a read-only mapping of the file. A fetched page is a view into the mapping: nothing is copied, pins are not
+ * counted, and the operating system's page cache does the caching and eviction.
+ *
+ * Pages can not be created, deleted or modified; writing to the data of a fetched page crashes. Compressed database
+ * files are not supported, and checksums are not verified. Pages appended to the file after it was mapped are not
+ * visible.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Map a database file.
+   * @param db_file the database file, as given to the DiskManager that wrote it
+   */
+  explicit MmapBufferPoolManager(const std::string &db_file);
+
+  MmapBufferPoolManager(const MmapBufferPoolManager &) = delete;
+  MmapBufferPoolManager &operator=(const MmapBufferPoolManager &) = delete;
+
+  ~MmapBufferPoolManager() override;
+
+  /** @return the number of pages in the mapping */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /** @return the number of fetches as hits; there are no misses or evictions to count */
+  BufferPoolStats GetStats() override;
+
+  /** @return true, the mapping is read-only */
+  bool IsReadOnly() override { return true; }
+
+ protected:
+  /**
+   * Fetch a view of the requested page.
+   * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if it is not in the file
+   */
+  Page *FetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page. Pins are not counted, so this does nothing.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty must be false, a read-only page can not have been modified
+   * @return false if is_dirty is true, true otherwise
+   */
+  bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page. Pages are never dirty, so this does nothing.
+   * @param page_id id of page to be flushed
+   * @return false if the page is not in the file, true otherwise
+   */
+  bool FlushPgImp(page_id_t page_id) override;
+
+  /**
+   * Pages can not be created.
+   * @param[out] page_id set to INVALID_PAGE_ID
+   * @return nullptr
+   */
+  Page *NewPgImp(page_id_t *page_id) override;
+
+  /**
+   * Pages can not be deleted.
+   * @param page_id id of page to be deleted
+   * @return false
+   */
+  bool DeletePgImp(page_id_t page_id) override;
+
+  /** Pages are never dirty, so there is nothing to flush. */
+  void FlushAllPgsImp() override {}
+
+  /**
+   * Ask the operating system to start reading the page in.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+ private:
+  /** The mapping of the database file. */
+  char *data_{nullptr};
+  /** Number of whole pages in the mapping. */
+  size_t num_pages_{0};
+  /** The view of every page, created when the page is fetched for the first time so that opening a file is cheap. */
+  std::unique_ptr<std::atomic<Page *>[]> pages_;
+  std::atomic<uint64_t> num_fetches_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/buffer/page_guard.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * ReadPageGuard holds a pin and the read latch of a page, and releases both when it is destroyed. It is move-only, so
+ * that exactly one guard is responsible for them. A guard may be empty, e.g. when the page could not be fetched.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * Take the read latch of a pinned page. The guard takes over the pin.
+   * @param buffer_pool_manager the buffer pool manager the page is pinned in
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  ReadPageGuard(BufferPoolManager *buffer_pool_manager, Page *page);
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&other) noexcept;
+  ReadPageGuard &operator=(ReadPageGuard &&other) noexcept;
+
+  ~ReadPageGuard() { Release(); }
+
+  /** Release the latch and the pin now, leaving the guard empty. */
+  void Release();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the page itself, for page types that derive from Page. It must only be read through. */
+  Page *GetPage() const { return page_; }
+
+  /** @return the data of the page */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the data of the page, as a T laid over it */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+};
+
+/**
+ * WritePageGuard holds a pin and the write latch of a page, and releases both when it is destroyed. The page is only
+ * unpinned as dirty if it was changed through the guard, i.e. its data was accessed mutably or SetDirty() was called.
+ * It is move-only, so that exactly one guard is responsible for them. A guard may be empty, e.g. when the page could
+ * not be fetched.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * Take the write latch of a pinned page. The guard takes over the pin.
+   * @param buffer_pool_manager the buffer pool manager the page is pinned in
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  WritePageGuard(BufferPoolManager *buffer_pool_manager, Page *page);
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&other) noexcept;
+  WritePageGuard &operator=(WritePageGuard &&other) noexcept;
+
+  ~WritePageGuard() { Release(); }
+
+  /** Release the latch and the pin now, leaving the guard empty. */
+  void Release();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** Remember that the page has been changed, so that it is unpinned as dirty. */
+  void SetDirty() { is_dirty_ = true; }
+
+  /**
+   * @return the page itself, for page types that derive from Page. Changes made through it must be reported with
+   * SetDirty().
+   */
+  Page *GetPage() const { return page_; }
+
+  /** @return the data of the page, for reading */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the data of the page, for changing it. This marks the page dirty. */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the data of the page, as a T laid over it, for reading */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the data of the page, as a T laid over it, for changing it. This marks the page dirty. */
+  template <class T>
+  T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+}  // namespace bustub
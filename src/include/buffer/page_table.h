@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames that hold them. It is a fixed-size open
+ * addressing hash table with linear probing, sized so that it is never more than half full.
+ *
+ * Find() is lock-free and may run concurrently with Insert() and Erase(), which must be serialized by the caller.
+ * A concurrent Find() can be told about an entry that is just being erased, and can miss an entry that Erase() is
+ * moving to fill the gap it leaves (but never an entry that stays put). Callers must therefore validate what Find()
+ * returns, and look again under their own lock before concluding that a page is not there.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Look up a page.
+   * @param page_id the page to look for
+   * @return the frame of the page, or -1 if it is not in the table
+   */
+  frame_id_t Find(page_id_t page_id) const;
+
+  /**
+   * Add a page that is not in the table yet.
+   * @param page_id the page
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page, if it is in the table.
+   * @param page_id the page to remove
+   */
+  void Erase(page_id_t page_id);
+
+ private:
+  /** A slot holds a page id in its upper and a frame id in its lower half, or is EMPTY_SLOT. */
+  static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+
+  static uint64_t MakeSlot(page_id_t page_id, frame_id_t frame_id) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t PageIdOf(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t FrameIdOf(uint64_t slot) { return static_cast<frame_id_t>(slot & UINT32_MAX); }
+
+  /** @return the slot where the search for a page starts */
+  size_t HomeOf(page_id_t page_id) const;
+
+  /** Number of slots minus one, the number of slots is a power of two. */
+  size_t mask_;
+  /** Number of bits of the hash used to pick the home slot. */
+  int hash_bits_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -30,9 +31,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
+   * @param frame_memory how to allocate the frames of every BufferPoolManagerInstance
+   * @param numa_nodes if not empty, the frames of instance i are bound to NUMA node numa_nodes[i % numa_nodes.size()]
+   * rather than to frame_memory.numa_node_
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            const FrameMemoryOptions &frame_memory = {}, const std::vector<int> &numa_nodes = {});
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -42,10 +48,23 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  /** @return the hit, miss and eviction counters summed over all BufferPoolManagerInstances */
+  BufferPoolStats GetStats() override;
+
+  /**
+   * Start the background flusher of every BufferPoolManagerInstance.
+   * @param options the settings of the flushers
+   */
+  void StartBackgroundFlusher(const BackgroundFlusherOptions &options = {});
+
+  /** Stop the background flusher of every BufferPoolManagerInstance. */
+  void StopBackgroundFlusher();
+
  protected:
   /**
    * @param page_id id of page
-   * @return pointer to the BufferPoolManager responsible for handling given page id
+   * @return pointer to the BufferPoolManager responsible for handling given page id, see
+   * BufferPoolManagerInstance::InstanceOf()
    */
   BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
 
@@ -81,18 +100,28 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
-   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @return false if the page is pinned or is not allocated (e.g. it has been deleted already), true if deletion
+   * succeeded
    */
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk. The BufferPoolManagerInstances write theirs back in
+   * parallel, then the database file is synced once.
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Start reading a page into the buffer pool without pinning it.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
  private:
   std::vector<BufferPoolManagerInstance *> bpmis_;
-  uint32_t last_alloc_index_{0};
+  DiskManager *disk_manager_;
+  /** Where NewPgImp() starts breaking ties between equally loaded instances. */
+  std::atomic<uint32_t> next_alloc_index_{0};
   size_t pool_size_;
 };
 }  // namespace bustub
@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be created with. */
+enum class ReplacerType { LRU, CLOCK, LRU_K, TWO_Q };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -45,6 +48,21 @@ class Replacer {
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Record an access to the page held by a (pinned) frame. Only policies that look at the access history of a frame,
+   * rather than just at the order in which frames were unpinned, need to override this.
+   * @param frame_id the id of the frame that was accessed
+   * @param page_id the id of the page in that frame
+   */
+  virtual void RecordAccess([[maybe_unused]] frame_id_t frame_id, [[maybe_unused]] page_id_t page_id) {}
+
+  /**
+   * Forget a frame because its page is leaving the buffer pool. Unlike Victim(), this also drops whatever access
+   * history the replacer keeps for the frame.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
 };
 
 }  // namespace bustub
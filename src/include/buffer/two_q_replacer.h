@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full version of the 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A page that is read in goes to the A1in FIFO queue; further accesses while it is there do not change its position.
+ * Once A1in holds more than a quarter of the frames, its oldest page is evicted and remembered in A1out, a queue of
+ * page ids without frames sized to half of the frames. A page that is read in again while it is remembered in A1out
+ * has proven to be used repeatedly and goes to Am, which is managed as LRU. A page that is only scanned therefore
+ * never makes it to Am, and cannot push the frequently used pages out.
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQReplacer.
+   * @param num_pages the maximum number of pages the TwoQReplacer will be required to store
+   */
+  explicit TwoQReplacer(size_t num_pages);
+
+  /**
+   * Destroys the TwoQReplacer.
+   */
+  ~TwoQReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+ private:
+  enum class Queue { NONE, A1IN, AM };
+
+  /** (time it entered A1in or was last accessed in Am, frame id) */
+  using Entry = std::pair<uint64_t, frame_id_t>;
+
+  struct FrameState {
+    Queue queue_{Queue::NONE};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    uint64_t time_{0};
+    bool evictable_{false};
+  };
+
+  /** @return the evictable frames of the queue a frame belongs to */
+  std::set<Entry> *EvictableOf(const FrameState &frame) { return frame.queue_ == Queue::AM ? &am_ : &a1in_; }
+
+  /** Take a frame out of a1in_ or am_, if it is there. */
+  void MakeUnevictable(frame_id_t frame_id);
+
+  /** Remember the page id of a frame evicted from A1in. */
+  void RememberInA1out(page_id_t page_id);
+
+  /** Maximum number of frames in A1in (Kin). */
+  const size_t max_a1in_size_;
+  /** Maximum number of page ids in A1out (Kout). */
+  const size_t max_a1out_size_;
+  uint64_t current_time_{0};
+  std::vector<FrameState> frames_;
+  /** Number of frames in A1in, pinned or not. */
+  size_t a1in_size_{0};
+  /** The unpinned frames of A1in and Am, oldest first. */
+  std::set<Entry> a1in_;
+  std::set<Entry> am_;
+  /** A1out, most recently evicted first, and where to find each page id in it. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -21,6 +21,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -34,6 +35,14 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The data structure behind an index. */
+enum class IndexType {
+  /** Extendible hash table, for point lookups only. */
+  HASH_TABLE,
+  /** B+ tree, which also keeps the keys in order for range scans. */
+  B_PLUS_TREE
+};
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -144,6 +153,30 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Register a table that already exists in the database file, e.g. one that is served by a read-only buffer pool.
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param first_page_id The id of the first page of the table heap
+   * @return A (non-owning) pointer to the metadata for the table
+   */
+  TableInfo *OpenTable(const std::string &table_name, const Schema &schema, page_id_t first_page_id) {
+    if (table_names_.count(table_name) != 0) {
+      return NULL_TABLE_INFO;
+    }
+
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, first_page_id);
+    const auto table_oid = next_table_oid_.fetch_add(1);
+    auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
+    auto *tmp = meta.get();
+
+    tables_.emplace(table_oid, std::move(meta));
+    table_names_.emplace(table_name, table_oid);
+    index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{});
+
+    return tmp;
+  }
+
   /**
    * Query table metadata by name.
    * @param table_name The name of the table
@@ -185,13 +218,15 @@ class Catalog {
    * @param key_schema The schema of the key
    * @param key_attrs Key attributes
    * @param keysize Size of the key
-   * @param hash_function The hash function for the index
+   * @param hash_function The hash function for the index, unused by a B+ tree
+   * @param index_type The data structure behind the index
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         std::size_t keysize, HashFunction<KeyType> hash_function) {
+                         std::size_t keysize, HashFunction<KeyType> hash_function,
+                         IndexType index_type = IndexType::HASH_TABLE) {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -211,17 +246,21 @@ class Catalog {
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
-
-    // Populate the index with all tuples in table heap
+    std::unique_ptr<Index> index;
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    if (index_type == IndexType::B_PLUS_TREE) {
+      auto tree_index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      // Populate the index with all tuples in table heap, building the tree bottom-up from the sorted entries
+      tree_index->BulkLoad(heap, table_meta->schema_, txn);
+      index = std::move(tree_index);
+    } else {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                            hash_function);
+      // Populate the index with all tuples in table heap
+      for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+        index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      }
     }
 
     // Get the next OID for the new index
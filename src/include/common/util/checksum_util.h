@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_util.h
+//
+// Identification: src/include/common/util/checksum_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * ChecksumUtil computes checksums for detecting corrupted data, e.g. pages that were torn while being written.
+ */
+class ChecksumUtil {
+ public:
+  /**
+   * Compute the CRC32C (Castagnoli) checksum of a buffer. Uses the SSE4.2 crc32 instruction when the build targets a
+   * CPU that has it, and a lookup table otherwise; both give the same result.
+   * @param data the buffer
+   * @param length the length of the buffer in bytes
+   * @param crc the checksum of the data that precedes the buffer, to checksum data in pieces
+   * @return the checksum of the preceding data followed by the buffer
+   */
+  static uint32_t Crc32c(const char *data, size_t length, uint32_t crc = 0);
+
+  /** Crc32c() without the crc32 instruction, for testing. */
+  static uint32_t Crc32cSoftware(const char *data, size_t length, uint32_t crc = 0);
+};
+
+}  // namespace bustub
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.h
+//
+// Identification: src/include/common/util/compression_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * CompressionUtil compresses blocks of data, such as pages, in the LZ4 block format: a sequence of literal runs, each
+ * followed by a match that copies earlier output. It favours speed over compression ratio, which suits the small
+ * integers and repeated strings that pages are full of.
+ */
+class CompressionUtil {
+ public:
+  /**
+   * Compress a block.
+   * @param src the data to compress
+   * @param src_length the length of the data
+   * @param[out] dst where to put the compressed data
+   * @param dst_capacity how many bytes dst has room for
+   * @return the length of the compressed data, or 0 if it does not fit into dst_capacity bytes
+   */
+  static size_t Compress(const char *src, size_t src_length, char *dst, size_t dst_capacity);
+
+  /**
+   * Decompress a block that Compress() made.
+   * @param src the compressed data
+   * @param src_length the length of the compressed data
+   * @param[out] dst where to put the decompressed data
+   * @param dst_length the length of the data before it was compressed
+   * @return false if src is not a valid compressed block of dst_length bytes
+   */
+  static bool Decompress(const char *src, size_t src_length, char *dst, size_t dst_length);
+};
+
+}  // namespace bustub
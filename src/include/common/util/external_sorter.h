@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/common/util/external_sorter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts more records than fit in memory. Records are added in any order and read back in sorted order.
+ *
+ * Whenever the records held in memory reach the memory limit, they are sorted and appended to a temporary file as a
+ * run; reading the records back merges the runs. Runs are written sequentially, and read sequentially in chunks that
+ * share the memory limit. If all records fit in memory, nothing is written.
+ *
+ * Records are written to the file byte for byte, so they must not own memory.
+ */
+template <typename T, typename Compare>
+class ExternalSorter {
+  static_assert(std::is_trivially_copy_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                "records are written to a file byte for byte");
+
+ public:
+  /**
+   * @param memory_limit how many bytes of records to hold in memory at most
+   * @param compare the order of the records, a strict weak ordering like std::less
+   */
+  ExternalSorter(size_t memory_limit, Compare compare)
+      : max_records_(std::max<size_t>(memory_limit / sizeof(T), 2)), compare_(std::move(compare)) {}
+
+  ~ExternalSorter() {
+    if (file_ != nullptr) {
+      fclose(file_);
+    }
+  }
+
+  DISALLOW_COPY(ExternalSorter);
+
+  /** Add a record. Records can not be added once they are sorted. */
+  void Add(const T &record) {
+    BUSTUB_ASSERT(!sorted_, "records are already sorted");
+    if (records_.size() == max_records_) {
+      WriteRun();
+    }
+    records_.push_back(record);
+  }
+
+  /** Sort the records added so far, to read them back with Next(). */
+  void Sort() {
+    sorted_ = true;
+    if (runs_.empty()) {
+      std::sort(records_.begin(), records_.end(), compare_);
+      return;
+    }
+    if (!records_.empty()) {
+      WriteRun();
+    }
+    records_.clear();
+    records_.shrink_to_fit();
+    // Every run reads ahead by a share of the memory limit.
+    chunk_size_ = std::max<size_t>(max_records_ / runs_.size(), 1);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      if (ReadChunk(&runs_[i])) {
+        heap_.push(i);
+      }
+    }
+  }
+
+  /**
+   * Read the next record in sorted order.
+   * @param[out] record the record
+   * @return false if there are no records left
+   */
+  bool Next(T *record) {
+    BUSTUB_ASSERT(sorted_, "records must be sorted first");
+    if (runs_.empty()) {
+      if (next_record_ == records_.size()) {
+        return false;
+      }
+      *record = records_[next_record_++];
+      return true;
+    }
+    if (heap_.empty()) {
+      return false;
+    }
+    size_t i = heap_.top();
+    heap_.pop();
+    Run &run = runs_[i];
+    *record = run.chunk_[run.next_in_chunk_++];
+    if (run.next_in_chunk_ < run.chunk_.size() || ReadChunk(&run)) {
+      heap_.push(i);
+    }
+    return true;
+  }
+
+  /** @return the number of runs written to the temporary file */
+  size_t GetNumRuns() const { return runs_.size(); }
+
+ private:
+  /** A sorted run in the temporary file, and the chunk of it in memory while merging. */
+  struct Run {
+    long offset_;  // NOLINT
+    size_t size_;
+    size_t num_read_{0};
+    std::vector<T> chunk_;
+    size_t next_in_chunk_{0};
+  };
+
+  /** Orders runs by their next record, smallest on top of the heap. */
+  struct RunGreater {
+    bool operator()(size_t lhs, size_t rhs) const {
+      const Run &lhs_run = sorter_->runs_[lhs];
+      const Run &rhs_run = sorter_->runs_[rhs];
+      return sorter_->compare_(rhs_run.chunk_[rhs_run.next_in_chunk_], lhs_run.chunk_[lhs_run.next_in_chunk_]);
+    }
+    const ExternalSorter *sorter_;
+  };
+
+  /** Sort the records in memory, and append them to the temporary file as a run. */
+  void WriteRun() {
+    if (file_ == nullptr) {
+      file_ = tmpfile();
+      if (file_ == nullptr) {
+        throw Exception("can't create a temporary file to sort in");
+      }
+    }
+    std::sort(records_.begin(), records_.end(), compare_);
+    // Nothing is read before all runs are written, so runs are appended one after the other.
+    Run run;
+    run.offset_ = ftell(file_);
+    run.size_ = records_.size();
+    if (run.offset_ == -1 || fwrite(records_.data(), sizeof(T), run.size_, file_) != run.size_) {
+      throw Exception("can't write a sorted run to the temporary file");
+    }
+    runs_.push_back(std::move(run));
+    records_.clear();
+  }
+
+  /** Read the next chunk of a run. @return false if the run has been read entirely */
+  bool ReadChunk(Run *run) {
+    size_t count = std::min(chunk_size_, run->size_ - run->num_read_);
+    if (count == 0) {
+      return false;
+    }
+    run->chunk_.resize(count);
+    run->next_in_chunk_ = 0;
+    if (fseek(file_, run->offset_ + static_cast<long>(run->num_read_ * sizeof(T)), SEEK_SET) != 0 ||  // NOLINT
+        fread(run->chunk_.data(), sizeof(T), count, file_) != count) {
+      throw Exception("can't read a sorted run from the temporary file");
+    }
+    run->num_read_ += count;
+    return true;
+  }
+
+  const size_t max_records_;
+  Compare compare_;
+  /** Records not written to a run yet; once sorted, all records if there are no runs. */
+  std::vector<T> records_;
+  size_t next_record_{0};
+  bool sorted_{false};
+  std::FILE *file_{nullptr};
+  std::vector<Run> runs_;
+  /** How many records of each run to read at a time while merging. */
+  size_t chunk_size_{0};
+  std::priority_queue<size_t, std::vector<size_t>, RunGreater> heap_{RunGreater{this}};
+};
+
+}  // namespace bustub
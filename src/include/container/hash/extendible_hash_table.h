@@ -110,7 +110,7 @@ class ExtendibleHashTable {
    * @param dir_page to use for lookup of global depth
    * @return the directory index
    */
-  inline uint32_t KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page);
+  inline uint32_t KeyToDirectoryIndex(KeyType key, const HashTableDirectoryPage *dir_page);
 
   /**
    * Get the bucket page_id corresponding to a key.
@@ -119,22 +119,7 @@ class ExtendibleHashTable {
    * @param dir_page a pointer to the hash table's directory page
    * @return the bucket page_id corresponding to the input key
    */
-  inline page_id_t KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page);
-
-  /**
-   * Fetches the directory page from the buffer pool manager.
-   *
-   * @return a pointer to the directory page
-   */
-  HashTableDirectoryPage *FetchDirectoryPage();
-
-  /**
-   * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
-   *
-   * @param bucket_page_id the page_id to fetch
-   * @return a pair contains a pointer to page and a pointer to bucket page
-   */
-  std::pair<Page *, HASH_TABLE_BUCKET_TYPE *> FetchBucketPage(page_id_t bucket_page_id);
+  inline page_id_t KeyToPageId(KeyType key, const HashTableDirectoryPage *dir_page);
 
   /**
    * Performs insertion with an optional bucket splitting.
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
@@ -24,6 +25,10 @@ namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * The scan asks the index for the RIDs in the plan's key range a batch at a time, and reads the tuples of a batch
+ * from the table with each table page fetched once. No index latch is held between batches, so the tuples can be
+ * modified, e.g. by an update executor above, while they are returned.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +47,22 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  /**
+   * Read the tuples of the next batch of the index scan.
+   * @return false if the scan is done
+   */
+  bool NextBatch();
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index to scan, and the table it indexes. */
+  IndexInfo *index_info_{Catalog::NULL_INDEX_INFO};
+  TableInfo *table_info_{Catalog::NULL_TABLE_INFO};
+  std::unique_ptr<IndexRangeScan> scan_;
+  /** The RIDs of the current batch, and the tuples of those that still exist, in key order. */
+  std::vector<RID> rids_;
+  std::vector<Tuple> tuples_;
+  /** The next tuple of the batch to return. */
+  size_t next_tuple_{0};
 };
 }  // namespace bustub
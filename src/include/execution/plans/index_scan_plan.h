@@ -12,11 +12,18 @@
 
 #pragma once
 
+#include <optional>
+#include <utility>
+
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
+
+/** The order in which an index scan visits the keys of the index. */
+enum class ScanDirection { FORWARD, BACKWARD };
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  */
@@ -28,9 +35,19 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
    * @param table_oid the identifier of table to be scanned
+   * @param low_key the smallest key to scan, in the index's key schema, or nullopt to scan from the first key
+   * @param high_key the greatest key to scan, in the index's key schema, or nullopt to scan to the last key
+   * @param direction the order in which to scan the keys
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    std::optional<Tuple> low_key = std::nullopt, std::optional<Tuple> high_key = std::nullopt,
+                    ScanDirection direction = ScanDirection::FORWARD)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        low_key_(std::move(low_key)),
+        high_key_(std::move(high_key)),
+        direction_(direction) {}
 
   PlanType GetType() const override { return PlanType::IndexScan; }
 
@@ -40,11 +57,25 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return the smallest key to scan, or nullopt if there is no lower bound */
+  const std::optional<Tuple> &GetLowKey() const { return low_key_; }
+
+  /** @return the greatest key to scan, or nullopt if there is no upper bound */
+  const std::optional<Tuple> &GetHighKey() const { return high_key_; }
+
+  /** @return the order in which to scan the keys */
+  ScanDirection GetDirection() const { return direction_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** The bounds of the keys to scan, both included. */
+  std::optional<Tuple> low_key_;
+  std::optional<Tuple> high_key_;
+  /** The order in which to scan the keys. */
+  ScanDirection direction_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_engine.h
+//
+// Identification: src/include/storage/disk/async_io_engine.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace bustub {
+
+/**
+ * A single asynchronous read or write of a file descriptor.
+ */
+struct IoRequest {
+  enum class Type { READ, WRITE };
+
+  Type type_;
+  int fd_;
+  size_t offset_;
+  /** The buffer to read into or write from. Must stay valid until the callback has run. */
+  char *data_;
+  size_t size_;
+  /**
+   * Invoked exactly once, on an engine thread, when the request completes. The argument is the number of bytes
+   * transferred (which may be short, e.g. at the end of the file) or a negative errno.
+   */
+  std::function<void(ssize_t)> callback_;
+};
+
+/**
+ * AsyncIoEngine performs file I/O in the background. Submit() only queues a request and returns; everything queued
+ * while the engine is busy goes out together as one batch.
+ */
+class AsyncIoEngine {
+ public:
+  AsyncIoEngine() = default;
+  AsyncIoEngine(const AsyncIoEngine &) = delete;
+  AsyncIoEngine &operator=(const AsyncIoEngine &) = delete;
+
+  /**
+   * Destroys the engine. Requests that have already been submitted are completed first.
+   */
+  virtual ~AsyncIoEngine() = default;
+
+  /**
+   * Queue a request.
+   * @param request the request to perform
+   */
+  virtual void Submit(IoRequest request) = 0;
+
+  /**
+   * Create the best engine available: io_uring where the kernel supports it, a thread pool otherwise.
+   * @param queue_depth the maximum number of requests that are in flight at once
+   */
+  static std::unique_ptr<AsyncIoEngine> Create(size_t queue_depth);
+};
+
+}  // namespace bustub
@@ -14,11 +14,17 @@
 
 #include <atomic>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_io_engine.h"
 
 namespace bustub {
 
@@ -28,13 +34,37 @@ namespace bustub {
  */
 class DiskManager {
  public:
+  /** How pages of the database file are read and written. The log file always goes through a stream. */
+  enum class Backend {
+    /** A single std::fstream; all page I/O is serialized behind one latch. */
+    FSTREAM,
+    /** A file descriptor accessed with positional pread()/pwrite(), so threads do not serialize on the file. */
+    PREAD,
+    /**
+     * Like PREAD, but the file is opened with O_DIRECT to bypass the OS page cache. Page buffers should be aligned to
+     * PAGE_SIZE (buffer pool frames are); unaligned ones are bounced through an aligned buffer. Falls back to PREAD if
+     * the file system does not support O_DIRECT.
+     */
+    PREAD_DIRECT
+  };
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param backend how pages of the database file are read and written
+   * @param checksums whether to keep a CRC32C checksum of every page written, and verify it when the page is read
+   * back. The checksums are kept next to the database file, since pages have no room left for them. A page may match
+   * the checksum of what it held before its last write as well, so that a crash during the write does not leave it
+   * failing. Opening the database without checksums keeps them, but drops those of the pages written meanwhile.
+   * @param compression whether a new database file stores its pages compressed. Compressed pages take up a whole
+   * number of 512 byte sectors, wherever in the file there is room for them; a map kept next to the database file
+   * tells where each page is. Whether an existing database file is compressed was decided when it was created.
+   * Compressed files are never accessed with direct I/O.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, Backend backend = Backend::PREAD, bool checksums = false,
+                       bool compression = false);
 
-  ~DiskManager() = default;
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -45,15 +75,97 @@ class DiskManager {
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
+   * @return false on an I/O error, which may leave the page as it was or half written
+   */
+  bool WritePage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Allocate a page in the database file. Deallocated pages are reused before the file is grown. Allocations are
+   * recorded in an allocation map that is kept next to the database file, so they survive restarts.
+   * @param is_eligible which page ids the caller can take, e.g. only those of its buffer pool instance. nullptr for
+   * all of them.
+   * @return the lowest page id that is free and eligible
+   */
+  page_id_t AllocatePage(const std::function<bool(page_id_t)> &is_eligible = nullptr);
+
+  /**
+   * Deallocate a page, so that AllocatePage() can hand it out again. Does nothing if the page is not allocated.
+   * @param page_id id of the page
+   * @return false if the page was not allocated, e.g. because it has been deallocated already
+   */
+  bool DeallocatePage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  bool IsAllocated(page_id_t page_id);
+
+  /** @return the number of allocated pages */
+  size_t GetNumAllocatedPages();
+
+  /**
+   * Shrink the database file: cut it off after the last allocated page, and release the disk blocks of deallocated
+   * pages before that (where the file system supports punching holes). Page ids do not change, pages hold references
+   * to each other by id. Must only be called while no buffer pool is using the file, e.g. by an offline tool.
+   * @return the number of bytes of the file that no longer take up disk space
+   */
+  size_t Compact();
+
+  /**
+   * Write a run of consecutive pages to the database file. The file descriptor backends write the whole run with
+   * pwritev(). The pages are not synced, call SyncDbFile() for that.
+   * @param first_page_id id of the first page of the run
+   * @param pages raw data of the pages first_page_id, first_page_id + 1, ...
+   * @return false on an I/O error, which may leave any page of the run as it was or half written
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  bool WritePages(page_id_t first_page_id, const std::vector<const char *> &pages);
 
   /**
-   * Read a page from the database file.
+   * Make sure every page written so far has reached the disk, i.e. fsync() the database file and the allocation map.
+   */
+  void SyncDbFile();
+
+  /**
+   * Read a page from the database file. Parts of the page that lie beyond the end of the file read as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false if the read failed, or the page does not match its checksum
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Start reading a page from the database file in the background. Reads that are submitted close together are sent
+   * to the disk as one batch.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the callback has run
+   * @param callback invoked once the read is done, on an I/O thread, with false if it failed or the page does not
+   * match its checksum
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  void SubmitReadPage(page_id_t page_id, char *page_data, std::function<void(bool)> callback);
+
+  /**
+   * Start reading a page from the database file in the background.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the future is ready
+   * @return a future that becomes true once the page has been read, false if the read failed or the page does not
+   * match its checksum
+   */
+  std::future<bool> SubmitReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Start writing a page to the database file in the background. Writes that are submitted close together are sent
+   * to the disk as one batch.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay valid and unchanged until the callback has run
+   * @param callback invoked once the write is done, on an I/O thread, with false if it failed
+   */
+  void SubmitWritePage(page_id_t page_id, const char *page_data, std::function<void(bool)> callback);
+
+  /**
+   * Start writing a page to the database file in the background.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay valid and unchanged until the future is ready
+   * @return a future that becomes true once the page has been written, false if the write failed
+   */
+  std::future<bool> SubmitWritePage(page_id_t page_id, const char *page_data);
 
   /**
    * Flush the entire log buffer into disk.
@@ -80,6 +192,12 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of pages read from the database file */
+  int GetNumReads() const;
+
+  /** @return the number of bytes read from the database file for pages */
+  inline uint64_t GetNumBytesRead() const { return num_bytes_read_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -89,8 +207,86 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+  /** @return the backend used for the database file, PREAD if PREAD_DIRECT was asked for but is not supported */
+  inline Backend GetBackend() const { return backend_; }
+
+  /** @return true if pages are checksummed */
+  inline bool UsesChecksums() const { return checksums_enabled_; }
+
+  /** @return the number of page reads that did not match the checksum of the page */
+  inline int GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+  /** @return true if pages are stored compressed */
+  inline bool IsCompressed() const { return compressed_; }
+
  private:
   int GetFileSize(const std::string &file_name);
+  /** Open the database file as a file descriptor for the PREAD and PREAD_DIRECT backends. */
+  void OpenDbFile();
+  /**
+   * pread()/pwrite() a whole page at offset, bouncing it through an aligned buffer if direct I/O requires it. Both
+   * return false on an I/O error.
+   */
+  bool ReadPageFd(size_t offset, char *page_data);
+  bool WritePageFd(size_t offset, const char *page_data);
+  /** @return true if page_data cannot be used for direct I/O as it is */
+  bool NeedsBounce(const char *page_data) const;
+  /** Grow the cached file size to at least file_size. */
+  void GrowFileSize(size_t file_size);
+  /** @return the engine for Submit*Page(), creating it on first use */
+  AsyncIoEngine *GetIoEngine();
+  /**
+   * Open the allocation map, or create it. A new or empty database file starts with an empty map; an existing
+   * database file without one has all its pages allocated.
+   */
+  void OpenAllocationMap();
+  /**
+   * Set or clear the allocation map bit of a page, in memory and in the map file. Must be called under alloc_latch_.
+   */
+  void SetAllocated(page_id_t page_id, bool allocated);
+  /** Open the checksum file if checksums are asked for, or if not but there is one that needs to be kept current. */
+  void OpenChecksums(bool checksums);
+  /**
+   * Remember the checksums of pages that are about to be written, in memory and in the checksum file, next to those of
+   * what is on disk now. A checksum of 0 drops both.
+   */
+  void RecordChecksums(page_id_t first_page_id, const std::vector<uint32_t> &checksums);
+  /** Forget the checksums of what was on disk before pages were written, now that the writes have completed. */
+  void CommitChecksums(page_id_t first_page_id, size_t num_pages);
+  /** Write checksums_ of some pages through to the checksum file. Must be called under checksum_latch_. */
+  void WriteChecksums(page_id_t first_page_id, size_t num_pages);
+  /** @return the checksum of a page as it is stored, never 0, which stands for a page without checksum */
+  static uint32_t ChecksumOf(const char *page_data);
+  /** @return false if the page has a checksum that page_data does not match */
+  bool VerifyChecksum(page_id_t page_id, const char *page_data);
+  /**
+   * Decide whether the database file is compressed, and if it is, load the page map and find the free sectors. Must
+   * be called before the database file is opened.
+   */
+  void OpenPageMap(bool compression);
+  /**
+   * Compress a page and write it wherever it fits, moving it if it no longer fits where it was. @return false on an
+   * I/O error, which leaves the page where it was
+   */
+  bool WriteCompressedPage(page_id_t page_id, const char *page_data);
+  /** Read a compressed page and decompress it. @return false if it could not be read or decompressed */
+  bool ReadCompressedPage(page_id_t page_id, char *page_data);
+  /** Give the sectors of a deallocated page back. */
+  void ReleaseCompressedPage(page_id_t page_id);
+  /** Cut a compressed database file off after its last used sector, and punch holes where sectors are free. */
+  size_t CompactCompressed(int fd, size_t old_size);
+  /** Find room for num_sectors consecutive sectors. Must be called under page_map_latch_. */
+  uint32_t AllocateSectors(size_t num_sectors);
+  /** Make count sectors from first_sector on available. Must be called under page_map_latch_. */
+  void FreeSectors(uint32_t first_sector, size_t count);
+  /**
+   * Rebuild the free sectors from page_locations_, as the gaps between the pages. Must be called under
+   * page_map_latch_.
+   * @return the gaps, as first sector and number of sectors
+   */
+  std::vector<std::pair<uint32_t, uint32_t>> FindFreeSectors();
+  /** Write the location of a page, in memory and in the page map file. Must be called under page_map_latch_. */
+  void SetPageLocation(page_id_t page_id, uint32_t first_sector, uint32_t length);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -98,11 +294,64 @@ class DiskManager {
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
+  // With multiple buffer pool instances, need to protect file access (FSTREAM backend only)
   std::mutex db_io_latch_;
+  Backend backend_;
+  // file descriptor of the db file (PREAD and PREAD_DIRECT backends)
+  int db_fd_{-1};
+  // size of the db file, kept up to date by WritePage so that reads need not stat() the file
+  std::atomic<size_t> db_file_size_{0};
+  // engine behind SubmitReadPage() and SubmitWritePage(), created on first use (PREAD and PREAD_DIRECT backends)
+  std::unique_ptr<AsyncIoEngine> io_engine_;
+  std::once_flag io_engine_created_;
+  // allocation map, one bit per page id, set if the page is allocated. Mirrored to the file alloc_name_.
+  std::vector<uint8_t> allocation_map_;
+  std::string alloc_name_;
+  int alloc_fd_{-1};
+  // the page ids below next_page_id_ that are free, and one past the highest page id that has ever been allocated
+  std::set<page_id_t> free_page_ids_;
+  page_id_t next_page_id_{0};
+  size_t num_allocated_pages_{0};
+  // protects all of the allocation state above
+  std::mutex alloc_latch_;
+  // the checksums a page may match: of what was on disk before its last write, and of what that write wrote. They
+  // are the same once the write has completed, old_ is 0 for a page that had no checksum before, and both are 0 for a
+  // page that has none. The checksum of a write is recorded before the page is written, so that the page matches
+  // whether or not a crash lets the write make it to disk.
+  struct PageChecksums {
+    uint32_t old_;
+    uint32_t new_;
+  };
+  // checksums of every page written. Mirrored to the file checksum_name_.
+  std::vector<PageChecksums> checksums_;
+  std::string checksum_name_;
+  int checksum_fd_{-1};
+  // whether pages are checksummed. If not, checksum_fd_ may still be open so that written pages lose their checksums.
+  bool checksums_enabled_{false};
+  std::atomic<int> num_checksum_failures_{0};
+  // protects checksums_
+  std::mutex checksum_latch_;
+  std::atomic<uint64_t> num_bytes_read_{0};
+  // where a page of a compressed database file is stored: its first sector, and its compressed length (PAGE_SIZE if
+  // it is stored as it is, 0 if it has never been written)
+  struct PageLocation {
+    uint32_t first_sector_;
+    uint32_t length_;
+  };
+  bool compressed_{false};
+  // location of every page, mirrored to the file page_map_name_
+  std::vector<PageLocation> page_locations_;
+  std::string page_map_name_;
+  int page_map_fd_{-1};
+  // the first sectors of free runs of sectors, by the length of the run, and one past the last sector in use
+  std::vector<std::vector<uint32_t>> free_sectors_;
+  uint32_t next_sector_{0};
+  // protects the page map and the free sectors
+  std::mutex page_map_latch_;
 };
 
 }  // namespace bustub
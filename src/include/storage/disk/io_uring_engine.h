@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_engine.h
+//
+// Identification: src/include/storage/disk/io_uring_engine.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/async_io_engine.h"
+
+namespace bustub {
+
+/**
+ * IoUringEngine is the AsyncIoEngine for Linux. It talks to the kernel through the raw io_uring system calls and
+ * shared rings, without liburing.
+ *
+ * A submitter thread moves all queued requests into the submission ring and hands them to the kernel with a single
+ * io_uring_enter() call. A reaper thread waits for completions and runs the callbacks.
+ */
+class IoUringEngine : public AsyncIoEngine {
+ public:
+  /**
+   * Try to create an IoUringEngine.
+   * @param queue_depth the maximum number of requests in flight at once
+   * @return the engine, or nullptr if io_uring is not available
+   */
+  static std::unique_ptr<IoUringEngine> Create(size_t queue_depth);
+
+  ~IoUringEngine() override;
+
+  void Submit(IoRequest request) override;
+
+ private:
+  IoUringEngine() = default;
+
+  /** Set up the ring. @return false if the kernel does not support io_uring */
+  bool Setup(size_t queue_depth);
+
+  /** Body of the submitter thread. */
+  void SubmitLoop();
+
+  /** Body of the reaper thread. */
+  void ReapLoop();
+
+  /**
+   * Hand to_submit entries of the submission ring to the kernel.
+   * @return false if io_uring_enter() failed for good, with errno set
+   */
+  bool Enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+
+  /**
+   * Give up on the ring after io_uring_enter() failed for good: complete every request that is queued or in flight
+   * with -error, and every request submitted from now on as well.
+   */
+  void FailAll(int error);
+
+  int ring_fd_{-1};
+  /** The mmap()ed rings and their sizes. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the rings. */
+  std::atomic<unsigned> *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  std::atomic<unsigned> *cq_head_{nullptr};
+  std::atomic<unsigned> *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  void *cqes_{nullptr};
+  unsigned num_entries_{0};
+  /** Whether io_uring_enter() takes a timeout for waiting on completions. */
+  bool ext_arg_{false};
+
+  /** Requests that have been submitted but not handed to the kernel yet. */
+  std::deque<IoRequest> pending_;
+  /** Requests the kernel is working on, indexed by their user_data. Free slots have no callback. */
+  std::vector<IoRequest> in_flight_;
+  /** Indexes of in_flight_ that are not in use. */
+  std::vector<unsigned> free_slots_;
+  bool shutdown_{false};
+  /** The errno io_uring_enter() failed with for good, 0 while the ring works. */
+  int error_{0};
+  /** Protects pending_, in_flight_, free_slots_, shutdown_ and error_. */
+  std::mutex latch_;
+  /** Signalled when there is something to submit, or room to submit it. */
+  std::condition_variable cv_;
+
+  std::thread submitter_;
+  std::thread reaper_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool_io_engine.h
+//
+// Identification: src/include/storage/disk/thread_pool_io_engine.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/async_io_engine.h"
+
+namespace bustub {
+
+/**
+ * ThreadPoolIoEngine is the portable AsyncIoEngine: a few worker threads take requests off a shared queue and
+ * perform them with blocking pread()/pwrite().
+ */
+class ThreadPoolIoEngine : public AsyncIoEngine {
+ public:
+  /**
+   * Create a new ThreadPoolIoEngine.
+   * @param num_threads the number of worker threads, i.e. the number of requests in flight at once
+   */
+  explicit ThreadPoolIoEngine(size_t num_threads);
+
+  ~ThreadPoolIoEngine() override;
+
+  void Submit(IoRequest request) override;
+
+ private:
+  /** Body of the worker threads. */
+  void Work();
+
+  std::vector<std::thread> workers_;
+  std::deque<IoRequest> pending_;
+  bool shutdown_{false};
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
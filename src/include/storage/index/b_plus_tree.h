@@ -10,10 +10,14 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -32,6 +36,10 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is thread-safe, with latch crabbing on the page latches. Lookups and iterators go down with read latches.
+ * Inserts and removes first go down the same way and write-latch only the leaf, which is all they need unless the leaf
+ * splits or merges; if it would, they let go and go down again holding write latches on every node that may change.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +48,9 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LeafPage::DEFAULT_MAX_SIZE,
+                     int internal_max_size = InternalPage::DEFAULT_MAX_SIZE,
+                     page_id_t header_page_id = HEADER_PAGE_ID);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -54,6 +64,41 @@ class BPlusTree {
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Build the tree bottom-up from pairs in increasing key order, instead of inserting them one at a time: leaves are
+   * filled left to right, and each level above is filled as the level below it grows. Apart from the right edge of the
+   * tree, each page is filled once, in the order the pages are allocated. A pair whose key is not greater than the one
+   * before it is skipped. If the tree is not empty, the pairs are inserted one at a time instead.
+   * @param next_pair sets its argument to the next pair, and returns false when there are none left
+   * @param fill_factor how full to fill each node, from 0.5 to 1; the rest is room for later inserts
+   */
+  void BulkLoad(const std::function<bool(MappingType *)> &next_pair, float fill_factor = 1.0F);
+
+  /** Where the next batch of a range scan starts, see ScanBatch(). */
+  struct ScanCursor {
+    /** The key to start at, or nullopt to start at the first pair (forward) or the last one (backward). */
+    std::optional<KeyType> key_;
+    /** Whether to leave key_ itself out. */
+    bool exclusive_{false};
+    /** Whether the scan has gone past the last leaf (forward) or the first one (backward). */
+    bool done_{false};
+  };
+
+  /**
+   * Copy the next pairs of a range scan into a batch. No latch is held between batches, unlike with an iterator, so the
+   * caller may modify the tree while it works through a batch; the scan then sees some of the changes, like an
+   * iterator does for other threads' changes.
+   *
+   * Going forward, the scan finds the leaf of the cursor's key and walks the leaves' next page links from there,
+   * latching each leaf before it lets go of the one before. Leaves have no links back, so going backward it goes down
+   * from the root for every leaf, to the one just below the smallest key that the last leaf could hold.
+   * @param cursor where the batch starts, moved on to where the next one starts
+   * @param forward whether to scan in increasing key order
+   * @param max_pairs how many pairs to copy, rounded up to whole leaves
+   * @param[out] batch the pairs, appended in scan order
+   */
+  void ScanBatch(ScanCursor *cursor, bool forward, size_t max_pairs, std::vector<MappingType> *batch);
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
@@ -80,30 +125,110 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  /** What a write operation may do to the nodes it passes, which decides whether they are safe. */
+  enum class Operation { INSERT, REMOVE };
+
+  /** The pages a pessimistic insert or remove holds. */
+  struct WriteSet {
+    /** Whether root_latch_ is held, i.e. whether the operation may change the root. */
+    bool root_latched_{false};
+    /** Write-latched and pinned pages, from the highest one that the operation may change down to the leaf. */
+    std::vector<Page *> pages_;
+    /** Pages emptied by the operation, deleted once it has released everything. */
+    std::vector<page_id_t> deleted_page_ids_;
+  };
+
+  /** Which leaf a descent with read latches looks for. */
+  enum class Target {
+    KEY,         // the leaf that may contain the key
+    BEFORE_KEY,  // the leaf that may contain the greatest key less than the key
+    LEFT_MOST,
+    RIGHT_MOST
+  };
+
+  /**
+   * Descend with read latches.
+   * @param[out] low_fence if not null, set to the smallest key that the leaf may hold, or nullopt for the leftmost leaf
+   * @return the leaf page that target names, pinned and read-latched, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageRead(const KeyType &key, Target target, std::optional<KeyType> *low_fence = nullptr);
+
+  /**
+   * Descend with read latches, and write-latch only the leaf.
+   * @return the leaf page that may contain key, pinned and write-latched, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageOptimistic(const KeyType &key);
+
+  /**
+   * Descend with write latches, holding on to the nodes that the operation may change: a node is let go of, along with
+   * root_latch_, as soon as a node below it is safe. root_latch_ must be write-locked and the tree must not be empty.
+   * @return the leaf page that may contain key, which is the last page of write_set
+   */
+  Page *FindLeafPagePessimistic(const KeyType &key, Operation operation, WriteSet *write_set);
+
+  /** @return whether the operation on key can not split or merge node, and so can not change its parent */
+  bool IsSafe(BPlusTreePage *node, Operation operation, const KeyType &key) const;
+
+  /** @return the page of write_set with the given id, e.g. the parent of a node that splits or merges */
+  Page *PageOf(page_id_t page_id, WriteSet *write_set) const;
+
+  /** Unlatch and unpin the pages of write_set, unlock root_latch_, then delete the emptied pages. */
+  void ReleaseWriteSet(WriteSet *write_set, bool is_dirty);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, WriteSet *write_set);
 
-  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, WriteSet *write_set);
 
+  /**
+   * Move the upper half of a node to a new right sibling, or, for a leaf, the pairs from index on.
+   * @return the new node, pinned
+   */
   template <typename N>
-  N *Split(N *node);
+  N *Split(N *node, int index = -1);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, WriteSet *write_set);
 
   template <typename N>
-  bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+  bool Coalesce(N *neighbor_node, N *node, InternalPage *parent, int index, WriteSet *write_set);
 
+  /** @return whether Redistribute() keeps neighbor_node from becoming underfull, and its keys fit where they go */
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  bool CanRedistribute(N *neighbor_node, N *node, InternalPage *parent, int index) const;
 
-  bool AdjustRoot(BPlusTreePage *node);
+  template <typename N>
+  void Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index);
+
+  bool AdjustRoot(BPlusTreePage *node, WriteSet *write_set);
 
   void UpdateRootPageId(int insert_record = 0);
 
+  /** The rightmost node of a level of a tree that BulkLoad() is building, which is still being filled. */
+  struct BulkLoadNode {
+    /** The page of the node, pinned, or nullptr if the level has no node being filled. */
+    Page *page_{nullptr};
+    /** The smallest key under the node, which goes into its parent. */
+    KeyType low_key_;
+  };
+
+  /** Build the tree of BulkLoad() bottom-up and make it the root. root_latch_ must be write-locked. */
+  void BulkLoadTree(const std::function<bool(MappingType *)> &next_pair, float fill_factor);
+
+  /** Allocate a page for BulkLoadTree(), and remember it so that a failed bulk load can delete it. */
+  Page *BulkLoadNewPage(page_id_t *page_id);
+
+  /** Delete a page that BulkLoadTree() allocated and no longer needs. */
+  void BulkLoadDeletePage(page_id_t page_id);
+
+  /** Append a child to the node being filled at a level above the leaves, starting a new node if it is full. */
+  void BulkLoadAppend(std::vector<BulkLoadNode> *levels, size_t level, const KeyType &key, page_id_t page_id,
+                      float fill_factor);
+
+  /** Make sure the node being filled at a level is at least half full, then append it to its parent. */
+  void BulkLoadFinish(std::vector<BulkLoadNode> *levels, size_t level, float fill_factor);
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -111,11 +236,21 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  /** Changed only with root_latch_ write-locked. */
+  std::atomic<page_id_t> root_page_id_;
+  /**
+   * Guards root_page_id_ as if it were the latch of a page above the root: descents start by locking it, and let go of
+   * it like of any other page once the root is latched (and safe, for writers).
+   */
+  ReaderWriterLatch root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  /** The header page that records the root page id, or INVALID_PAGE_ID to record it nowhere. */
+  page_id_t header_page_id_;
+  /** The pages that a bulk load in progress has allocated and not deleted, under root_latch_. */
+  std::vector<page_id_t> bulk_load_page_ids_;
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -34,15 +35,38 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  std::unique_ptr<IndexRangeScan> ScanRange(const Tuple *low_key, const Tuple *high_key, bool reverse,
+                                            Transaction *transaction) override;
+
+  /**
+   * Fill an empty index with an entry for every tuple of a table, see BPlusTree::BulkLoad(). The entries are sorted
+   * first; those that do not fit in memory are sorted in runs written to a temporary file.
+   * @param table_heap the table
+   * @param schema the schema of the table
+   * @param transaction the transaction to scan the table in
+   * @param fill_factor how full to fill each node, from 0.5 to 1
+   * @param sort_memory how many bytes of entries to sort in memory
+   */
+  void BulkLoad(TableHeap *table_heap, const Schema &schema, Transaction *transaction, float fill_factor = 1.0F,
+                size_t sort_memory = DEFAULT_SORT_MEMORY);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+ private:
+  static constexpr size_t DEFAULT_SORT_MEMORY = 64 << 20;
+
+  /** @return the id of a new, initialized header page. Throws if no page can be allocated. */
+  static page_id_t NewHeaderPage(BufferPoolManager *buffer_pool_manager);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
+  // header page of the container, which page 0 can not be: it may belong to a table
+  page_id_t header_page_id_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
 };
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 #include "storage/table/tuple.h"
 #include "type/value.h"
@@ -32,9 +34,12 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    memcpy(data_, tuple.GetData(), std::min<size_t>(tuple.GetLength(), KeySize));
   }
 
+  // the key schema is for keys that encode their columns, see VarlenKey
+  inline void SetFromKey(const Tuple &tuple, [[maybe_unused]] const Schema &key_schema) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -94,13 +99,93 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  /**
+   * Find the first of size sorted keys that is >= key, or > key if upper, like std::lower_bound. The keys are stride
+   * bytes apart, e.g. in the pairs of a B+ tree page.
+   *
+   * Keys of a single integer column are compared as the integers they start with, by a binary search that does not
+   * branch on the comparisons; others go through operator().
+   */
+  inline int LowerBound(const GenericKey<KeySize> *keys, size_t stride, int size, const GenericKey<KeySize> &key,
+                        bool upper = false) const {
+    switch (integer_type_) {
+      case TypeId::TINYINT:
+        return IntegerLowerBound<int8_t>(keys, stride, size, key, upper);
+      case TypeId::SMALLINT:
+        return IntegerLowerBound<int16_t>(keys, stride, size, key, upper);
+      case TypeId::INTEGER:
+        return IntegerLowerBound<int32_t>(keys, stride, size, key, upper);
+      case TypeId::BIGINT:
+        return IntegerLowerBound<int64_t>(keys, stride, size, key, upper);
+      default:
+        break;
+    }
+    int low = 0;
+    int high = size;
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      int cmp = (*this)(*reinterpret_cast<const GenericKey<KeySize> *>(reinterpret_cast<const char *>(keys) +
+                                                                          mid * stride),
+                        key);
+      if (cmp < 0 || (cmp == 0 && upper)) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, integer_type_{other.integer_type_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema), integer_type_(IntegerType(key_schema)) {}
 
  private:
+  /** @return the type of the key if it is a single integer column, which starts the key, or INVALID */
+  static TypeId IntegerType(const Schema *key_schema) {
+    if (key_schema == nullptr || key_schema->GetColumnCount() != 1) {
+      return TypeId::INVALID;
+    }
+    TypeId type = key_schema->GetColumn(0).GetType();
+    bool is_integer =
+        type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+    return is_integer ? type : TypeId::INVALID;
+  }
+
+  template <typename T>
+  static int IntegerLowerBound(const GenericKey<KeySize> *keys, size_t stride, int size,
+                               const GenericKey<KeySize> &key, bool upper) {
+    if (size == 0) {
+      return 0;
+    }
+    T value;
+    memcpy(&value, key.data_, sizeof(T));
+    // Count the keys before the one looked for as keys < value + 1 if upper; an upper bound of the largest value is
+    // past all keys.
+    if (upper && value == std::numeric_limits<T>::max()) {
+      return size;
+    }
+    int64_t bound = static_cast<int64_t>(value) + (upper ? 1 : 0);
+    const char *base = reinterpret_cast<const char *>(keys);
+    // Halve the range that holds the answer until it is one key, picking the half with a conditional move rather than
+    // a branch that mispredicts half of the time.
+    while (size > 1) {
+      int half = size / 2;
+      T middle;
+      memcpy(&middle, base + half * stride, sizeof(T));
+      base = middle < bound ? base + half * stride : base;
+      size -= half;
+    }
+    T last;
+    memcpy(&last, base, sizeof(T));
+    return static_cast<int>((base - reinterpret_cast<const char *>(keys)) / stride) + (last < bound ? 1 : 0);
+  }
+
   Schema *key_schema_;
+  /** The type of the key if it is a single integer column, which LowerBound() compares directly; INVALID if not. */
+  TypeId integer_type_;
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -96,6 +97,22 @@ class IndexMetadata {
   Schema *key_schema_;
 };
 
+/**
+ * IndexRangeScan returns the entries of an ordered index whose keys are in a range, in key order, a batch at a time.
+ * Nothing is latched between batches, so the index may be modified while a batch is worked through.
+ */
+class IndexRangeScan {
+ public:
+  virtual ~IndexRangeScan() = default;
+
+  /**
+   * Get the next batch of the scan.
+   * @param[out] result the RIDs of the batch, appended in scan order
+   * @return false if the scan is done, in which case nothing is appended
+   */
+  virtual bool NextBatch(std::vector<RID> *result) = 0;
+};
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -175,6 +192,21 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Scan the index for the keys in a range, bounds included. Only ordered indexes support this.
+   * @param low_key The smallest key of the range, or nullptr if there is no lower bound
+   * @param high_key The greatest key of the range, or nullptr if there is no upper bound
+   * @param reverse Whether to scan in decreasing key order
+   * @param transaction The transaction context
+   * @return The scan
+   */
+  virtual std::unique_ptr<IndexRangeScan> ScanRange([[maybe_unused]] const Tuple *low_key,
+                                                    [[maybe_unused]] const Tuple *high_key,
+                                                    [[maybe_unused]] bool reverse,
+                                                    [[maybe_unused]] Transaction *transaction) {
+    throw NotImplementedException("index does not support range scans");
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -19,11 +19,34 @@ namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * An iterator over the key & value pairs of a B+ tree, in key order.
+ *
+ * The iterator keeps the leaf page it is on pinned and read-latched, so that the leaf can not change under it, and
+ * latches the next leaf before it lets go of the current one. A thread must therefore not modify the tree while it
+ * holds an iterator that is not at the end, or it may wait for its own latch.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Create an end iterator. */
   IndexIterator();
+
+  /**
+   * Create an iterator on a leaf page.
+   * @param buffer_pool_manager the buffer pool manager of the tree
+   * @param page the leaf page, pinned and read-latched; the iterator releases it
+   * @param index the position of the first pair to visit, which may be past the end of the leaf
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index);
+
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
+
   ~IndexIterator();
 
   bool IsEnd();
@@ -32,12 +55,29 @@ class IndexIterator {
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return page_->GetPageId() == itr.page_->GetPageId() && index_ == itr.index_;
+  }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** Move on to the next leaf until index_ is on a pair, or become an end iterator. */
+  void SkipExhaustedLeaves();
+
+  /** Unlatch and unpin the current leaf, if any. */
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  /** The current leaf page, or nullptr at the end. */
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  /** The pair last dereferenced, copied out of the leaf, which may not store it as is (see VarlenKey). */
+  MappingType item_;
 };
 
 }  // namespace bustub
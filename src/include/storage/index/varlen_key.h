@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_key.h
+//
+// Identification: src/include/storage/index/varlen_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Compare two byte strings like memcmp, where a string that the other one starts with is the smaller one.
+ * @return negative, zero or positive as lhs is less than, equal to or greater than rhs
+ */
+inline int CompareKeyBytes(const char *lhs, size_t lhs_size, const char *rhs, size_t rhs_size) {
+  int cmp = memcmp(lhs, rhs, std::min(lhs_size, rhs_size));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return lhs_size < rhs_size ? -1 : (lhs_size > rhs_size ? 1 : 0);
+}
+
+/**
+ * Variable-length key used for indexing, unlike GenericKey, whose keys all take KeySize bytes.
+ *
+ * The columns of the key are encoded so that comparing two keys is comparing their bytes (see CompareKeyBytes), with
+ * no need for the key schema. Each column is a byte that is 0 for NULL and 1 otherwise, followed by the value:
+ * integers big-endian with the sign bit flipped, decimals likewise with all bits flipped if negative, and strings
+ * byte by byte. A string is followed by 0 0, with each 0 byte in it written as 0 1, unless it is the last column.
+ *
+ * The key holds at most KeySize bytes of encoded columns, and B+ tree pages store only as many as it has, see
+ * BPlusTreeLeafPage<VarlenKey<KeySize>, ValueType, VarlenComparator<KeySize>>.
+ */
+template <size_t KeySize>
+class VarlenKey {
+  static_assert(KeySize <= UINT16_MAX, "the size of a key is stored in 16 bits");
+
+ public:
+  /** Encode a key tuple, which has the key schema. */
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    size_ = 0;
+    uint32_t column_count = key_schema.GetColumnCount();
+    for (uint32_t i = 0; i < column_count; i++) {
+      AppendValue(tuple.GetValue(&key_schema, i), i + 1 == column_count);
+    }
+    // Hash functions read all KeySize bytes.
+    memset(data_ + size_, 0, KeySize - size_);
+  }
+
+  /** Set the encoded bytes of the key, e.g. to copy them out of a page. */
+  inline void SetFromBytes(const char *data, size_t size) {
+    if (size > KeySize) {
+      throw Exception("can't index a key longer than " + std::to_string(KeySize) + " bytes");
+    }
+    size_ = static_cast<uint16_t>(size);
+    memcpy(data_, data, size);
+    memset(data_ + size_, 0, KeySize - size_);
+  }
+
+  // NOTE: for test purpose only
+  // encode a single BIGINT column
+  inline void SetFromInteger(int64_t key) {
+    size_ = 0;
+    AppendValue(Value(TypeId::BIGINT, key), true);
+    memset(data_ + size_, 0, KeySize - size_);
+  }
+
+  // NOTE: for test purpose only
+  // encode a single VARCHAR column
+  inline void SetFromString(const std::string &key) {
+    size_ = 0;
+    AppendValue(Value(TypeId::VARCHAR, key), true);
+    memset(data_ + size_, 0, KeySize - size_);
+  }
+
+  inline const char *GetData() const { return data_; }
+
+  inline size_t GetSize() const { return size_; }
+
+  // NOTE: for test purpose only
+  // print the encoded bytes, the printable ones as they are
+  friend std::ostream &operator<<(std::ostream &os, const VarlenKey &key) {
+    for (size_t i = 0; i < key.size_; i++) {
+      auto byte = static_cast<unsigned char>(key.data_[i]);
+      if (isprint(byte) != 0 && byte != '\\') {
+        os << key.data_[i];
+      } else {
+        os << "\\x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte) << std::dec;
+      }
+    }
+    return os;
+  }
+
+ private:
+  inline void AppendValue(const Value &value, bool is_last) {
+    if (value.IsNull()) {
+      AppendByte(0);
+      return;
+    }
+    AppendByte(1);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendInteger(value.GetAs<int8_t>());
+        break;
+      case TypeId::SMALLINT:
+        AppendInteger(value.GetAs<int16_t>());
+        break;
+      case TypeId::INTEGER:
+        AppendInteger(value.GetAs<int32_t>());
+        break;
+      case TypeId::BIGINT:
+        AppendInteger(value.GetAs<int64_t>());
+        break;
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>());
+        break;
+      case TypeId::DECIMAL: {
+        double decimal = value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        AppendBigEndian((bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63));
+        break;
+      }
+      case TypeId::VARCHAR: {
+        // The length of a varchar value counts its terminating '\0'.
+        const char *data = value.GetData();
+        uint32_t length = value.GetLength() - 1;
+        if (is_last) {
+          AppendBytes(data, length);
+          break;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+          AppendByte(data[i]);
+          if (data[i] == 0) {
+            AppendByte(1);
+          }
+        }
+        AppendByte(0);
+        AppendByte(0);
+        break;
+      }
+      default:
+        throw Exception(ExceptionType::MISMATCH_TYPE, "can't index a value of this type");
+    }
+  }
+
+  template <typename T>
+  inline void AppendInteger(T value) {
+    using U = std::make_unsigned_t<T>;
+    AppendBigEndian(static_cast<U>(static_cast<U>(value) ^ (U{1} << (sizeof(U) * 8 - 1))));
+  }
+
+  template <typename U>
+  inline void AppendBigEndian(U value) {
+    for (int shift = static_cast<int>(sizeof(U) * 8) - 8; shift >= 0; shift -= 8) {
+      AppendByte(static_cast<char>(value >> shift));
+    }
+  }
+
+  inline void AppendByte(char byte) { AppendBytes(&byte, 1); }
+
+  inline void AppendBytes(const char *data, size_t size) {
+    if (size_ + size > KeySize) {
+      throw Exception("can't index a key longer than " + std::to_string(KeySize) + " bytes");
+    }
+    memcpy(data_ + size_, data, size);
+    size_ += size;
+  }
+
+  uint16_t size_;
+  char data_[KeySize];
+};
+
+/**
+ * Function object returns true if lhs < rhs, used for trees. VarlenKeys compare by their bytes, whatever the key
+ * schema is.
+ */
+template <size_t KeySize>
+class VarlenComparator {
+ public:
+  inline int operator()(const VarlenKey<KeySize> &lhs, const VarlenKey<KeySize> &rhs) const {
+    return CompareKeyBytes(lhs.GetData(), lhs.GetSize(), rhs.GetData(), rhs.GetSize());
+  }
+
+  // constructor, taking the key schema like GenericComparator
+  explicit VarlenComparator([[maybe_unused]] Schema *key_schema) {}
+};
+
+}  // namespace bustub
@@ -11,14 +11,17 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
+#include "storage/index/varlen_key.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+// An internal page splits once it holds more than max_size children, so one slot is kept for the extra child.
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)) - 1)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -35,6 +38,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
+  static constexpr int DEFAULT_MAX_SIZE = static_cast<int>(INTERNAL_PAGE_SIZE);
+
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
 
@@ -44,6 +49,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   ValueType ValueAt(int index) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  int ChildIndex(const KeyType &key, const KeyComparator &comparator, bool before = false) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   void Remove(int index);
@@ -56,11 +62,107 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
+  // append a child with keys greater than all others, e.g. when bulk loading
+  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+
+  // How full the page is, which decides when the tree splits and merges it. A page splits once it holds more than max
+  // size children, and is underfull below min size.
+  bool IsFull() const;
+  bool IsSafeToInsert() const;
+  bool IsUnderfull() const;
+  bool IsSafeToRemove() const;
+  bool CanMoveAllTo(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const;
+  bool CanSetKeyAt(int index, const KeyType &key) const;
+  bool IsFilled(float fill_factor) const;
 
  private:
   void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   MappingType array_[0];
 };
+
+#define B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE \
+  BPlusTreeInternalPage<VarlenKey<KeySize>, ValueType, VarlenComparator<KeySize>>
+#define VARLEN_INTERNAL_PAGE_HEADER_SIZE 28
+
+/**
+ * Internal page of variable-length keys, which stores each key in only as many bytes as it has. The tree gives it
+ * separator keys that are as short as they can be, see BPlusTreeLeafPage::SeparatorKey().
+ *
+ * Internal page format (offsets are in key order, records in any order):
+ *  -----------------------------------------------------------------------------
+ * | HEADER | OFFSET(0) | OFFSET(1) | ... | OFFSET(n) | FREE SPACE | RECORD(k) | ... |
+ *  -----------------------------------------------------------------------------
+ * An offset (2) is where a record starts, counted from the end of the header. A record is the key size (2), the key
+ * and the page id. The first key is invalid like in other internal pages, and may be empty.
+ *
+ *  Header format (size in byte, 28 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  --------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | HeapBegin (2) | HeapUsed (2) |
+ *  --------------------------------------------------------------
+ * MaxSize is the number of bytes after the header, for offsets and records.
+ */
+template <size_t KeySize, typename ValueType>
+class BPlusTreeInternalPage<VarlenKey<KeySize>, ValueType, VarlenComparator<KeySize>> : public BPlusTreePage {
+  using KeyType = VarlenKey<KeySize>;
+  using KeyComparator = VarlenComparator<KeySize>;
+
+ public:
+  static constexpr int DEFAULT_MAX_SIZE = PAGE_SIZE - VARLEN_INTERNAL_PAGE_HEADER_SIZE;
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = DEFAULT_MAX_SIZE);
+
+  KeyType KeyAt(int index) const;
+  void SetKeyAt(int index, const KeyType &key);
+  int ValueIndex(const ValueType &value) const;
+  ValueType ValueAt(int index) const;
+
+  ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  int ChildIndex(const KeyType &key, const KeyComparator &comparator, bool before = false) const;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  void Remove(int index);
+  ValueType RemoveAndReturnOnlyChild();
+
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+                        BufferPoolManager *buffer_pool_manager);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+                         BufferPoolManager *buffer_pool_manager);
+  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+
+  // How full the page is, in bytes. A page splits once it has less room than the largest child may take, and is
+  // underfull below a quarter of max size.
+  bool IsFull() const;
+  bool IsSafeToInsert() const;
+  bool IsUnderfull() const;
+  bool IsSafeToRemove() const;
+  bool CanMoveAllTo(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const;
+  bool CanSetKeyAt(int index, const KeyType &key) const;
+  bool IsFilled(float fill_factor) const;
+
+ private:
+  // the most bytes that inserting a child takes
+  static constexpr int MAX_ENTRY_SIZE = 2 * sizeof(uint16_t) + KeySize + sizeof(ValueType);
+
+  uint16_t OffsetAt(int index) const;
+  uint16_t KeySizeAt(int index) const;
+  int RecordSizeAt(int index) const;
+  int UsedSpace() const;
+  int FreeSpace() const;
+  // insert a child, given that the page has room for it, without adopting it
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  std::vector<MappingType> GetItems(int begin, int end) const;
+  // lay out the page anew with items, without adopting them
+  void Rebuild(const MappingType *items, int size);
+
+  uint16_t heap_begin_;
+  uint16_t heap_used_;
+  char data_[0];
+};
 }  // namespace bustub
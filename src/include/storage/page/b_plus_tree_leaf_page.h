@@ -13,6 +13,7 @@
 #include <utility>
 #include <vector>
 
+#include "storage/index/varlen_key.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
@@ -42,6 +43,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
+  static constexpr int DEFAULT_MAX_SIZE = static_cast<int>(LEAF_PAGE_SIZE);
+
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
@@ -59,15 +62,128 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int index);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  // append a pair with a key greater than all others, e.g. when bulk loading
+  void CopyLastFrom(const MappingType &item);
+
+  // How full the page is, which decides when the tree splits and merges it. A page splits once it is full, so it
+  // holds max size - 1 pairs at most, and is underfull below min size.
+  bool CanInsert(const KeyType &key) const;
+  bool IsFull() const;
+  bool IsSafeToInsert(const KeyType &key) const;
+  bool IsUnderfull() const;
+  bool IsSafeToRemove() const;
+  bool CanMoveAllTo(const BPlusTreeLeafPage *recipient) const;
+  bool IsFilled(float fill_factor) const;
+  // the key that the parent keeps between a page ending in left and the next one starting with right
+  static KeyType SeparatorKey(const KeyType &left, const KeyType &right);
 
  private:
   void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
   MappingType array_[0];
 };
+
+#define B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE BPlusTreeLeafPage<VarlenKey<KeySize>, ValueType, VarlenComparator<KeySize>>
+#define VARLEN_LEAF_PAGE_HEADER_SIZE 36
+
+/**
+ * Leaf page of variable-length keys, which stores each key in only as many bytes as it has. The prefix that all keys
+ * of the page share is stored once, and each key as the suffix that follows it.
+ *
+ * Leaf page format (offsets are in key order, records in any order):
+ *  ---------------------------------------------------------------------------------------------
+ * | HEADER | OFFSET(1) | OFFSET(2) | ... | OFFSET(n) | FREE SPACE | RECORD(k) | ... | PREFIX |
+ *  ---------------------------------------------------------------------------------------------
+ * An offset (2) is where a record starts, counted from the end of the header. A record is the suffix size (2), the
+ * suffix and the RID. Removing a pair leaves a hole among the records until the page is rebuilt to make room.
+ *
+ *  Header format (size in byte, 36 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  -----------------------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | HeapBegin (2) | HeapUsed (2) | PrefixOffset (2) | PrefixSize (2)
+ *  -----------------------------------------------------------------------------------------------------------
+ * MaxSize is the number of bytes after the header, for offsets and records.
+ *
+ * The prefix is the one that the first and last key share whenever the page is rebuilt, e.g. when it splits, or the
+ * first key of an empty page. A key that does not start with it shortens it, and so lengthens every suffix.
+ */
+template <size_t KeySize, typename ValueType>
+class BPlusTreeLeafPage<VarlenKey<KeySize>, ValueType, VarlenComparator<KeySize>> : public BPlusTreePage {
+  using KeyType = VarlenKey<KeySize>;
+  using KeyComparator = VarlenComparator<KeySize>;
+
+ public:
+  static constexpr int DEFAULT_MAX_SIZE = PAGE_SIZE - VARLEN_LEAF_PAGE_HEADER_SIZE;
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = DEFAULT_MAX_SIZE);
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  KeyType KeyAt(int index) const;
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+  MappingType GetItem(int index) const;
+
+  int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+  bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
+  int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int index);
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  void CopyLastFrom(const MappingType &item);
+
+  // How full the page is, in bytes. A page splits once it has less room than the largest pair may take, and is
+  // underfull below a quarter of max size. A key that shortens the prefix may not fit in a page that is not full.
+  bool CanInsert(const KeyType &key) const;
+  bool IsFull() const;
+  bool IsSafeToInsert(const KeyType &key) const;
+  bool IsUnderfull() const;
+  bool IsSafeToRemove() const;
+  bool CanMoveAllTo(const BPlusTreeLeafPage *recipient) const;
+  bool IsFilled(float fill_factor) const;
+  // the shortest start of right that is greater than left
+  static KeyType SeparatorKey(const KeyType &left, const KeyType &right);
+
+ private:
+  // the most bytes that inserting a pair takes, if its key starts with the prefix
+  static constexpr int MAX_PAIR_SIZE = 2 * sizeof(uint16_t) + KeySize + sizeof(ValueType);
+
+  uint16_t OffsetAt(int index) const;
+  uint16_t SuffixSizeAt(int index) const;
+  int RecordSizeAt(int index) const;
+  int UsedSpace() const;
+  int FreeSpace() const;
+  // compare the key at index with key
+  int CompareAt(int index, const KeyType &key) const;
+  // compare the key at index with key, given that key starts with the prefix
+  int CompareSuffixAt(int index, const KeyType &key) const;
+  // the size of the prefix that the page would have with key in it
+  int CommonPrefixSize(const KeyType &key) const;
+  // how many more bytes the page uses with key in it
+  int InsertSize(const KeyType &key) const;
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  // write a record below the others, given that there is room, and return its offset
+  uint16_t WriteRecord(const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  std::vector<MappingType> GetItems(int begin, int end) const;
+  // lay out the page anew with items, sorted, whose keys all start with prefix_size bytes of prefix
+  void Rebuild(const MappingType *items, int size, const char *prefix, int prefix_size);
+  // lay out the page anew with items, sorted, with the prefix that the first and last one share
+  void Rebuild(const MappingType *items, int size);
+
+  page_id_t next_page_id_;
+  uint16_t heap_begin_;
+  uint16_t heap_used_;
+  uint16_t prefix_offset_;
+  uint16_t prefix_size_;
+  char data_[0];
+};
 }  // namespace bustub
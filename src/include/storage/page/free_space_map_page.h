@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A free space map page records, for a run of table pages, approximately how many bytes each of them has free.
+ * Free space is stored as a one-byte category, see FreeSpaceMap for how bytes map to categories.
+ *
+ * Free space map page format:
+ *  ------------------------------------------------------------------------------------
+ *  | HEADER | TablePageId_1 (4) | ... | TablePageId_n (4) | Category_1 (1) | ... | Category_n (1) |
+ *  ------------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes):
+ *  -------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | EntryCount (4) |
+ *  -------------------------------------------------------------
+ *
+ *  Entries are only ever appended, so their order is the order in which table pages were added to the heap.
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Maximum number of table pages a single free space map page can track. */
+  static constexpr uint32_t CAPACITY = (PAGE_SIZE - 16) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  /**
+   * Initialize an empty free space map page.
+   * @param page_id the page ID of this free space map page
+   */
+  void Init(page_id_t page_id);
+
+  /** @return the page ID of this free space map page */
+  page_id_t GetFreeSpaceMapPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the next free space map page, INVALID_PAGE_ID if this is the last one */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page ID of the next free space map page. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table pages tracked by this page */
+  uint32_t GetEntryCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return true if no more table pages can be tracked by this page */
+  bool IsFull() { return GetEntryCount() == CAPACITY; }
+
+  /** @return the table page ID tracked at slot slot_num */
+  page_id_t GetTablePageId(uint32_t slot_num) {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_TABLE_PAGE_IDS + sizeof(page_id_t) * slot_num);
+  }
+
+  /** @return the free space category of the table page at slot slot_num */
+  uint8_t GetCategory(uint32_t slot_num) {
+    return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_CATEGORIES + slot_num);
+  }
+
+  /** Set the free space category of the table page at slot slot_num. */
+  void SetCategory(uint32_t slot_num, uint8_t category) {
+    memcpy(GetData() + OFFSET_CATEGORIES + slot_num, &category, sizeof(uint8_t));
+  }
+
+  /**
+   * Start tracking a table page.
+   * @param table_page_id the table page to track
+   * @param category the initial free space category of the table page
+   * @return the slot the table page was assigned, or CAPACITY if this page is full
+   */
+  uint32_t Append(page_id_t table_page_id, uint8_t category);
+
+  /**
+   * Find the first table page whose category is at least min_category.
+   * @param min_category the smallest acceptable category
+   * @param[out] slot_num the slot of the table page that was found
+   * @return true if such a table page exists
+   */
+  bool FindCategoryAtLeast(uint8_t min_category, uint32_t *slot_num);
+
+  /** @return the largest category of any table page tracked by this page, 0 if it is empty */
+  uint8_t GetMaxCategory();
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 12;
+  static constexpr size_t OFFSET_TABLE_PAGE_IDS = 16;
+  static constexpr size_t OFFSET_CATEGORIES = OFFSET_TABLE_PAGE_IDS + sizeof(page_id_t) * CAPACITY;
+
+  /** Set the number of table pages tracked by this page. */
+  void SetEntryCount(uint32_t entry_count) {
+    memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t));
+  }
+};
+
+}  // namespace bustub
@@ -45,7 +45,7 @@ class HashTableBucketPage {
    *
    * @return true if at least one key matched
    */
-  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result);
+  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) const;
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -122,22 +122,22 @@ class HashTableBucketPage {
   /**
    * @return the number of readable elements, i.e. current size
    */
-  uint32_t NumReadable();
+  uint32_t NumReadable() const;
 
   /**
    * @return whether the bucket is full
    */
-  bool IsFull();
+  bool IsFull() const;
 
   /**
    * @return whether the bucket is empty
    */
-  bool IsEmpty();
+  bool IsEmpty() const;
 
   /**
    * Prints the bucket's occupancy information
    */
-  void PrintBucket();
+  void PrintBucket() const;
 
   /**
    * @return the length of occupied_ or readable_
@@ -19,16 +19,23 @@ namespace bustub {
 /**
  * Database use the first page (page_id = 0) as header page to store metadata, in
  * our case, we will contain information about table/index name (length less than
- * 32 bytes) and their corresponding root_id
+ * 32 bytes) and their corresponding root_id. It also records the page size the
+ * database file was created with, which must be the PAGE_SIZE of the build that
+ * opens it. The page size sits at the end of the smallest page there is, where a
+ * header page written before it was recorded has zeros, and the records stop short
+ * of it.
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  -------------------------------------------------------------------------------------------------
+ * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... | PageSize (4) at offset 4092 | ... |
+ *  -------------------------------------------------------------------------------------------------
  */
 class HeaderPage : public Page {
  public:
-  void Init() { SetRecordCount(0); }
+  void Init() {
+    SetRecordCount(0);
+    SetPageSize(PAGE_SIZE);
+  }
   /**
    * Record related
    */
@@ -40,12 +47,25 @@ class HeaderPage : public Page {
   bool GetRootId(const std::string &name, page_id_t *root_id);
   int GetRecordCount();
 
+  /**
+   * @return the page size the database file was created with. A header page written before the page size was recorded
+   * is taken to have been written with PAGE_SIZE.
+   */
+  int GetPageSize();
+
  private:
+  static constexpr int RECORDS_OFFSET = 4;
+  static constexpr int RECORD_SIZE = 36;
+  static constexpr int PAGE_SIZE_OFFSET = 4092;
+  static constexpr int MAX_RECORD_COUNT = (PAGE_SIZE_OFFSET - RECORDS_OFFSET) / RECORD_SIZE;
+
   /**
    * helper functions
    */
   int FindRecord(const std::string &name);
 
   void SetRecordCount(int record_count);
+
+  void SetPageSize(int page_size);
 };
 }  // namespace bustub
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -28,10 +31,21 @@ namespace bustub {
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates the page data and zeros it out. */
+  Page() : owned_data_(new char[PAGE_SIZE]), data_(owned_data_.get()) { ResetMemory(); }
+
+  /**
+   * Constructor for a page whose data lives in memory owned by somebody else, e.g. a frame of the buffer pool.
+   * Zeros out the page data.
+   * @param data PAGE_SIZE bytes that outlive this page
+   */
+  explicit Page(char *data) : data_(data) { ResetMemory(); }
+
+  Page(const Page &) = delete;
+  Page &operator=(const Page &) = delete;
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,7 +57,7 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -75,17 +89,32 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /**
+   * Constructor for a view of a page whose data is already in memory, e.g. in a read-only mapping of the database file.
+   * Leaves the page data as it is.
+   * @param data PAGE_SIZE bytes that outlive this page
+   * @param page_id the id of the page
+   */
+  Page(char *data, page_id_t page_id) : data_(data), page_id_(page_id) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** The memory behind data_ if this page allocated it itself, nullptr otherwise. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  char *data_;
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /**
+   * The pin count of this page, or -1 while the buffer pool manager has claimed the frame to (re)assign it. Like the
+   * rest of the book-keeping it is atomic, because pages are pinned and unpinned without the buffer pool latch.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** True while the buffer pool manager is reading this page in or writing it back without holding its latch. */
+  std::atomic<bool> io_in_progress_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
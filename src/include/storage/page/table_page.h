@@ -40,6 +40,8 @@ namespace bustub {
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ *  The first page of a table has no previous page. Its PrevPageId holds the page ID of the table's free space map
+ *  instead (see TableHeap), which is INVALID_PAGE_ID in tables that never had one.
  */
 class TablePage : public Page {
  public:
@@ -72,6 +74,20 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the page ID of the first page of the table's free space map. Only valid in the first page. */
+  page_id_t GetFreeSpaceMapPageId() { return GetPrevPageId(); }
+
+  /** Set the page ID of the first page of the table's free space map. Only valid in the first page. */
+  void SetFreeSpaceMapPageId(page_id_t fsm_page_id) { SetPrevPageId(fsm_page_id); }
+
+  /** @return the number of bytes available for new tuples and their slots */
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return the free space a page needs to hold the given tuple, including its slot */
+  static uint32_t SpaceRequired(const Tuple &tuple) { return tuple.size_ + SIZE_TUPLE; }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -166,10 +182,6 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   /** @return tuple offset at slot slot_num */
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap remembers roughly how much free space every page of a TableHeap has, so that an insert can go
+ * straight to a page with enough room instead of walking the whole page chain.
+ *
+ * The map lives in a chain of FreeSpaceMapPages managed by the buffer pool. Free space is rounded down to a one-byte
+ * category of BYTES_PER_CATEGORY bytes, so a page is never reported to have more room than it really has, but the map
+ * is only a hint: it is not logged, and callers must be prepared for a page to turn out full and report its actual
+ * free space back through UpdatePage().
+ */
+class FreeSpaceMap {
+ public:
+  /** Number of bytes of free space represented by one category. */
+  static constexpr uint32_t BYTES_PER_CATEGORY = PAGE_SIZE / 256;
+
+  /**
+   * Create an empty free space map. Its first page is created by the first call to UpdatePage().
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /**
+   * Read an existing free space map into this (empty) map. Reading stops early at a page that does not look like a
+   * map page, e.g. one that never made it to disk before a crash.
+   * @param first_page_id the first page of the existing map
+   */
+  void Open(page_id_t first_page_id);
+
+  /** @return the id of the first page of this map, INVALID_PAGE_ID if no page has been created yet */
+  page_id_t GetFirstPageId();
+
+  /** @return the table page that was most recently added to the map, INVALID_PAGE_ID if the map is empty */
+  page_id_t GetLastTablePageId();
+
+  /**
+   * Find a table page which is believed to have at least required_space bytes free.
+   * @param required_space the number of bytes needed
+   * @return the id of such a page, or INVALID_PAGE_ID if no tracked page has enough room
+   */
+  page_id_t FindPage(uint32_t required_space);
+
+  /**
+   * Record the current free space of a table page, starting to track it if it is not tracked yet. With a read-only
+   * buffer pool, a table page that is not tracked yet is only tracked in memory, without its free space.
+   * @param table_page_id the table page
+   * @param free_space the number of bytes the table page has free
+   */
+  void UpdatePage(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * Find the table pages that were added to the map after a given one, i.e. the pages that follow it in the heap.
+   * @param table_page_id the table page to start after
+   * @param skip the number of following pages to leave out
+   * @param count the maximum number of pages to return
+   * @param[out] table_page_ids the pages that were found, in order
+   */
+  void GetNextTablePages(page_id_t table_page_id, size_t skip, size_t count, std::vector<page_id_t> *table_page_ids);
+
+  /** @return the free space category that free_space bytes fall into */
+  static uint8_t ToCategory(uint32_t free_space) { return static_cast<uint8_t>(free_space / BYTES_PER_CATEGORY); }
+
+ private:
+  /**
+   * Start tracking a table page, chaining a new map page if the last one is full.
+   * @return false if the buffer pool could not provide a new map page
+   */
+  bool Append(page_id_t table_page_id, uint8_t category);
+
+  BufferPoolManager *buffer_pool_manager_;
+  /** The pages of the map, in chain order. */
+  std::vector<page_id_t> map_page_ids_;
+  /** For every map page, an upper bound on the categories stored in it. Lets FindPage skip pages without fetching. */
+  std::vector<uint8_t> max_categories_;
+  /** Where each tracked table page lives in the map: (index into map_page_ids_, slot in that page). */
+  std::unordered_map<page_id_t, std::pair<size_t, uint32_t>> locations_;
+  /** All tracked table pages in the order they were added. Entry i is in slot i % CAPACITY of map page i / CAPACITY. */
+  std::vector<page_id_t> table_page_ids_;
+  /** The most recently added table page. */
+  page_id_t last_table_page_id_{INVALID_PAGE_ID};
+  /** The map page where FindPage starts looking, i.e. the one that satisfied the last search. */
+  size_t search_hint_{0};
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -22,7 +25,7 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, plus a free space map that tells inserts which page has room.
  */
 class TableHeap {
   friend class TableIterator;
@@ -31,7 +34,8 @@ class TableHeap {
   ~TableHeap() = default;
 
   /**
-   * Create a table heap without a transaction. (open table)
+   * Create a table heap without a transaction. (open table) Through a read-only buffer pool, nothing is written to the
+   * table, not even a rebuilt free space map.
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
@@ -51,7 +55,8 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size), or the buffer pool is read-only, return
+   * false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -63,7 +68,7 @@ class TableHeap {
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
    * @param txn transaction performing the delete
-   * @return true iff the delete is successful (i.e the tuple exists)
+   * @return true iff the delete is successful (i.e the tuple exists), false if the buffer pool is read-only
    */
   bool MarkDelete(const RID &rid, Transaction *txn);  // for delete
 
@@ -72,7 +77,7 @@ class TableHeap {
    * @param tuple new tuple
    * @param rid rid of the old tuple
    * @param txn transaction performing the update
-   * @return true is update is successful.
+   * @return true is update is successful, false if the buffer pool is read-only
    */
   bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
@@ -99,6 +104,15 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read tuples from the table, fetching each page once however the rids are ordered.
+   * @param rids rids of the tuples to read
+   * @param[out] tuples the tuples that exist, appended in the order of rids
+   * @param txn transaction performing the read
+   * @return false if a page could not be fetched
+   */
+  bool GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -108,11 +122,35 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * Set how many pages ahead of a sequential scan are read into the buffer pool in the background.
+   * @param read_ahead_pages the read-ahead window in pages, 0 turns read-ahead off
+   */
+  inline void SetReadAheadPages(size_t read_ahead_pages) { read_ahead_pages_ = read_ahead_pages; }
+
+  /** @return the read-ahead window in pages, capped to a quarter of the buffer pool */
+  size_t GetReadAheadPages();
+
  private:
+  /**
+   * Prefetch the pages that follow a page of a sequential scan.
+   * @param page_id the page the scan just moved to
+   * @param prefetched the number of pages after page_id that have been prefetched already
+   * @return the number of pages after page_id that have been prefetched now
+   */
+  size_t ReadAhead(page_id_t page_id, size_t prefetched);
+
+  /**
+   * Open the free space map recorded in the first page, rebuilding it from the page chain if there is none.
+   */
+  void OpenFreeSpaceMap();
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  FreeSpaceMap free_space_map_;
+  size_t read_ahead_pages_{DEFAULT_READ_AHEAD_PAGES};
 };
 
 }  // namespace bustub
@@ -32,7 +32,11 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        pages_scanned_(other.pages_scanned_),
+        pages_prefetched_(other.pages_prefetched_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +56,22 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    pages_scanned_ = other.pages_scanned_;
+    pages_prefetched_ = other.pages_prefetched_;
     return *this;
   }
 
  private:
+  /** Called whenever the iterator moves on to the next page, starts read-ahead once the scan looks sequential. */
+  void OnNextPage(page_id_t page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Number of page boundaries this iterator has crossed. */
+  size_t pages_scanned_{0};
+  /** Number of pages after the current one that have been prefetched. */
+  size_t pages_prefetched_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,33 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_engine.cpp
+//
+// Identification: src/storage/disk/async_io_engine.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io_engine.h"
+
+#include "common/logger.h"
+#include "storage/disk/io_uring_engine.h"
+#include "storage/disk/thread_pool_io_engine.h"
+
+namespace bustub {
+
+/** Number of worker threads of the fallback engine. Each one has a single request in flight. */
+static constexpr size_t THREAD_POOL_IO_THREADS = 4;
+
+std::unique_ptr<AsyncIoEngine> AsyncIoEngine::Create(size_t queue_depth) {
+  auto io_uring_engine = IoUringEngine::Create(queue_depth);
+  if (io_uring_engine != nullptr) {
+    return io_uring_engine;
+  }
+  LOG_DEBUG("io_uring is not available, falling back to a thread pool for asynchronous I/O");
+  return std::make_unique<ThreadPoolIoEngine>(THREAD_POOL_IO_THREADS);
+}
+
+}  // namespace bustub
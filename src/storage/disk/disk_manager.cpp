@@ -10,34 +10,113 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <limits.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<linux/falloc.h>)
+#define BUSTUB_HAS_PUNCH_HOLE
+#include <linux/falloc.h>
+#endif
+
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/checksum_util.h"
+#include "common/util/compression_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Maximum number of asynchronous page reads and writes in flight at once. */
+static constexpr size_t IO_QUEUE_DEPTH = 64;
+
+/** Compressed pages are stored in whole sectors. */
+static constexpr size_t SECTOR_SIZE = 512;
+static constexpr size_t SECTORS_PER_PAGE = PAGE_SIZE / SECTOR_SIZE;
+
+static size_t SectorsOf(size_t length) { return (length + SECTOR_SIZE - 1) / SECTOR_SIZE; }
+
+/**
+ * Aligned buffer used to bounce pages that are not PAGE_SIZE aligned through when doing direct I/O, and to hold
+ * compressed pages
+ */
+static char *DirectIoBuffer() {
+  alignas(PAGE_SIZE) static thread_local char buffer[PAGE_SIZE];
+  return buffer;
+}
+
+/** pread() length bytes, retrying short reads. @return false on an I/O error or if the file ends first */
+static bool PreadFully(int fd, char *data, size_t length, size_t offset) {
+  size_t read_count = 0;
+  while (read_count < length) {
+    ssize_t rc = pread(fd, data + read_count, length - read_count, static_cast<off_t>(offset + read_count));
+    if (rc == -1 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      return false;
+    }
+    read_count += rc;
+  }
+  return true;
+}
+
+/** pwrite() length bytes, retrying short writes. @return false on an I/O error */
+static bool PwriteFully(int fd, const char *data, size_t length, size_t offset) {
+  size_t write_count = 0;
+  while (write_count < length) {
+    ssize_t rc = pwrite(fd, data + write_count, length - write_count, static_cast<off_t>(offset + write_count));
+    if (rc == -1 && errno == EINTR) {
+      continue;
+    }
+    if (rc == -1) {
+      return false;
+    }
+    write_count += rc;
+  }
+  return true;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input backend: how pages of the database file are read and written
+ * @input checksums: whether pages are checksummed
+ * @input compression: whether a new db file stores its pages compressed
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, Backend backend, bool checksums, bool compression)
+    : file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      backend_(backend) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  alloc_name_ = file_name_.substr(0, n) + ".alloc";
+  checksum_name_ = file_name_.substr(0, n) + ".crc";
+  page_map_name_ = file_name_.substr(0, n) + ".map";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -53,6 +132,20 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
+  OpenPageMap(compression);
+  if (compressed_ && backend_ != Backend::PREAD) {
+    // Compressed pages are neither page nor (necessarily) device block aligned, and the stream has no pread().
+    LOG_WARN("%s is compressed, using buffered pread()/pwrite() for it", file_name_.c_str());
+    backend_ = Backend::PREAD;
+  }
+  if (backend_ != Backend::FSTREAM) {
+    OpenDbFile();
+    OpenAllocationMap();
+    OpenChecksums(checksums);
+    buffer_used = nullptr;
+    return;
+  }
+
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -67,66 +160,957 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open db file");
     }
   }
+  OpenAllocationMap();
+  OpenChecksums(checksums);
   buffer_used = nullptr;
 }
 
+/**
+ * Destructor: close the db file if ShutDown() was not called
+ */
+DiskManager::~DiskManager() {
+  // Let outstanding asynchronous I/O finish before the file goes away.
+  io_engine_.reset();
+  if (db_fd_ != -1) {
+    close(db_fd_);
+  }
+  if (alloc_fd_ != -1) {
+    close(alloc_fd_);
+  }
+  if (checksum_fd_ != -1) {
+    close(checksum_fd_);
+  }
+  if (page_map_fd_ != -1) {
+    close(page_map_fd_);
+  }
+}
+
+/**
+ * Open/create the db file as a file descriptor, and remember its size
+ */
+void DiskManager::OpenDbFile() {
+  if (backend_ == Backend::PREAD_DIRECT) {
+    db_fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (db_fd_ == -1 && errno == EINVAL) {
+      LOG_WARN("%s does not support O_DIRECT, falling back to buffered I/O", file_name_.c_str());
+      backend_ = Backend::PREAD;
+    }
+  }
+  if (backend_ == Backend::PREAD) {
+    db_fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ == -1) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    db_file_size_ = static_cast<size_t>(stat_buf.st_size);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  io_engine_.reset();
   {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
+    if (db_fd_ != -1) {
+      close(db_fd_);
+      db_fd_ = -1;
+    }
+  }
+  {
+    std::scoped_lock scoped_alloc_latch(alloc_latch_);
+    if (alloc_fd_ != -1) {
+      close(alloc_fd_);
+      alloc_fd_ = -1;
+    }
+  }
+  {
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    if (checksum_fd_ != -1) {
+      close(checksum_fd_);
+      checksum_fd_ = -1;
+    }
+  }
+  {
+    std::scoped_lock scoped_page_map_latch(page_map_latch_);
+    if (page_map_fd_ != -1) {
+      close(page_map_fd_);
+      page_map_fd_ = -1;
+    }
   }
   log_io_.close();
 }
 
+/**
+ * Open the allocation map file, and rebuild the free page ids from it
+ */
+void DiskManager::OpenAllocationMap() {
+  alloc_fd_ = open(alloc_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (alloc_fd_ == -1) {
+    throw Exception("can't open allocation map file");
+  }
+  struct stat stat_buf;
+  size_t db_file_size = stat(file_name_.c_str(), &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  size_t map_size = fstat(alloc_fd_, &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  if (db_file_size == 0) {
+    // A new or emptied database file, any map lying around belongs to a file that is gone.
+    if (map_size != 0 && ftruncate(alloc_fd_, 0) != 0) {
+      LOG_DEBUG("I/O error while truncating the allocation map");
+    }
+  } else if (map_size == 0) {
+    // A database file from before allocation maps, all of its pages are in use as far as we know.
+    size_t num_pages = (db_file_size + PAGE_SIZE - 1) / PAGE_SIZE;
+    allocation_map_.assign((num_pages + 7) / 8, 0);
+    for (size_t page = 0; page < num_pages; page++) {
+      allocation_map_[page / 8] |= 1 << (page % 8);
+    }
+    if (pwrite(alloc_fd_, allocation_map_.data(), allocation_map_.size(), 0) !=
+        static_cast<ssize_t>(allocation_map_.size())) {
+      LOG_DEBUG("I/O error while writing the allocation map");
+    }
+  } else {
+    allocation_map_.resize(map_size);
+    if (pread(alloc_fd_, allocation_map_.data(), map_size, 0) != static_cast<ssize_t>(map_size)) {
+      LOG_DEBUG("I/O error while reading the allocation map");
+    }
+  }
+
+  for (size_t page = 0; page < allocation_map_.size() * 8; page++) {
+    if ((allocation_map_[page / 8] & (1 << (page % 8))) != 0) {
+      num_allocated_pages_++;
+      next_page_id_ = static_cast<page_id_t>(page) + 1;
+    }
+  }
+  for (page_id_t page_id = 0; page_id < next_page_id_; page_id++) {
+    if ((allocation_map_[page_id / 8] & (1 << (page_id % 8))) == 0) {
+      free_page_ids_.insert(page_id);
+    }
+  }
+}
+
+/**
+ * Hand out the lowest eligible free page id, growing the file if there is none
+ */
+page_id_t DiskManager::AllocatePage(const std::function<bool(page_id_t)> &is_eligible) {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  for (auto it = free_page_ids_.begin(); it != free_page_ids_.end(); ++it) {
+    if (!is_eligible || is_eligible(*it)) {
+      auto page_id = *it;
+      free_page_ids_.erase(it);
+      SetAllocated(page_id, true);
+      return page_id;
+    }
+  }
+  // Page ids we pass over here stay free for whoever can take them.
+  while (true) {
+    auto page_id = next_page_id_++;
+    if (!is_eligible || is_eligible(page_id)) {
+      SetAllocated(page_id, true);
+      return page_id;
+    }
+    free_page_ids_.insert(page_id);
+  }
+}
+
+/**
+ * Give a page id back to the allocator
+ */
+bool DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || free_page_ids_.count(page_id) != 0) {
+    return false;
+  }
+  SetAllocated(page_id, false);
+  free_page_ids_.insert(page_id);
+  if (compressed_) {
+    // The page reads as zeros from now on, which its checksum would not match.
+    ReleaseCompressedPage(page_id);
+    RecordChecksums(page_id, {0});
+  }
+  return true;
+}
+
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  return page_id >= 0 && page_id < next_page_id_ && free_page_ids_.count(page_id) == 0;
+}
+
+size_t DiskManager::GetNumAllocatedPages() {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  return num_allocated_pages_;
+}
+
+/**
+ * Update the bit of a page in the allocation map, and write the byte holding it through to the map file
+ */
+void DiskManager::SetAllocated(page_id_t page_id, bool allocated) {
+  size_t index = page_id / 8;
+  if (index >= allocation_map_.size()) {
+    allocation_map_.resize(index + 1, 0);
+  }
+  if (allocated) {
+    allocation_map_[index] |= 1 << (page_id % 8);
+    num_allocated_pages_++;
+  } else {
+    allocation_map_[index] &= ~(1 << (page_id % 8));
+    num_allocated_pages_--;
+  }
+  if (alloc_fd_ != -1 && pwrite(alloc_fd_, &allocation_map_[index], 1, index) != 1) {
+    LOG_DEBUG("I/O error while writing the allocation map");
+  }
+}
+
+/**
+ * Open the checksum file and load the checksums. Without checksums, an existing checksum file is kept open as well,
+ * so that the pages written meanwhile lose their checksums instead of failing them once checksums are back.
+ */
+void DiskManager::OpenChecksums(bool checksums) {
+  checksum_fd_ = open(checksum_name_.c_str(), checksums ? O_RDWR | O_CREAT : O_RDWR, 0644);
+  if (checksum_fd_ == -1) {
+    if (checksums || errno != ENOENT) {
+      throw Exception("can't open checksum file");
+    }
+    return;
+  }
+  checksums_enabled_ = checksums;
+  struct stat stat_buf;
+  size_t db_file_size = stat(file_name_.c_str(), &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  size_t checksum_file_size = fstat(checksum_fd_, &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  if (db_file_size == 0) {
+    // Like the allocation map, checksums lying around belong to a database file that is gone.
+    if (checksum_file_size != 0 && ftruncate(checksum_fd_, 0) != 0) {
+      LOG_DEBUG("I/O error while truncating the checksum file");
+    }
+    return;
+  }
+  // Pages of a database file that had no checksums so far get theirs when they are next written.
+  checksums_.resize(checksum_file_size / sizeof(PageChecksums));
+  auto size = checksums_.size() * sizeof(PageChecksums);
+  if (pread(checksum_fd_, checksums_.data(), size, 0) != static_cast<ssize_t>(size)) {
+    LOG_DEBUG("I/O error while reading the checksum file");
+  }
+}
+
+uint32_t DiskManager::ChecksumOf(const char *page_data) {
+  auto checksum = ChecksumUtil::Crc32c(page_data, PAGE_SIZE);
+  return checksum == 0 ? ~checksum : checksum;
+}
+
+/**
+ * Store the checksums of consecutive pages before they are written, and write them through to the checksum file
+ */
+void DiskManager::RecordChecksums(page_id_t first_page_id, const std::vector<uint32_t> &checksums) {
+  std::scoped_lock scoped_checksum_latch(checksum_latch_);
+  if (checksum_fd_ == -1) {
+    return;
+  }
+  size_t end = first_page_id + checksums.size();
+  if (end > checksums_.size()) {
+    checksums_.resize(end, {0, 0});
+  }
+  for (size_t i = 0; i < checksums.size(); i++) {
+    auto &page_checksums = checksums_[first_page_id + i];
+    // After a write that failed, the page on disk may still be what it was before that write.
+    page_checksums.new_ = checksums[i];
+    if (checksums[i] == 0) {
+      page_checksums.old_ = 0;
+    }
+  }
+  WriteChecksums(first_page_id, checksums.size());
+}
+
+/**
+ * Make the checksums of pages that have been written the only ones they match
+ */
+void DiskManager::CommitChecksums(page_id_t first_page_id, size_t num_pages) {
+  std::scoped_lock scoped_checksum_latch(checksum_latch_);
+  if (checksum_fd_ == -1) {
+    return;
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    auto &page_checksums = checksums_[first_page_id + i];
+    page_checksums.old_ = page_checksums.new_;
+  }
+  WriteChecksums(first_page_id, num_pages);
+}
+
+void DiskManager::WriteChecksums(page_id_t first_page_id, size_t num_pages) {
+  auto size = num_pages * sizeof(PageChecksums);
+  auto offset = static_cast<off_t>(first_page_id * sizeof(PageChecksums));
+  if (pwrite(checksum_fd_, &checksums_[first_page_id], size, offset) != static_cast<ssize_t>(size)) {
+    LOG_DEBUG("I/O error while writing the checksum file");
+  }
+}
+
+/**
+ * Compare a page that has been read against its checksums, if it has any
+ */
+bool DiskManager::VerifyChecksum(page_id_t page_id, const char *page_data) {
+  PageChecksums page_checksums;
+  {
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    if (!checksums_enabled_ || checksum_fd_ == -1 || static_cast<size_t>(page_id) >= checksums_.size()) {
+      return true;
+    }
+    page_checksums = checksums_[page_id];
+  }
+  if (page_checksums.old_ == 0) {
+    return true;
+  }
+  auto checksum = ChecksumOf(page_data);
+  if (checksum == page_checksums.new_ || checksum == page_checksums.old_) {
+    return true;
+  }
+  num_checksum_failures_++;
+  LOG_WARN("page %d of %s does not match its checksum", page_id, file_name_.c_str());
+  return false;
+}
+
+/**
+ * Truncate the db file after the last allocated page, and punch holes where deallocated pages are
+ */
+size_t DiskManager::Compact() {
+  std::scoped_lock scoped_alloc_latch(alloc_latch_);
+  // Free page ids at the end are no longer needed, the file (and the map) can end at the last allocated page.
+  while (!free_page_ids_.empty() && *free_page_ids_.rbegin() == next_page_id_ - 1) {
+    free_page_ids_.erase(std::prev(free_page_ids_.end()));
+    next_page_id_--;
+  }
+  allocation_map_.resize((next_page_id_ + 7) / 8);
+  if (ftruncate(alloc_fd_, static_cast<off_t>(allocation_map_.size())) != 0) {
+    LOG_DEBUG("I/O error while truncating the allocation map");
+  }
+  {
+    // The holes read as zeros, and the pages past the end are gone: neither has a checksum any more.
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    if (checksum_fd_ != -1) {
+      checksums_.resize(std::min(checksums_.size(), static_cast<size_t>(next_page_id_)));
+      for (auto page_id : free_page_ids_) {
+        if (static_cast<size_t>(page_id) < checksums_.size()) {
+          checksums_[page_id] = {0, 0};
+        }
+      }
+      auto size = checksums_.size() * sizeof(PageChecksums);
+      if (ftruncate(checksum_fd_, static_cast<off_t>(size)) != 0 ||
+          pwrite(checksum_fd_, checksums_.data(), size, 0) != static_cast<ssize_t>(size)) {
+        LOG_DEBUG("I/O error while writing the checksum file");
+      }
+    }
+  }
+
+  // Go through a file descriptor of our own, so that this works for every backend.
+  if (backend_ == Backend::FSTREAM) {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    db_io_.flush();
+  }
+  int fd = open(file_name_.c_str(), O_RDWR);
+  if (fd == -1) {
+    LOG_DEBUG("can't open db file for compaction");
+    return 0;
+  }
+  struct stat stat_buf;
+  size_t old_size = fstat(fd, &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  if (compressed_) {
+    auto released = CompactCompressed(fd, old_size);
+    close(fd);
+    return released;
+  }
+  size_t new_size = std::min(old_size, static_cast<size_t>(next_page_id_) * PAGE_SIZE);
+  size_t released = 0;
+  if (new_size < old_size && ftruncate(fd, static_cast<off_t>(new_size)) == 0) {
+    released += old_size - new_size;
+    db_file_size_ = new_size;
+  }
+#ifdef BUSTUB_HAS_PUNCH_HOLE
+  for (auto page_id : free_page_ids_) {
+    size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+    if (offset < new_size && fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset),
+                                       PAGE_SIZE) == 0) {
+      released += PAGE_SIZE;
+    }
+  }
+#endif
+  close(fd);
+  return released;
+}
+
+/**
+ * Open the page map of a compressed db file. A new db file is compressed if asked to be, an existing one if it has a
+ * page map.
+ */
+void DiskManager::OpenPageMap(bool compression) {
+  struct stat stat_buf;
+  bool is_new = stat(file_name_.c_str(), &stat_buf) != 0 || stat_buf.st_size == 0;
+  bool has_page_map = stat(page_map_name_.c_str(), &stat_buf) == 0;
+  compressed_ = is_new ? compression : has_page_map;
+  if (!compressed_) {
+    if (has_page_map && unlink(page_map_name_.c_str()) != 0) {
+      LOG_WARN("can't remove the page map %s", page_map_name_.c_str());
+    }
+    if (compression) {
+      LOG_WARN("%s was created without compression, its pages are stored as they are", file_name_.c_str());
+    }
+    return;
+  }
+
+  page_map_fd_ = open(page_map_name_.c_str(), O_RDWR | O_CREAT | (is_new ? O_TRUNC : 0), 0644);
+  if (page_map_fd_ == -1) {
+    throw Exception("can't open page map file");
+  }
+  size_t map_size = fstat(page_map_fd_, &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  page_locations_.resize(map_size / sizeof(PageLocation));
+  auto size = page_locations_.size() * sizeof(PageLocation);
+  if (!PreadFully(page_map_fd_, reinterpret_cast<char *>(page_locations_.data()), size, 0)) {
+    LOG_DEBUG("I/O error while reading the page map");
+  }
+  std::scoped_lock scoped_page_map_latch(page_map_latch_);
+  FindFreeSectors();
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> DiskManager::FindFreeSectors() {
+  std::vector<std::pair<uint32_t, uint32_t>> extents;
+  for (const auto &location : page_locations_) {
+    if (location.length_ != 0) {
+      extents.emplace_back(location.first_sector_, location.first_sector_ + SectorsOf(location.length_));
+    }
+  }
+  std::sort(extents.begin(), extents.end());
+  free_sectors_.assign(SECTORS_PER_PAGE + 1, {});
+  next_sector_ = 0;
+  std::vector<std::pair<uint32_t, uint32_t>> gaps;
+  for (const auto &[first, end] : extents) {
+    if (first > next_sector_) {
+      gaps.emplace_back(next_sector_, first - next_sector_);
+      FreeSectors(next_sector_, first - next_sector_);
+    }
+    next_sector_ = std::max(next_sector_, end);
+  }
+  return gaps;
+}
+
+uint32_t DiskManager::AllocateSectors(size_t num_sectors) {
+  // Take the smallest free run that is long enough, and keep what is left of it.
+  for (size_t length = num_sectors; length <= SECTORS_PER_PAGE; length++) {
+    if (!free_sectors_[length].empty()) {
+      auto first_sector = free_sectors_[length].back();
+      free_sectors_[length].pop_back();
+      if (length > num_sectors) {
+        free_sectors_[length - num_sectors].push_back(first_sector + num_sectors);
+      }
+      return first_sector;
+    }
+  }
+  auto first_sector = next_sector_;
+  next_sector_ += num_sectors;
+  return first_sector;
+}
+
+void DiskManager::FreeSectors(uint32_t first_sector, size_t count) {
+  // Runs longer than a page are no use in one piece. Neighbouring runs are not merged.
+  while (count > 0) {
+    auto length = std::min(count, SECTORS_PER_PAGE);
+    free_sectors_[length].push_back(first_sector);
+    first_sector += length;
+    count -= length;
+  }
+}
+
+void DiskManager::SetPageLocation(page_id_t page_id, uint32_t first_sector, uint32_t length) {
+  if (static_cast<size_t>(page_id) >= page_locations_.size()) {
+    page_locations_.resize(page_id + 1, PageLocation{0, 0});
+  }
+  auto &location = page_locations_[page_id];
+  location = {first_sector, length};
+  if (!PwriteFully(page_map_fd_, reinterpret_cast<const char *>(&location), sizeof(location),
+                   page_id * sizeof(PageLocation))) {
+    LOG_DEBUG("I/O error while writing the page map");
+  }
+}
+
+/**
+ * Write a page compressed, or as it is if compressing does not save a sector
+ */
+bool DiskManager::WriteCompressedPage(page_id_t page_id, const char *page_data) {
+  char *buffer = DirectIoBuffer();
+  size_t length = CompressionUtil::Compress(page_data, PAGE_SIZE, buffer, PAGE_SIZE - SECTOR_SIZE);
+  if (length == 0) {
+    memcpy(buffer, page_data, PAGE_SIZE);
+    length = PAGE_SIZE;
+  }
+  size_t num_sectors = SectorsOf(length);
+  memset(buffer + length, 0, num_sectors * SECTOR_SIZE - length);
+
+  // The page is rewritten in place if it still takes up as many sectors, otherwise it moves, and its old sectors are
+  // only freed once the page map points away from them.
+  PageLocation old_location{0, 0};
+  uint32_t first_sector;
+  {
+    std::scoped_lock scoped_page_map_latch(page_map_latch_);
+    if (static_cast<size_t>(page_id) < page_locations_.size()) {
+      old_location = page_locations_[page_id];
+    }
+    bool in_place = old_location.length_ != 0 && SectorsOf(old_location.length_) == num_sectors;
+    first_sector = in_place ? old_location.first_sector_ : AllocateSectors(num_sectors);
+  }
+  bool success = PwriteFully(db_fd_, buffer, num_sectors * SECTOR_SIZE, first_sector * SECTOR_SIZE);
+  std::scoped_lock scoped_page_map_latch(page_map_latch_);
+  if (!success) {
+    LOG_DEBUG("I/O error while writing");
+    if (first_sector != old_location.first_sector_ || old_location.length_ == 0) {
+      FreeSectors(first_sector, num_sectors);
+    }
+    return false;
+  }
+  SetPageLocation(page_id, first_sector, length);
+  if (old_location.length_ != 0 && old_location.first_sector_ != first_sector) {
+    FreeSectors(old_location.first_sector_, SectorsOf(old_location.length_));
+  }
+  return true;
+}
+
+/**
+ * Read a compressed page and decompress it. A page that has never been written reads as zeros.
+ */
+bool DiskManager::ReadCompressedPage(page_id_t page_id, char *page_data) {
+  PageLocation location{0, 0};
+  {
+    std::scoped_lock scoped_page_map_latch(page_map_latch_);
+    if (page_id >= 0 && static_cast<size_t>(page_id) < page_locations_.size()) {
+      location = page_locations_[page_id];
+    }
+  }
+  if (location.length_ == 0) {
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  char *buffer = DirectIoBuffer();
+  size_t size = SectorsOf(location.length_) * SECTOR_SIZE;
+  if (!PreadFully(db_fd_, buffer, size, location.first_sector_ * SECTOR_SIZE)) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  num_bytes_read_ += size;
+  num_reads_ += 1;
+  if (location.length_ == PAGE_SIZE) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+    return true;
+  }
+  if (!CompressionUtil::Decompress(buffer, location.length_, page_data, PAGE_SIZE)) {
+    LOG_WARN("page %d of %s cannot be decompressed", page_id, file_name_.c_str());
+    return false;
+  }
+  return true;
+}
+
+void DiskManager::ReleaseCompressedPage(page_id_t page_id) {
+  std::scoped_lock scoped_page_map_latch(page_map_latch_);
+  if (static_cast<size_t>(page_id) >= page_locations_.size() || page_locations_[page_id].length_ == 0) {
+    return;
+  }
+  auto location = page_locations_[page_id];
+  SetPageLocation(page_id, 0, 0);
+  FreeSectors(location.first_sector_, SectorsOf(location.length_));
+}
+
+/**
+ * Truncate a compressed db file after the last sector in use, and punch holes where sectors are free
+ */
+size_t DiskManager::CompactCompressed(int fd, size_t old_size) {
+  std::scoped_lock scoped_page_map_latch(page_map_latch_);
+  // Page ids past the last allocated one are gone.
+  if (page_locations_.size() > static_cast<size_t>(next_page_id_)) {
+    page_locations_.resize(next_page_id_);
+    if (ftruncate(page_map_fd_, static_cast<off_t>(page_locations_.size() * sizeof(PageLocation))) != 0) {
+      LOG_DEBUG("I/O error while truncating the page map");
+    }
+  }
+  auto gaps = FindFreeSectors();
+  size_t new_size = std::min(old_size, static_cast<size_t>(next_sector_) * SECTOR_SIZE);
+  size_t released = 0;
+  if (new_size < old_size && ftruncate(fd, static_cast<off_t>(new_size)) == 0) {
+    released += old_size - new_size;
+  }
+#ifdef BUSTUB_HAS_PUNCH_HOLE
+  // Only whole blocks of the file system can be given back.
+  struct stat stat_buf;
+  size_t block_size = fstat(fd, &stat_buf) == 0 && stat_buf.st_blksize > 0 ? stat_buf.st_blksize : PAGE_SIZE;
+  for (const auto &[first_sector, count] : gaps) {
+    size_t begin = (first_sector * SECTOR_SIZE + block_size - 1) / block_size * block_size;
+    size_t end = (first_sector + count) * SECTOR_SIZE / block_size * block_size;
+    if (begin < end && fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(begin),
+                                 static_cast<off_t>(end - begin)) == 0) {
+      released += end - begin;
+    }
+  }
+#endif
+  return released;
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+bool DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  if (checksum_fd_ != -1) {
+    RecordChecksums(page_id, {UsesChecksums() ? ChecksumOf(page_data) : 0});
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  bool success;
+  if (compressed_) {
+    success = WriteCompressedPage(page_id, page_data);
+  } else if (backend_ != Backend::FSTREAM) {
+    success = WritePageFd(offset, page_data);
+  } else {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    // set write cursor to offset
+    db_io_.seekp(offset);
+    db_io_.write(page_data, PAGE_SIZE);
+    // check for I/O error
+    success = !db_io_.bad();
+    if (!success) {
+      LOG_DEBUG("I/O error while writing");
+    } else {
+      // needs to flush to keep disk file in sync
+      db_io_.flush();
+    }
+  }
+  // A page whose write failed may still be what it was, and keeps matching the checksum of that.
+  if (success && UsesChecksums()) {
+    CommitChecksums(page_id, 1);
+  }
+  return success;
 }
 
 /**
- * Read the contents of the specified page into the given memory area
+ * Write consecutive pages into the disk file, without flushing after every one of them
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+bool DiskManager::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  size_t offset = static_cast<size_t>(first_page_id) * PAGE_SIZE;
+  num_writes_ += static_cast<int>(pages.size());
+  if (checksum_fd_ != -1) {
+    std::vector<uint32_t> checksums(pages.size(), 0);
+    if (UsesChecksums()) {
+      std::transform(pages.begin(), pages.end(), checksums.begin(), ChecksumOf);
+    }
+    RecordChecksums(first_page_id, checksums);
+  }
+  // Checksums are only committed for the pages that made it to disk.
+  auto record_checksums = [this, first_page_id](size_t begin, size_t end) {
+    if (begin < end && UsesChecksums()) {
+      CommitChecksums(first_page_id + static_cast<page_id_t>(begin), end - begin);
+    }
+  };
+  if (compressed_) {
+    // Compressed pages are not laid out one after the other.
+    bool success = true;
+    for (size_t i = 0; i < pages.size(); i++) {
+      if (WriteCompressedPage(first_page_id + static_cast<page_id_t>(i), pages[i])) {
+        record_checksums(i, i + 1);
+      } else {
+        success = false;
+      }
+    }
+    return success;
+  }
+  if (backend_ == Backend::FSTREAM) {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    db_io_.seekp(offset);
+    for (auto page_data : pages) {
+      db_io_.write(page_data, PAGE_SIZE);
+    }
+    if (db_io_.bad()) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    record_checksums(0, pages.size());
+    return true;
+  }
+  if (std::any_of(pages.begin(), pages.end(), [this](const char *page_data) { return NeedsBounce(page_data); })) {
+    bool success = true;
+    for (size_t i = 0; i < pages.size(); i++) {
+      if (WritePageFd(offset + i * PAGE_SIZE, pages[i])) {
+        record_checksums(i, i + 1);
+      } else {
+        success = false;
+      }
+    }
+    return success;
+  }
+
+  std::vector<iovec> iovecs(pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    iovecs[i].iov_base = const_cast<char *>(pages[i]);
+    iovecs[i].iov_len = PAGE_SIZE;
+  }
+  size_t end = offset + pages.size() * PAGE_SIZE;
+  size_t next_iovec = 0;
+  while (next_iovec < iovecs.size()) {
+    auto count = static_cast<int>(std::min<size_t>(iovecs.size() - next_iovec, IOV_MAX));
+    ssize_t rc = pwritev(db_fd_, &iovecs[next_iovec], count, static_cast<off_t>(offset));
+    if (rc == -1 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc == -1) {
+      LOG_DEBUG("I/O error while writing");
+      record_checksums(0, (offset - static_cast<size_t>(first_page_id) * PAGE_SIZE) / PAGE_SIZE);
+      return false;
+    }
+    // Skip what has been written, which may end in the middle of a page.
+    offset += rc;
+    while (rc > 0) {
+      auto &iov = iovecs[next_iovec];
+      auto written = std::min(static_cast<size_t>(rc), iov.iov_len);
+      iov.iov_base = static_cast<char *>(iov.iov_base) + written;
+      iov.iov_len -= written;
+      rc -= static_cast<ssize_t>(written);
+      if (iov.iov_len == 0) {
+        next_iovec++;
+      }
+    }
+  }
+  GrowFileSize(end);
+  record_checksums(0, pages.size());
+  return true;
+}
+
+/**
+ * Sync the db file, so that what has been written survives a crash
+ */
+void DiskManager::SyncDbFile() {
+  if (backend_ == Backend::FSTREAM) {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    db_io_.flush();
+  } else if (fsync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  {
+    std::scoped_lock scoped_alloc_latch(alloc_latch_);
+    if (alloc_fd_ != -1 && fsync(alloc_fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing the allocation map");
+    }
+  }
+  {
+    std::scoped_lock scoped_checksum_latch(checksum_latch_);
+    if (checksum_fd_ != -1 && fsync(checksum_fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing the checksum file");
+    }
+  }
+  std::scoped_lock scoped_page_map_latch(page_map_latch_);
+  if (page_map_fd_ != -1 && fsync(page_map_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing the page map");
+  }
+}
+
+/**
+ * Read the contents of the specified page into the given memory area, and check them against the page's checksum
+ */
+bool DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  if (compressed_) {
+    return ReadCompressedPage(page_id, page_data) && VerifyChecksum(page_id, page_data);
+  }
+  if (backend_ != Backend::FSTREAM) {
+    size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+    // check if read beyond file length
+    if (offset >= db_file_size_) {
+      LOG_DEBUG("I/O error reading past end of file");
+      memset(page_data, 0, PAGE_SIZE);
+      return true;
+    }
+    return ReadPageFd(offset, page_data) && VerifyChecksum(page_id, page_data);
+  }
+
+  std::unique_lock db_io_lock(db_io_latch_);
   int offset = page_id * PAGE_SIZE;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
     // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  // set read cursor to offset
+  db_io_.seekp(offset);
+  db_io_.read(page_data, PAGE_SIZE);
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  // if file ends before reading PAGE_SIZE
+  int read_count = db_io_.gcount();
+  num_bytes_read_ += read_count;
+  num_reads_ += 1;
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    db_io_.clear();
+    // std::cerr << "Read less than a page" << std::endl;
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  db_io_lock.unlock();
+  return VerifyChecksum(page_id, page_data);
+}
+
+/**
+ * Read a page with pread(), zero-filling whatever lies beyond the end of the file
+ */
+bool DiskManager::ReadPageFd(size_t offset, char *page_data) {
+  bool bounce = NeedsBounce(page_data);
+  char *buffer = bounce ? DirectIoBuffer() : page_data;
+  size_t read_count = 0;
+  bool success = true;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, buffer + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc == -1 && errno == EINTR) {
+      continue;
+    }
+    if (rc == -1) {
       LOG_DEBUG("I/O error while reading");
+      success = false;
+      break;
+    }
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  num_bytes_read_ += read_count;
+  num_reads_ += 1;
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (bounce) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+  return success;
+}
+
+/**
+ * Write a page with pwrite(), growing the cached file size if the page lies beyond it
+ */
+bool DiskManager::WritePageFd(size_t offset, const char *page_data) {
+  const char *buffer = page_data;
+  if (NeedsBounce(page_data)) {
+    char *bounce_buffer = DirectIoBuffer();
+    memcpy(bounce_buffer, page_data, PAGE_SIZE);
+    buffer = bounce_buffer;
+  }
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t rc = pwrite(db_fd_, buffer + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc == -1 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc == -1) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    write_count += rc;
+  }
+  GrowFileSize(offset + PAGE_SIZE);
+  return true;
+}
+
+/**
+ * Direct I/O needs PAGE_SIZE aligned buffers
+ */
+bool DiskManager::NeedsBounce(const char *page_data) const {
+  return backend_ == Backend::PREAD_DIRECT && reinterpret_cast<uintptr_t>(page_data) % PAGE_SIZE != 0;
+}
+
+void DiskManager::GrowFileSize(size_t file_size) {
+  size_t old_file_size = db_file_size_;
+  while (old_file_size < file_size && !db_file_size_.compare_exchange_weak(old_file_size, file_size)) {
+  }
+}
+
+AsyncIoEngine *DiskManager::GetIoEngine() {
+  std::call_once(io_engine_created_, [this] { io_engine_ = AsyncIoEngine::Create(IO_QUEUE_DEPTH); });
+  return io_engine_.get();
+}
+
+/**
+ * Submit a page read to the I/O engine. Reads it cannot do (stream backend, past the end of the file, buffers that
+ * would need bouncing) are done synchronously before returning.
+ */
+void DiskManager::SubmitReadPage(page_id_t page_id, char *page_data, std::function<void(bool)> callback) {
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  if (backend_ == Backend::FSTREAM || compressed_ || offset >= db_file_size_ || NeedsBounce(page_data)) {
+    callback(ReadPage(page_id, page_data));
+    return;
+  }
+  auto on_complete = [this, page_id, page_data, callback = std::move(callback)](ssize_t result) {
+    if (result < 0) {
+      LOG_DEBUG("I/O error while reading");
+      callback(false);
       return;
     }
+    num_bytes_read_ += result;
+    num_reads_ += 1;
     // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    if (result < PAGE_SIZE) {
+      memset(page_data + result, 0, PAGE_SIZE - result);
     }
+    callback(VerifyChecksum(page_id, page_data));
+  };
+  GetIoEngine()->Submit({IoRequest::Type::READ, db_fd_, offset, page_data, PAGE_SIZE, std::move(on_complete)});
+}
+
+std::future<bool> DiskManager::SubmitReadPage(page_id_t page_id, char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  SubmitReadPage(page_id, page_data, [promise](bool success) { promise->set_value(success); });
+  return future;
+}
+
+/**
+ * Submit a page write to the I/O engine. Writes it cannot do (stream backend, buffers that would need bouncing) are
+ * done synchronously before returning.
+ */
+void DiskManager::SubmitWritePage(page_id_t page_id, const char *page_data, std::function<void(bool)> callback) {
+  if (backend_ == Backend::FSTREAM || compressed_ || NeedsBounce(page_data)) {
+    callback(WritePage(page_id, page_data));
+    return;
+  }
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  num_writes_ += 1;
+  // The checksum is recorded as the page is submitted, but only committed once the write has completed.
+  if (checksum_fd_ != -1) {
+    RecordChecksums(page_id, {UsesChecksums() ? ChecksumOf(page_data) : 0});
   }
+  auto on_complete = [this, page_id, offset, page_data, callback = std::move(callback)](ssize_t result) {
+    if (result < 0) {
+      LOG_DEBUG("I/O error while writing");
+      callback(false);
+      return;
+    }
+    // Short writes are rare enough to just write the whole page again.
+    if (result < PAGE_SIZE && !WritePageFd(offset, page_data)) {
+      callback(false);
+      return;
+    }
+    GrowFileSize(offset + PAGE_SIZE);
+    if (UsesChecksums()) {
+      CommitChecksums(page_id, 1);
+    }
+    callback(true);
+  };
+  // The engine only ever reads from the buffer of a write request.
+  GetIoEngine()->Submit(
+      {IoRequest::Type::WRITE, db_fd_, offset, const_cast<char *>(page_data), PAGE_SIZE, std::move(on_complete)});
+}
+
+std::future<bool> DiskManager::SubmitWritePage(page_id_t page_id, const char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  SubmitWritePage(page_id, page_data, [promise](bool success) { promise->set_value(success); });
+  return future;
 }
 
 /**
@@ -201,6 +1185,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of page reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -0,0 +1,337 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_engine.cpp
+//
+// Identification: src/storage/disk/io_uring_engine.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring_engine.h"
+
+#if __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAS_IO_URING
+
+/** user_data of the no-op that tells the reaper thread that nothing more will be submitted. */
+static constexpr uint64_t SHUTDOWN_USER_DATA = UINT64_MAX;
+
+/** How long the reaper thread waits for a completion before it checks whether the ring has failed. */
+static constexpr int64_t REAP_TIMEOUT_NS = 100'000'000;
+
+static_assert(sizeof(std::atomic<unsigned>) == sizeof(unsigned) && std::atomic<unsigned>::is_always_lock_free,
+              "the ring indexes shared with the kernel are accessed as std::atomic<unsigned>");
+
+std::unique_ptr<IoUringEngine> IoUringEngine::Create(size_t queue_depth) {
+  std::unique_ptr<IoUringEngine> engine(new IoUringEngine());
+  if (!engine->Setup(queue_depth)) {
+    return nullptr;
+  }
+  engine->submitter_ = std::thread(&IoUringEngine::SubmitLoop, engine.get());
+  engine->reaper_ = std::thread(&IoUringEngine::ReapLoop, engine.get());
+  return engine;
+}
+
+bool IoUringEngine::Setup(size_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+  if (ring_fd_ < 0) {
+    return false;
+  }
+  num_entries_ = params.sq_entries;
+  ext_arg_ = (params.features & IORING_FEAT_EXT_ARG) != 0;
+
+  // Map the submission ring, the completion ring (which may share the same mapping) and the submission entries.
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    return false;
+  }
+
+  auto sq_ring = static_cast<char *>(sq_ring_);
+  auto cq_ring = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<std::atomic<unsigned> *>(sq_ring + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+  cq_head_ = reinterpret_cast<std::atomic<unsigned> *>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<std::atomic<unsigned> *>(cq_ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = cq_ring + params.cq_off.cqes;
+
+  // The completion ring is twice as large as the submission ring, so with at most num_entries_ requests (plus the
+  // shutdown no-op) in flight it can never overflow.
+  in_flight_.resize(num_entries_);
+  for (unsigned slot = num_entries_; slot > 0; slot--) {
+    free_slots_.push_back(slot - 1);
+  }
+  return true;
+}
+
+IoUringEngine::~IoUringEngine() {
+  {
+    std::scoped_lock latch(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  if (submitter_.joinable()) {
+    submitter_.join();
+  }
+  if (reaper_.joinable()) {
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IoUringEngine::Submit(IoRequest request) {
+  {
+    std::scoped_lock latch(latch_);
+    pending_.push_back(std::move(request));
+  }
+  cv_.notify_all();
+}
+
+void IoUringEngine::SubmitLoop() {
+  auto sqes = static_cast<io_uring_sqe *>(sqes_);
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] {
+      return (!pending_.empty() && (!free_slots_.empty() || error_ != 0)) || (shutdown_ && pending_.empty());
+    });
+    if (pending_.empty()) {
+      break;
+    }
+    if (error_ != 0) {
+      // The ring is gone, fail whatever comes in from now on.
+      std::deque<IoRequest> failed;
+      failed.swap(pending_);
+      int error = error_;
+      lock.unlock();
+      for (auto &request : failed) {
+        request.callback_(-error);
+      }
+      lock.lock();
+      continue;
+    }
+
+    // Everything that piled up while we were busy goes to the kernel in one batch. Only this thread writes the
+    // submission ring, and the kernel has consumed all of it by the time io_uring_enter() returns.
+    unsigned tail = sq_tail_->load(std::memory_order_relaxed);
+    unsigned to_submit = 0;
+    while (!pending_.empty() && !free_slots_.empty()) {
+      unsigned slot = free_slots_.back();
+      free_slots_.pop_back();
+      in_flight_[slot] = std::move(pending_.front());
+      pending_.pop_front();
+      const auto &request = in_flight_[slot];
+
+      unsigned index = tail & sq_mask_;
+      auto sqe = &sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = request.type_ == IoRequest::Type::READ ? IORING_OP_READ : IORING_OP_WRITE;
+      sqe->fd = request.fd_;
+      sqe->off = request.offset_;
+      sqe->addr = reinterpret_cast<uint64_t>(request.data_);
+      sqe->len = static_cast<uint32_t>(request.size_);
+      sqe->user_data = slot;
+      sq_array_[index] = index;
+      tail++;
+      to_submit++;
+    }
+    sq_tail_->store(tail, std::memory_order_release);
+
+    lock.unlock();
+    if (!Enter(to_submit, 0, 0)) {
+      FailAll(errno);
+    }
+    lock.lock();
+  }
+  if (error_ != 0) {
+    // The reaper has given up already.
+    return;
+  }
+  lock.unlock();
+
+  // Wake the reaper up one last time so that it notices the shutdown.
+  unsigned tail = sq_tail_->load(std::memory_order_relaxed);
+  unsigned index = tail & sq_mask_;
+  auto sqe = &sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_NOP;
+  sqe->user_data = SHUTDOWN_USER_DATA;
+  sq_array_[index] = index;
+  sq_tail_->store(tail + 1, std::memory_order_release);
+  if (!Enter(1, 0, 0)) {
+    FailAll(errno);
+  }
+}
+
+void IoUringEngine::ReapLoop() {
+  auto cqes = static_cast<io_uring_cqe *>(cqes_);
+  bool shutting_down = false;
+  std::vector<std::pair<IoRequest, ssize_t>> completed;
+  while (true) {
+    {
+      std::scoped_lock latch(latch_);
+      if ((shutting_down && free_slots_.size() == num_entries_) || error_ != 0) {
+        return;
+      }
+    }
+    if (!Enter(0, 1, IORING_ENTER_GETEVENTS)) {
+      // Without completions, nothing in flight would ever finish.
+      FailAll(errno);
+      return;
+    }
+
+    unsigned head = cq_head_->load(std::memory_order_relaxed);
+    unsigned tail = cq_tail_->load(std::memory_order_acquire);
+    {
+      std::scoped_lock latch(latch_);
+      for (; head != tail; head++) {
+        const auto &cqe = cqes[head & cq_mask_];
+        if (cqe.user_data == SHUTDOWN_USER_DATA) {
+          shutting_down = true;
+          continue;
+        }
+        auto slot = static_cast<unsigned>(cqe.user_data);
+        if (!in_flight_[slot].callback_) {
+          // Failed by FailAll() already.
+          continue;
+        }
+        completed.emplace_back(std::move(in_flight_[slot]), cqe.res);
+        in_flight_[slot].callback_ = nullptr;
+        free_slots_.push_back(slot);
+      }
+    }
+    cq_head_->store(head, std::memory_order_release);
+    cv_.notify_all();
+
+    for (auto &[request, result] : completed) {
+      request.callback_(result);
+    }
+    completed.clear();
+  }
+}
+
+void IoUringEngine::FailAll(int error) {
+  std::vector<IoRequest> failed;
+  {
+    std::scoped_lock latch(latch_);
+    if (error_ == 0) {
+      error_ = error != 0 ? error : EIO;
+    }
+    error = error_;
+    for (unsigned slot = 0; slot < num_entries_; slot++) {
+      if (in_flight_[slot].callback_) {
+        failed.push_back(std::move(in_flight_[slot]));
+        in_flight_[slot].callback_ = nullptr;
+        free_slots_.push_back(slot);
+      }
+    }
+    std::move(pending_.begin(), pending_.end(), std::back_inserter(failed));
+    pending_.clear();
+  }
+  cv_.notify_all();
+  for (auto &request : failed) {
+    request.callback_(-error);
+  }
+}
+
+bool IoUringEngine::Enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+  // Waits for completions time out where the kernel allows it, so that the reaper notices when the submitter gives up.
+  io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  __kernel_timespec timeout{0, REAP_TIMEOUT_NS};
+  bool timed = (flags & IORING_ENTER_GETEVENTS) != 0 && ext_arg_;
+  if (timed) {
+    arg.ts = reinterpret_cast<uint64_t>(&timeout);
+    flags |= IORING_ENTER_EXT_ARG;
+  }
+  while (true) {
+    auto rc = syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, timed ? &arg : nullptr,
+                      timed ? sizeof(arg) : 0);
+    if (rc >= 0 && static_cast<unsigned>(rc) < to_submit) {
+      // The kernel took only part of the batch, hand it the rest.
+      to_submit -= static_cast<unsigned>(rc);
+      continue;
+    }
+    if (rc < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+      continue;
+    }
+    if (rc < 0 && timed && errno == ETIME) {
+      return true;
+    }
+    if (rc < 0) {
+      int error = errno;
+      LOG_ERROR("io_uring_enter failed: %s", strerror(error));
+      errno = error;
+      return false;
+    }
+    return true;
+  }
+}
+
+#else
+
+std::unique_ptr<IoUringEngine> IoUringEngine::Create([[maybe_unused]] size_t queue_depth) { return nullptr; }
+
+IoUringEngine::~IoUringEngine() = default;
+
+void IoUringEngine::Submit([[maybe_unused]] IoRequest request) {}
+
+#endif
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool_io_engine.cpp
+//
+// Identification: src/storage/disk/thread_pool_io_engine.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/thread_pool_io_engine.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+namespace bustub {
+
+ThreadPoolIoEngine::ThreadPoolIoEngine(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPoolIoEngine::Work, this);
+  }
+}
+
+ThreadPoolIoEngine::~ThreadPoolIoEngine() {
+  {
+    std::scoped_lock latch(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIoEngine::Submit(IoRequest request) {
+  {
+    std::scoped_lock latch(latch_);
+    pending_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPoolIoEngine::Work() {
+  while (true) {
+    IoRequest request;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      // Keep going after shutdown until everything that was submitted is done.
+      cv_.wait(lock, [this] { return shutdown_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        return;
+      }
+      request = std::move(pending_.front());
+      pending_.pop_front();
+    }
+
+    ssize_t done = 0;
+    while (static_cast<size_t>(done) < request.size_) {
+      ssize_t rc = request.type_ == IoRequest::Type::READ
+                       ? pread(request.fd_, request.data_ + done, request.size_ - done, request.offset_ + done)
+                       : pwrite(request.fd_, request.data_ + done, request.size_ - done, request.offset_ + done);
+      if (rc == -1 && errno == EINTR) {
+        continue;
+      }
+      if (rc == -1) {
+        done = -errno;
+        break;
+      }
+      if (rc == 0) {
+        break;
+      }
+      done += rc;
+    }
+    request.callback_(done);
+  }
+}
+
+}  // namespace bustub
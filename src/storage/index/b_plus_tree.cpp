@@ -9,7 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -19,19 +21,20 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, page_id_t header_page_id)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      header_page_id_(header_page_id) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +45,19 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  Page *page = FindLeafPageRead(key, Target::KEY);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  if (found) {
+    result->push_back(value);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
 }
 
 /*****************************************************************************
@@ -56,7 +71,37 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  // Most inserts do not split the leaf, and need nothing but its write latch.
+  Page *page = FindLeafPageOptimistic(key);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType old_value;
+    bool exists = leaf->Lookup(key, &old_value, comparator_);
+    bool is_safe = !exists && IsSafe(leaf, Operation::INSERT, key);
+    if (is_safe) {
+      leaf->Insert(key, value, comparator_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_safe);
+    if (exists || is_safe) {
+      return !exists;
+    }
+  }
+
+  WriteSet write_set;
+  root_latch_.WLock();
+  write_set.root_latched_ = true;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    ReleaseWriteSet(&write_set, false);
+    return true;
+  }
+  FindLeafPagePessimistic(key, Operation::INSERT, &write_set);
+  bool inserted = InsertIntoLeaf(key, value, &write_set);
+  ReleaseWriteSet(&write_set, inserted);
+  return inserted;
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,7 +109,19 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate a root page");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -75,8 +132,31 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, WriteSet *write_set) {
+  auto *leaf = reinterpret_cast<LeafPage *>(write_set->pages_.back()->GetData());
+  ValueType old_value;
+  if (leaf->Lookup(key, &old_value, comparator_)) {
+    return false;
+  }
+  LeafPage *new_leaf = nullptr;
+  if (leaf->CanInsert(key)) {
+    leaf->Insert(key, value, comparator_);
+    if (leaf->IsFull()) {
+      new_leaf = Split(leaf);
+    }
+  } else {
+    // Only a leaf of variable-length keys runs out of room before it is full, when a key beyond either end of it
+    // shortens the prefix that its keys share. A new leaf on that end takes the key, or all the others.
+    bool is_last = comparator_(key, leaf->KeyAt(0)) > 0;
+    new_leaf = Split(leaf, is_last ? leaf->GetSize() : 0);
+    (is_last ? new_leaf : leaf)->Insert(key, value, comparator_);
+  }
+  if (new_leaf != nullptr) {
+    KeyType separator_key = LeafPage::SeparatorKey(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0));
+    InsertIntoParent(leaf, separator_key, new_leaf, write_set);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  return true;
 }
 
 /*
@@ -88,8 +168,28 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+N *BPLUSTREE_TYPE::Split(N *node, int index) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate a page to split into");
+  }
+  // The new page needs no latch: only latched pages lead to it until the split is done.
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    if (index < 0) {
+      node->MoveHalfTo(new_node);
+    } else {
+      node->MoveTailTo(new_node, index);
+    }
+    new_node->SetNextPageId(node->GetNextPageId());
+    node->SetNextPageId(page_id);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    node->MoveHalfTo(new_node, buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -103,7 +203,34 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      WriteSet *write_set) {
+  if (old_node->IsRootPage()) {
+    assert(write_set->root_latched_);
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate a root page");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(page_id);
+    new_node->SetParentPageId(page_id);
+    root_page_id_ = page_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return;
+  }
+
+  // old_node was not safe, so its parent is still latched.
+  auto *parent = reinterpret_cast<InternalPage *>(PageOf(old_node->GetParentPageId(), write_set)->GetData());
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  if (parent->IsFull()) {
+    InternalPage *new_parent = Split(parent);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, write_set);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,7 +243,41 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  // Most removes do not merge the leaf, and need nothing but its write latch.
+  Page *page = FindLeafPageOptimistic(key);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool exists = leaf->Lookup(key, &value, comparator_);
+  bool is_safe = exists && IsSafe(leaf, Operation::REMOVE, key);
+  if (is_safe) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_safe);
+  if (!exists || is_safe) {
+    return;
+  }
+
+  WriteSet write_set;
+  root_latch_.WLock();
+  write_set.root_latched_ = true;
+  if (IsEmpty()) {
+    ReleaseWriteSet(&write_set, false);
+    return;
+  }
+  page = FindLeafPagePessimistic(key, Operation::REMOVE, &write_set);
+  leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int size = leaf->GetSize();
+  bool removed = leaf->RemoveAndDeleteRecord(key, comparator_) < size;
+  if (removed) {
+    CoalesceOrRedistribute(leaf, &write_set);
+  }
+  ReleaseWriteSet(&write_set, removed);
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -127,8 +288,59 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, WriteSet *write_set) {
+  if (node->IsRootPage()) {
+    return AdjustRoot(node, write_set);
+  }
+  if (!node->IsUnderfull()) {
+    return false;
+  }
+
+  // node is not safe, so its parent is still latched and none of its siblings can be deleted under us.
+  auto *parent = reinterpret_cast<InternalPage *>(PageOf(node->GetParentPageId(), write_set)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  page_id_t neighbor_page_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  Page *neighbor_page = buffer_pool_manager_->FetchPage(neighbor_page_id);
+  if (neighbor_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a sibling page");
+  }
+  if (index == 0) {
+    neighbor_page->WLatch();
+  } else {
+    // Latch the left sibling first, as iterators do: an iterator may be waiting for node while holding its sibling.
+    // Optimistic writers may change node in the meantime, but never split or merge it.
+    Page *page = PageOf(node->GetPageId(), write_set);
+    page->WUnlatch();
+    neighbor_page->WLatch();
+    page->WLatch();
+    if (!node->IsUnderfull()) {
+      neighbor_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(neighbor_page_id, false);
+      return false;
+    }
+  }
+
+  auto *neighbor_node = reinterpret_cast<N *>(neighbor_page->GetData());
+  // Always move the right node into the left one, so that a leaf is only ever deleted by latching its left sibling.
+  N *left_node = index == 0 ? node : neighbor_node;
+  N *right_node = index == 0 ? neighbor_node : node;
+  int right_index = index == 0 ? 1 : index;
+  bool can_merge;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    can_merge = right_node->CanMoveAllTo(left_node);
+  } else {
+    can_merge = right_node->CanMoveAllTo(left_node, parent->KeyAt(right_index));
+  }
+  bool node_deleted = false;
+  if (can_merge) {
+    Coalesce(left_node, right_node, parent, right_index, write_set);
+    node_deleted = index != 0;
+  } else if (CanRedistribute(neighbor_node, node, parent, index)) {
+    Redistribute(neighbor_node, node, parent, index);
+  }
+  neighbor_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(neighbor_page_id, true);
+  return node_deleted;
 }
 
 /*
@@ -137,18 +349,24 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * @param   neighbor_node      left sibling of "node", which receives its pairs
+ * @param   node               right sibling of "neighbor_node", which is deleted
  * @param   parent             parent page of input "node"
+ * @param   index              index of "node" in "parent"
  * @return  true means parent node should be deleted, false means no deletion
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node, InternalPage *parent, int index, WriteSet *write_set) {
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    node->MoveAllTo(neighbor_node);
+  } else {
+    node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
+  }
+  write_set->deleted_page_ids_.push_back(node->GetPageId());
+  parent->Remove(index);
+  return CoalesceOrRedistribute(parent, write_set);
 }
 
 /*
@@ -159,10 +377,52 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of input "node"
+ * @param   index              index of "node" in "parent"
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+      parent->SetKeyAt(1, LeafPage::SeparatorKey(node->KeyAt(node->GetSize() - 1), neighbor_node->KeyAt(0)));
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+      parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    }
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+      parent->SetKeyAt(index,
+                       LeafPage::SeparatorKey(neighbor_node->KeyAt(neighbor_node->GetSize() - 1), node->KeyAt(0)));
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+      parent->SetKeyAt(index, node->KeyAt(0));
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::CanRedistribute(N *neighbor_node, N *node, InternalPage *parent, int index) const {
+  // Nodes of fixed-size keys always can, if they can not merge. The node is underfull, so it has room for a child.
+  if (!neighbor_node->IsSafeToRemove()) {
+    return false;
+  }
+  int last = neighbor_node->GetSize() - 1;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    if (index == 0) {
+      return node->IsSafeToInsert(neighbor_node->KeyAt(0)) &&
+             parent->CanSetKeyAt(1, LeafPage::SeparatorKey(neighbor_node->KeyAt(0), neighbor_node->KeyAt(1)));
+    }
+    KeyType separator_key = LeafPage::SeparatorKey(neighbor_node->KeyAt(last - 1), neighbor_node->KeyAt(last));
+    return node->IsSafeToInsert(neighbor_node->KeyAt(last)) && parent->CanSetKeyAt(index, separator_key);
+  } else {
+    return node->IsSafeToInsert() && (index == 0 ? parent->CanSetKeyAt(1, neighbor_node->KeyAt(1))
+                                                 : parent->CanSetKeyAt(index, neighbor_node->KeyAt(last)));
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +434,307 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, WriteSet *write_set) {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+  } else {
+    if (old_root_node->GetSize() > 1) {
+      return false;
+    }
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the new root page");
+    }
+    reinterpret_cast<BPlusTreePage *>(child_page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(child_page_id, true);
+    root_page_id_ = child_page_id;
+  }
+  assert(write_set->root_latched_);
+  UpdateRootPageId();
+  write_set->deleted_page_ids_.push_back(old_root_node->GetPageId());
+  return true;
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next_pair, float fill_factor) {
+  MappingType pair;
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    while (next_pair(&pair)) {
+      Insert(pair.first, pair.second);
+    }
+    return;
+  }
+
+  try {
+    BulkLoadTree(next_pair, fill_factor);
+  } catch (...) {
+    // Nobody else can reach the pages built so far, so every pin on them is ours.
+    for (auto page_id : bulk_load_page_ids_) {
+      while (buffer_pool_manager_->UnpinPage(page_id, false)) {
+      }
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    bulk_load_page_ids_.clear();
+    root_page_id_ = INVALID_PAGE_ID;
+    root_latch_.WUnlock();
+    throw;
+  }
+  bulk_load_page_ids_.clear();
+  root_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadTree(const std::function<bool(MappingType *)> &next_pair, float fill_factor) {
+  MappingType pair;
+  fill_factor = std::clamp(fill_factor, 0.5F, 1.0F);
+
+  // The node being filled at each level, leaves first. A full node is appended to its parent when the next one starts.
+  std::vector<BulkLoadNode> levels(1);
+  LeafPage *leaf = nullptr;
+  while (next_pair(&pair)) {
+    if (leaf != nullptr && comparator_(pair.first, leaf->KeyAt(leaf->GetSize() - 1)) <= 0) {
+      continue;
+    }
+    if (leaf == nullptr || leaf->IsFilled(fill_factor) || !leaf->IsSafeToInsert(pair.first)) {
+      page_id_t page_id;
+      Page *page = BulkLoadNewPage(&page_id);
+      auto *new_leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      new_leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+      levels[0].page_ = page;
+      if (leaf != nullptr) {
+        leaf->SetNextPageId(page_id);
+        KeyType low_key = levels[0].low_key_;
+        levels[0].low_key_ = LeafPage::SeparatorKey(leaf->KeyAt(leaf->GetSize() - 1), pair.first);
+        BulkLoadAppend(&levels, 1, low_key, leaf->GetPageId(), fill_factor);
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+      } else {
+        levels[0].low_key_ = pair.first;
+      }
+      leaf = new_leaf;
+    }
+    leaf->CopyLastFrom(pair);
+  }
+  if (leaf == nullptr) {
+    return;
+  }
+
+  // The nodes still being filled make up the right edge of the tree. Append them to their parents, bottom-up; the node
+  // left at the top is the root.
+  for (size_t level = 0; level + 1 < levels.size(); level++) {
+    BulkLoadFinish(&levels, level, fill_factor);
+  }
+  Page *root_page = levels.back().page_;
+  auto *root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+  while (!root->IsLeafPage() && root->GetSize() == 1) {
+    // The last node below the root was merged into its left sibling, which became the only child.
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(root)->RemoveAndReturnOnlyChild();
+    buffer_pool_manager_->UnpinPage(root->GetPageId(), false);
+    BulkLoadDeletePage(root->GetPageId());
+    root_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (root_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the root page");
+    }
+    root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+  }
+  root->SetParentPageId(INVALID_PAGE_ID);
+  root_page_id_ = root->GetPageId();
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(root->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::BulkLoadNewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate a page to bulk load");
+  }
+  bulk_load_page_ids_.push_back(*page_id);
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadDeletePage(page_id_t page_id) {
+  buffer_pool_manager_->DeletePage(page_id);
+  bulk_load_page_ids_.erase(std::find(bulk_load_page_ids_.begin(), bulk_load_page_ids_.end(), page_id));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppend(std::vector<BulkLoadNode> *levels, size_t level, const KeyType &key,
+                                    page_id_t page_id, float fill_factor) {
+  if (levels->size() == level) {
+    levels->emplace_back();
+  }
+  Page *page = (*levels)[level].page_;
+  auto *node = page == nullptr ? nullptr : reinterpret_cast<InternalPage *>(page->GetData());
+  if (node == nullptr || node->IsFilled(fill_factor) || !node->IsSafeToInsert()) {
+    // Unpin the full node before allocating the next one, so that a cascade up the levels pins one page per level.
+    if (node != nullptr) {
+      KeyType low_key = (*levels)[level].low_key_;
+      BulkLoadAppend(levels, level + 1, low_key, node->GetPageId(), fill_factor);
+      buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+    }
+    (*levels)[level].page_ = nullptr;
+    page_id_t new_page_id;
+    Page *new_page = BulkLoadNewPage(&new_page_id);
+    node = reinterpret_cast<InternalPage *>(new_page->GetData());
+    node->Init(new_page_id, INVALID_PAGE_ID, internal_max_size_);
+    (*levels)[level].page_ = new_page;
+    (*levels)[level].low_key_ = key;
+  }
+  // Adopts the child, which the caller still has pinned.
+  node->CopyLastFrom({key, page_id}, buffer_pool_manager_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadFinish(std::vector<BulkLoadNode> *levels, size_t level, float fill_factor) {
+  Page *page = (*levels)[level].page_;
+  KeyType low_key = (*levels)[level].low_key_;
+  (*levels)[level].page_ = nullptr;
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  bool is_underfull = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsUnderfull()
+                                         : reinterpret_cast<InternalPage *>(node)->IsUnderfull();
+  if (is_underfull) {
+    // The left sibling is the last child of the node being filled a level up, and is full: take pairs from it, or
+    // merge into it if both fit in one node.
+    auto *parent = reinterpret_cast<InternalPage *>((*levels)[level + 1].page_->GetData());
+    page_id_t neighbor_page_id = parent->ValueAt(parent->GetSize() - 1);
+    Page *neighbor_page = buffer_pool_manager_->FetchPage(neighbor_page_id);
+    if (neighbor_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a sibling page");
+    }
+    bool merge;
+    if (node->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<LeafPage *>(node);
+      auto *neighbor_leaf = reinterpret_cast<LeafPage *>(neighbor_page->GetData());
+      merge = leaf->CanMoveAllTo(neighbor_leaf);
+      if (merge) {
+        leaf->MoveAllTo(neighbor_leaf);
+      } else {
+        while (leaf->IsUnderfull() && neighbor_leaf->IsSafeToRemove() &&
+               leaf->IsSafeToInsert(neighbor_leaf->KeyAt(neighbor_leaf->GetSize() - 1))) {
+          neighbor_leaf->MoveLastToFrontOf(leaf);
+        }
+        low_key = LeafPage::SeparatorKey(neighbor_leaf->KeyAt(neighbor_leaf->GetSize() - 1), leaf->KeyAt(0));
+      }
+    } else {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      auto *neighbor_internal = reinterpret_cast<InternalPage *>(neighbor_page->GetData());
+      merge = internal->CanMoveAllTo(neighbor_internal, low_key);
+      if (merge) {
+        internal->MoveAllTo(neighbor_internal, low_key, buffer_pool_manager_);
+      } else {
+        while (internal->IsUnderfull() && neighbor_internal->IsSafeToRemove() && internal->IsSafeToInsert()) {
+          neighbor_internal->MoveLastToFrontOf(internal, low_key, buffer_pool_manager_);
+          low_key = internal->KeyAt(0);
+        }
+      }
+    }
+    buffer_pool_manager_->UnpinPage(neighbor_page_id, true);
+    if (merge) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      BulkLoadDeletePage(page->GetPageId());
+      return;
+    }
+  }
+  BulkLoadAppend(levels, level + 1, low_key, page->GetPageId(), fill_factor);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * RANGE SCAN
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ScanBatch(ScanCursor *cursor, bool forward, size_t max_pairs, std::vector<MappingType> *batch) {
+  size_t batch_size = batch->size();
+  if (forward) {
+    Page *page = cursor->key_.has_value() ? FindLeafPageRead(*cursor->key_, Target::KEY)
+                                          : FindLeafPageRead(KeyType(), Target::LEFT_MOST);
+    if (page == nullptr) {
+      cursor->done_ = true;
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = 0;
+    if (cursor->key_.has_value()) {
+      index = leaf->KeyIndex(*cursor->key_, comparator_);
+      if (cursor->exclusive_ && index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *cursor->key_) == 0) {
+        index++;
+      }
+    }
+    while (true) {
+      for (; index < leaf->GetSize(); index++) {
+        batch->push_back(leaf->GetItem(index));
+      }
+      page_id_t next_page_id = leaf->GetNextPageId();
+      if (next_page_id == INVALID_PAGE_ID) {
+        cursor->done_ = true;
+        break;
+      }
+      Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+      if (next_page != nullptr) {
+        next_page->RLatch();
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      if (next_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the next leaf page");
+      }
+      page = next_page;
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      index = 0;
+      // The next batch starts at this leaf, found again from the root: the link may be stale by then.
+      if (batch->size() - batch_size >= max_pairs && leaf->GetSize() > 0) {
+        cursor->key_ = leaf->KeyAt(0);
+        cursor->exclusive_ = false;
+        break;
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return;
+  }
+
+  while (!cursor->done_ && batch->size() - batch_size < max_pairs) {
+    std::optional<KeyType> low_fence;
+    Page *page;
+    if (cursor->key_.has_value()) {
+      page = FindLeafPageRead(*cursor->key_, cursor->exclusive_ ? Target::BEFORE_KEY : Target::KEY, &low_fence);
+    } else {
+      page = FindLeafPageRead(KeyType(), Target::RIGHT_MOST, &low_fence);
+    }
+    if (page == nullptr) {
+      cursor->done_ = true;
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->GetSize();
+    if (cursor->key_.has_value()) {
+      index = leaf->KeyIndex(*cursor->key_, comparator_);
+      if (!cursor->exclusive_ && index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *cursor->key_) == 0) {
+        index++;
+      }
+    }
+    for (index--; index >= 0; index--) {
+      batch->push_back(leaf->GetItem(index));
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    // Everything left to scan is below the smallest key the leaf may hold. The leaf may have held none of the keys
+    // before the cursor, if its smallest key went away; the one before it does then.
+    cursor->key_ = low_fence;
+    cursor->exclusive_ = true;
+    cursor->done_ = !low_fence.has_value();
+  }
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +745,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  Page *page = FindLeafPageRead(KeyType(), Target::LEFT_MOST);
+  if (page == nullptr) {
+    return End();
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +759,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  Page *page = FindLeafPageRead(key, Target::KEY);
+  if (page == nullptr) {
+    return End();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -209,15 +782,180 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * @return : the leaf page, pinned but not latched, or nullptr if the tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  Page *page = FindLeafPageRead(key, leftMost ? Target::LEFT_MOST : Target::KEY);
+  if (page != nullptr) {
+    page->RUnlatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, Target target, std::optional<KeyType> *low_fence) {
+  if (low_fence != nullptr) {
+    low_fence->reset();
+  }
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the root page");
+  }
+  page->RLatch();
+  root_latch_.RUnlock();
+
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    int index = 0;
+    switch (target) {
+      case Target::KEY:
+        index = internal->ChildIndex(key, comparator_);
+        break;
+      case Target::BEFORE_KEY:
+        index = internal->ChildIndex(key, comparator_, true);
+        break;
+      case Target::LEFT_MOST:
+        break;
+      case Target::RIGHT_MOST:
+        index = internal->GetSize() - 1;
+        break;
+    }
+    // Every key under a child is at least its key, and the one found lowest down is the tightest bound.
+    if (low_fence != nullptr && index > 0) {
+      *low_fence = internal->KeyAt(index);
+    }
+    page_id_t child_page_id = internal->ValueAt(index);
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page != nullptr) {
+      child_page->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a child page");
+    }
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the root page");
+  }
+  // The type of a page can be read before latching it: holding the latch above it keeps it from being deleted.
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!node->IsLeafPage()) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page != nullptr) {
+      if (reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage()) {
+        child_page->WLatch();
+      } else {
+        child_page->RLatch();
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a child page");
+    }
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPagePessimistic(const KeyType &key, Operation operation, WriteSet *write_set) {
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      ReleaseWriteSet(write_set, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a page of the tree");
+    }
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, operation, key)) {
+      ReleaseWriteSet(write_set, false);
+    }
+    write_set->pages_.push_back(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation operation, const KeyType &key) const {
+  if (operation == Operation::INSERT) {
+    return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsSafeToInsert(key)
+                              : reinterpret_cast<InternalPage *>(node)->IsSafeToInsert();
+  }
+  if (node->IsRootPage()) {
+    // The tree shrinks when the root leaf becomes empty, or when the root is left with one child.
+    return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+  }
+  return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsSafeToRemove()
+                            : reinterpret_cast<InternalPage *>(node)->IsSafeToRemove();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::PageOf(page_id_t page_id, WriteSet *write_set) const {
+  for (Page *page : write_set->pages_) {
+    if (page->GetPageId() == page_id) {
+      return page;
+    }
+  }
+  UNREACHABLE("page is not in the write set");
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseWriteSet(WriteSet *write_set, bool is_dirty) {
+  for (Page *page : write_set->pages_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  write_set->pages_.clear();
+  if (write_set->root_latched_) {
+    root_latch_.WUnlock();
+    write_set->root_latched_ = false;
+  }
+  for (page_id_t page_id : write_set->deleted_page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  write_set->deleted_page_ids_.clear();
 }
 
 /*
- * Update/Insert root page id in header page(where page_id = 0, header_page is
- * defined under include/page/header_page.h)
+ * Update/Insert root page id in header page(where page_id = header_page_id_,
+ * header_page is defined under include/page/header_page.h)
  * Call this method everytime root page id is changed.
  * @parameter: insert_record      defualt value is false. When set to true,
  * insert a record <index_name, root_page_id> into header page instead of
@@ -225,15 +963,29 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(header_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the header page");
+  }
+  HeaderPage *header_page = static_cast<HeaderPage *>(page);
+  int page_size = header_page->GetPageSize();
+  if (page_size != PAGE_SIZE) {
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    throw Exception("database file has " + std::to_string(page_size) + " byte pages, but PAGE_SIZE is " +
+                    std::to_string(PAGE_SIZE));
+  }
+  // Other trees update their records at the same time.
+  page->WLatch();
+  // A tree that became empty and starts over already has a record.
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 }
 
 /*
@@ -400,5 +1152,7 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<VarlenKey<64>, RID, VarlenComparator<64>>;
+template class BPlusTree<VarlenKey<256>, RID, VarlenComparator<256>>;
 
 }  // namespace bustub
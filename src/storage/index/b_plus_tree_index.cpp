@@ -11,7 +11,60 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <optional>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/util/external_sorter.h"
+#include "storage/page/header_page.h"
+
 namespace bustub {
+
+namespace {
+
+/** A range scan of a B+ tree, see BPlusTree::ScanBatch(). */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeRangeScan : public IndexRangeScan {
+ public:
+  BPlusTreeRangeScan(BPlusTree<KeyType, ValueType, KeyComparator> *tree, const KeyComparator &comparator,
+                     std::optional<KeyType> begin_key, std::optional<KeyType> end_key, bool forward)
+      : tree_(tree), comparator_(comparator), end_key_(std::move(end_key)), forward_(forward) {
+    cursor_.key_ = std::move(begin_key);
+  }
+
+  bool NextBatch(std::vector<RID> *result) override {
+    size_t result_size = result->size();
+    while (result->size() == result_size && !cursor_.done_) {
+      pairs_.clear();
+      tree_->ScanBatch(&cursor_, forward_, BATCH_SIZE, &pairs_);
+      for (const auto &pair : pairs_) {
+        if (end_key_.has_value()) {
+          int cmp = comparator_(pair.first, *end_key_);
+          if (forward_ ? cmp > 0 : cmp < 0) {
+            cursor_.done_ = true;
+            break;
+          }
+        }
+        result->push_back(pair.second);
+      }
+    }
+    return result->size() > result_size;
+  }
+
+ private:
+  // pairs to copy out of the tree at a time, in whole leaves
+  static constexpr size_t BATCH_SIZE = 256;
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
+  KeyComparator comparator_;
+  typename BPlusTree<KeyType, ValueType, KeyComparator>::ScanCursor cursor_;
+  std::optional<KeyType> end_key_;
+  bool forward_;
+  std::vector<MappingType> pairs_;
+};
+
+}  // namespace
+
 /*
  * Constructor
  */
@@ -19,13 +72,28 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      header_page_id_(NewHeaderPage(buffer_pool_manager)),
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>::DEFAULT_MAX_SIZE,
+                 BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::DEFAULT_MAX_SIZE, header_page_id_) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_INDEX_TYPE::NewHeaderPage(BufferPoolManager *buffer_pool_manager) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate a header page");
+  }
+  static_cast<HeaderPage *>(page)->Init();
+  buffer_pool_manager->UnpinPage(page_id, true);
+  return page_id;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,7 +102,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Remove(index_key, transaction);
 }
@@ -43,11 +111,49 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+std::unique_ptr<IndexRangeScan> BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low_key, const Tuple *high_key,
+                                                                bool reverse,
+                                                                [[maybe_unused]] Transaction *transaction) {
+  // construct the scan's bound keys
+  std::optional<KeyType> low_index_key;
+  if (low_key != nullptr) {
+    low_index_key.emplace();
+    low_index_key->SetFromKey(*low_key, *GetKeySchema());
+  }
+  std::optional<KeyType> high_index_key;
+  if (high_key != nullptr) {
+    high_index_key.emplace();
+    high_index_key->SetFromKey(*high_key, *GetKeySchema());
+  }
+
+  if (reverse) {
+    return std::make_unique<BPlusTreeRangeScan<KeyType, ValueType, KeyComparator>>(
+        &container_, comparator_, std::move(high_index_key), std::move(low_index_key), false);
+  }
+  return std::make_unique<BPlusTreeRangeScan<KeyType, ValueType, KeyComparator>>(
+      &container_, comparator_, std::move(low_index_key), std::move(high_index_key), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(TableHeap *table_heap, const Schema &schema, Transaction *transaction,
+                                    float fill_factor, size_t sort_memory) {
+  auto less = [this](const MappingType &lhs, const MappingType &rhs) { return comparator_(lhs.first, rhs.first) < 0; };
+  ExternalSorter<MappingType, decltype(less)> sorter(sort_memory, less);
+  for (auto tuple = table_heap->Begin(transaction); tuple != table_heap->End(); ++tuple) {
+    KeyType index_key;
+    index_key.SetFromKey(tuple->KeyFromTuple(schema, *GetKeySchema(), GetKeyAttrs()), *GetKeySchema());
+    sorter.Add({index_key, tuple->GetRid()});
+  }
+  sorter.Sort();
+  container_.BulkLoad([&sorter](MappingType *pair) { return sorter.Next(pair); }, fill_factor);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.Begin(); }
 
@@ -62,5 +168,7 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<VarlenKey<64>, RID, VarlenComparator<64>>;
+template class BPlusTreeIndex<VarlenKey<256>, RID, VarlenComparator<256>>;
 
 }  // namespace bustub
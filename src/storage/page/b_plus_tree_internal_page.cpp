@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -16,6 +18,21 @@
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
+
+namespace {
+
+/** Make parent_page_id the parent of the child page, e.g. after the child moved to another internal page. */
+void Adopt(page_id_t child_page_id, page_id_t parent_page_id, BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(child_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a child page to adopt it");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_page_id);
+  buffer_pool_manager->UnpinPage(child_page_id, true);
+}
+
+}  // namespace
+
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
@@ -25,34 +42,43 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetMaxSize(max_size);
+}
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const { return array_[index].first; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const { return 0; }
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (array_[i].second == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return array_[index].second; }
 
 /*****************************************************************************
  * LOOKUP
@@ -64,7 +90,18 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  return INVALID_PAGE_ID;
+  return array_[ChildIndex(key, comparator)].second;
+}
+
+/*
+ * Find the index of the child that may contain input "key", or, if before is
+ * true, the greatest key less than "key"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ChildIndex(const KeyType &key, const KeyComparator &comparator,
+                                               bool before) const {
+  // Find the last child whose key is <= key, or < key if before, i.e. the one before the first key after it.
+  return comparator.LowerBound(&array_[1].first, sizeof(MappingType), GetSize() - 1, key, !before);
 }
 
 /*****************************************************************************
@@ -78,7 +115,11 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value) {
+  array_[0].second = old_value;
+  array_[1] = {new_key, new_value};
+  SetSize(2);
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -87,7 +128,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  return 0;
+  int index = ValueIndex(old_value) + 1;
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index] = {new_key, new_value};
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -98,14 +143,25 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
+                                                BufferPoolManager *buffer_pool_manager) {
+  // The first key moved becomes the recipient's invalid first key; the caller pushes it up to the parent.
+  int keep = (GetSize() + 1) / 2;
+  recipient->CopyNFrom(array_ + keep, GetSize() - keep, buffer_pool_manager);
+  SetSize(keep);
+}
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+  std::copy(items, items + size, array_ + GetSize());
+  for (int i = 0; i < size; i++) {
+    Adopt(items[i].second, GetPageId(), buffer_pool_manager);
+  }
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +172,20 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return INVALID_PAGE_ID; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  SetSize(0);
+  return array_[0].second;
+}
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -136,7 +198,11 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return IN
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+                                               BufferPoolManager *buffer_pool_manager) {
+  SetKeyAt(0, middle_key);
+  recipient->CopyNFrom(array_, GetSize(), buffer_pool_manager);
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -151,14 +217,22 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
+                                                      BufferPoolManager *buffer_pool_manager) {
+  recipient->CopyLastFrom({middle_key, array_[0].second}, buffer_pool_manager);
+  // Our second key becomes the invalid first key, and the caller's new separation key.
+  Remove(0);
+}
 
 /* Append an entry at the end.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  array_[GetSize()] = pair;
+  IncreaseSize(1);
+  Adopt(pair.second, GetPageId(), buffer_pool_manager);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
@@ -169,14 +243,79 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+                                                       BufferPoolManager *buffer_pool_manager) {
+  // The moved key becomes the recipient's invalid first key, and the caller's new separation key.
+  recipient->SetKeyAt(0, middle_key);
+  recipient->CopyFirstFrom(array_[GetSize() - 1], buffer_pool_manager);
+  IncreaseSize(-1);
+}
 
 /* Append an entry at the beginning.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  std::move_backward(array_, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[0] = pair;
+  IncreaseSize(1);
+  Adopt(pair.second, GetPageId(), buffer_pool_manager);
+}
+
+/*****************************************************************************
+ * SIZE
+ *****************************************************************************/
+/*
+ * Whether the page must split
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsFull() const { return GetSize() > GetMaxSize(); }
+
+/*
+ * Whether inserting any one child leaves the page short of splitting
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToInsert() const { return GetSize() < GetMaxSize(); }
+
+/*
+ * Whether the page should take children from a sibling, or merge with it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderfull() const { return GetSize() < GetMinSize(); }
+
+/*
+ * Whether removing any one child keeps the page from becoming underfull
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToRemove() const { return GetSize() > GetMinSize(); }
+
+/*
+ * Whether MoveAllTo(recipient, middle_key) leaves the recipient short of
+ * splitting
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMoveAllTo(const BPlusTreeInternalPage *recipient,
+                                                  [[maybe_unused]] const KeyType &middle_key) const {
+  return recipient->GetSize() + GetSize() <= recipient->GetMaxSize();
+}
+
+/*
+ * Whether SetKeyAt(index, key) leaves the page short of splitting, which it
+ * always does
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt([[maybe_unused]] int index,
+                                                 [[maybe_unused]] const KeyType &key) const {
+  return true;
+}
+
+/*
+ * Whether the page is as full as bulk loading fills it, see BPlusTree::BulkLoad()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsFilled(float fill_factor) const {
+  return GetSize() >= std::max({static_cast<int>(GetMaxSize() * fill_factor), GetMinSize(), 2});
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -184,4 +323,280 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+/*****************************************************************************
+ * VARIABLE-LENGTH KEYS
+ *****************************************************************************/
+#define VARLEN_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  BUSTUB_ASSERT(max_size >= 4 * MAX_ENTRY_SIZE && max_size <= DEFAULT_MAX_SIZE, "page must hold 4 keys of any size");
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetMaxSize(max_size);
+  heap_begin_ = max_size;
+  heap_used_ = 0;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  KeyType key;
+  key.SetFromBytes(data_ + OffsetAt(index) + sizeof(uint16_t), KeySizeAt(index));
+  return key;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (key.GetSize() == KeySizeAt(index)) {
+    memcpy(data_ + OffsetAt(index) + sizeof(uint16_t), key.GetData(), key.GetSize());
+    return;
+  }
+  ValueType value = ValueAt(index);
+  RemoveAt(index);
+  InsertAt(index, key, value);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  ValueType value;
+  memcpy(&value, data_ + OffsetAt(index) + sizeof(uint16_t) + KeySizeAt(index), sizeof(ValueType));
+  return value;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
+  return ValueAt(ChildIndex(key, comparator));
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::ChildIndex(const KeyType &key,
+                                                      [[maybe_unused]] const KeyComparator &comparator,
+                                                      bool before) const {
+  // Find the last child whose key is <= key, or < key if before.
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    int cmp = CompareKeyBytes(data_ + OffsetAt(mid) + sizeof(uint16_t), KeySizeAt(mid), key.GetData(), key.GetSize());
+    if (cmp < 0 || (cmp == 0 && !before)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low - 1;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                            const ValueType &new_value) {
+  KeyType invalid_key;
+  invalid_key.SetFromBytes(new_key.GetData(), 0);
+  Rebuild(nullptr, 0);
+  InsertAt(0, invalid_key, old_value);
+  InsertAt(1, new_key, new_value);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                           const ValueType &new_value) {
+  InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
+  return GetSize();
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::Remove(int index) { RemoveAt(index); }
+
+VARLEN_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  ValueType value = ValueAt(0);
+  Rebuild(nullptr, 0);
+  return value;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+                                                      BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> items = GetItems(0, GetSize());
+  items[0].first = middle_key;
+  for (const auto &item : items) {
+    recipient->CopyLastFrom(item, buffer_pool_manager);
+  }
+  Rebuild(nullptr, 0);
+}
+
+/*
+ * Remove about half of the bytes of key & value pairs from this page to
+ * "recipient" page
+ */
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
+                                                       BufferPoolManager *buffer_pool_manager) {
+  // A page that splits holds at least 4 children, and both pages keep 2.
+  int keep = 2;
+  int used = 2 * sizeof(uint16_t) + RecordSizeAt(0) + RecordSizeAt(1);
+  while (keep + 2 < GetSize() && used < UsedSpace() / 2) {
+    used += sizeof(uint16_t) + RecordSizeAt(keep);
+    keep++;
+  }
+  // The first key moved becomes the recipient's invalid first key; the caller pushes it up to the parent.
+  std::vector<MappingType> items = GetItems(0, GetSize());
+  for (int i = keep; i < GetSize(); i++) {
+    recipient->CopyLastFrom(items[i], buffer_pool_manager);
+  }
+  Rebuild(items.data(), keep);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
+                                                             const KeyType &middle_key,
+                                                             BufferPoolManager *buffer_pool_manager) {
+  recipient->CopyLastFrom({middle_key, ValueAt(0)}, buffer_pool_manager);
+  // Our second key becomes the invalid first key, and the caller's new separation key.
+  RemoveAt(0);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
+                                                              const KeyType &middle_key,
+                                                              BufferPoolManager *buffer_pool_manager) {
+  // The moved key becomes the recipient's invalid first key, and the caller's new separation key.
+  recipient->SetKeyAt(0, middle_key);
+  recipient->InsertAt(0, KeyAt(GetSize() - 1), ValueAt(GetSize() - 1));
+  Adopt(ValueAt(GetSize() - 1), recipient->GetPageId(), buffer_pool_manager);
+  RemoveAt(GetSize() - 1);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair,
+                                                         BufferPoolManager *buffer_pool_manager) {
+  InsertAt(GetSize(), pair.first, pair.second);
+  Adopt(pair.second, GetPageId(), buffer_pool_manager);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::IsFull() const { return FreeSpace() < MAX_ENTRY_SIZE; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::IsSafeToInsert() const { return FreeSpace() >= 2 * MAX_ENTRY_SIZE; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::IsUnderfull() const { return UsedSpace() < GetMaxSize() / 4; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::IsSafeToRemove() const {
+  return GetSize() > 2 && UsedSpace() - MAX_ENTRY_SIZE >= GetMaxSize() / 4;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::CanMoveAllTo(const BPlusTreeInternalPage *recipient,
+                                                         const KeyType &middle_key) const {
+  int used = recipient->UsedSpace() + UsedSpace() - KeySizeAt(0) + middle_key.GetSize();
+  return used <= recipient->GetMaxSize() - MAX_ENTRY_SIZE;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const {
+  return UsedSpace() - KeySizeAt(index) + static_cast<int>(key.GetSize()) <= GetMaxSize() - MAX_ENTRY_SIZE;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::IsFilled(float fill_factor) const {
+  return GetSize() >= 2 &&
+         UsedSpace() >= std::max(static_cast<int>((GetMaxSize() - MAX_ENTRY_SIZE) * fill_factor), GetMaxSize() / 4);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::OffsetAt(int index) const {
+  return reinterpret_cast<const uint16_t *>(data_)[index];
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::KeySizeAt(int index) const {
+  uint16_t key_size;
+  memcpy(&key_size, data_ + OffsetAt(index), sizeof(key_size));
+  return key_size;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::RecordSizeAt(int index) const {
+  return sizeof(uint16_t) + KeySizeAt(index) + sizeof(ValueType);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::UsedSpace() const {
+  return GetSize() * static_cast<int>(sizeof(uint16_t)) + heap_used_;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::FreeSpace() const { return GetMaxSize() - UsedSpace(); }
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  uint16_t key_size = key.GetSize();
+  int record_size = sizeof(uint16_t) + key_size + sizeof(ValueType);
+  if (heap_begin_ - record_size < (GetSize() + 1) * static_cast<int>(sizeof(uint16_t))) {
+    // Reclaim the holes among the records.
+    std::vector<MappingType> items = GetItems(0, GetSize());
+    Rebuild(items.data(), items.size());
+  }
+  heap_begin_ -= record_size;
+  heap_used_ += record_size;
+  char *record = data_ + heap_begin_;
+  memcpy(record, &key_size, sizeof(uint16_t));
+  memcpy(record + sizeof(uint16_t), key.GetData(), key_size);
+  memcpy(record + sizeof(uint16_t) + key_size, &value, sizeof(ValueType));
+  auto *offsets = reinterpret_cast<uint16_t *>(data_);
+  std::move_backward(offsets + index, offsets + GetSize(), offsets + GetSize() + 1);
+  offsets[index] = heap_begin_;
+  IncreaseSize(1);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
+  int record_size = RecordSizeAt(index);
+  if (OffsetAt(index) == heap_begin_) {
+    heap_begin_ += record_size;
+  }
+  heap_used_ -= record_size;
+  auto *offsets = reinterpret_cast<uint16_t *>(data_);
+  std::move(offsets + index + 1, offsets + GetSize(), offsets + index);
+  IncreaseSize(-1);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::GetItems(int begin, int end) const -> std::vector<MappingType> {
+  std::vector<MappingType> items;
+  items.reserve(end - begin);
+  for (int i = begin; i < end; i++) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return items;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_INTERNAL_PAGE_TYPE::Rebuild(const MappingType *items, int size) {
+  heap_begin_ = GetMaxSize();
+  heap_used_ = 0;
+  SetSize(0);
+  for (int i = 0; i < size; i++) {
+    InsertAt(i, items[i].first, items[i].second);
+  }
+}
+
+template class BPlusTreeInternalPage<VarlenKey<64>, page_id_t, VarlenComparator<64>>;
+template class BPlusTreeInternalPage<VarlenKey<256>, page_id_t, VarlenComparator<256>>;
 }  // namespace bustub
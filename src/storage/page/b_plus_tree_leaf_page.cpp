@@ -9,6 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
@@ -27,55 +30,64 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+}
 
 /**
  * Helper methods to set/get next page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return INVALID_PAGE_ID; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  return comparator.LowerBound(&array_[0].first, sizeof(MappingType), GetSize(), key);
+}
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return array_[index].first; }
 
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array_[0];
-}
+const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) { return array_[index]; }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
- * @return  page size after insertion
+ * @return  page size after insertion, which is unchanged if the key already exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(array_[index].first, key) == 0) {
+    return GetSize();
+  }
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index] = {key, value};
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -85,13 +97,26 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  * Remove half of key & value pairs from this page to "recipient" page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) { MoveTailTo(recipient, GetSize() / 2); }
+
+/*
+ * Remove the key & value pairs from "index" on from this page to "recipient"
+ * page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveTailTo(BPlusTreeLeafPage *recipient, int index) {
+  recipient->CopyNFrom(array_ + index, GetSize() - index);
+  SetSize(index);
+}
 
 /*
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+  std::copy(items, items + size, array_ + GetSize());
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -103,7 +128,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  return false;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_[index].first, key) != 0) {
+    return false;
+  }
+  *value = array_[index].second;
+  return true;
 }
 
 /*****************************************************************************
@@ -116,7 +146,15 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  * @return   page size after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_[index].first, key) != 0) {
+    return GetSize();
+  }
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+  return GetSize();
+}
 
 /*****************************************************************************
  * MERGE
@@ -126,7 +164,11 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  * to update the next_page id in the sibling page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(array_, GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -135,29 +177,458 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
  * Remove the first key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyLastFrom(array_[0]);
+  std::move(array_ + 1, array_ + GetSize(), array_);
+  IncreaseSize(-1);
+}
 
 /*
  * Copy the item into the end of my item list. (Append item to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  array_[GetSize()] = item;
+  IncreaseSize(1);
+}
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyFirstFrom(array_[GetSize() - 1]);
+  IncreaseSize(-1);
+}
 
 /*
  * Insert item at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  std::move_backward(array_, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[0] = item;
+  IncreaseSize(1);
+}
+
+/*****************************************************************************
+ * SIZE
+ *****************************************************************************/
+/*
+ * Whether the key fits, which it always does: the page splits before it is out
+ * of room
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanInsert([[maybe_unused]] const KeyType &key) const {
+  return GetSize() < GetMaxSize();
+}
+
+/*
+ * Whether the page must split
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsFull() const { return GetSize() >= GetMaxSize(); }
+
+/*
+ * Whether inserting the key leaves the page short of splitting
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToInsert([[maybe_unused]] const KeyType &key) const {
+  return GetSize() + 1 < GetMaxSize();
+}
+
+/*
+ * Whether the page should take pairs from a sibling, or merge with it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderfull() const { return GetSize() < GetMinSize(); }
+
+/*
+ * Whether removing any one pair keeps the page from becoming underfull
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToRemove() const { return GetSize() > GetMinSize(); }
+
+/*
+ * Whether MoveAllTo(recipient) leaves the recipient short of splitting
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanMoveAllTo(const BPlusTreeLeafPage *recipient) const {
+  return recipient->GetSize() + GetSize() < recipient->GetMaxSize();
+}
+
+/*
+ * Whether the page is as full as bulk loading fills it, see BPlusTree::BulkLoad()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsFilled(float fill_factor) const {
+  return GetSize() >= std::max({static_cast<int>((GetMaxSize() - 1) * fill_factor), GetMinSize(), 1});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::SeparatorKey([[maybe_unused]] const KeyType &left, const KeyType &right) {
+  return right;
+}
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+/*****************************************************************************
+ * VARIABLE-LENGTH KEYS
+ *****************************************************************************/
+#define VARLEN_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  BUSTUB_ASSERT(max_size >= 4 * MAX_PAIR_SIZE && max_size <= DEFAULT_MAX_SIZE, "page must hold 4 pairs of any size");
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+  heap_begin_ = max_size;
+  heap_used_ = 0;
+  prefix_offset_ = max_size;
+  prefix_size_ = 0;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType { return GetItem(index).first; }
+
+/*
+ * Find the first index i so that the key at i >= key. The key is compared
+ * with the prefix once, and then only with the suffixes.
+ */
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key,
+                                                [[maybe_unused]] const KeyComparator &comparator) const {
+  if (GetSize() == 0) {
+    return 0;
+  }
+  int cmp = memcmp(key.GetData(), data_ + prefix_offset_, std::min<size_t>(key.GetSize(), prefix_size_));
+  if (cmp != 0 || key.GetSize() < prefix_size_) {
+    // Every key of the page starts with the prefix, so they are all greater than key, or all less.
+    return cmp <= 0 ? 0 : GetSize();
+  }
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (CompareSuffixAt(mid, key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  const char *record = data_ + OffsetAt(index);
+  uint16_t suffix_size = SuffixSizeAt(index);
+  char key_data[KeySize];
+  memcpy(key_data, data_ + prefix_offset_, prefix_size_);
+  memcpy(key_data + prefix_size_, record + sizeof(uint16_t), suffix_size);
+  MappingType item;
+  item.first.SetFromBytes(key_data, prefix_size_ + suffix_size);
+  memcpy(&item.second, record + sizeof(uint16_t) + suffix_size, sizeof(ValueType));
+  return item;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                                              const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && CompareAt(index, key) == 0) {
+    return GetSize();
+  }
+  InsertAt(index, key, value);
+  return GetSize();
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value,
+                                               const KeyComparator &comparator) const {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || CompareAt(index, key) != 0) {
+    return false;
+  }
+  memcpy(value, data_ + OffsetAt(index) + sizeof(uint16_t) + SuffixSizeAt(index), sizeof(ValueType));
+  return true;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || CompareAt(index, key) != 0) {
+    return GetSize();
+  }
+  RemoveAt(index);
+  return GetSize();
+}
+
+/*
+ * Remove about half of the bytes of key & value pairs from this page to
+ * "recipient" page
+ */
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int index = 1;
+  int used = sizeof(uint16_t) + RecordSizeAt(0);
+  while (index + 1 < GetSize() && used < UsedSpace() / 2) {
+    used += sizeof(uint16_t) + RecordSizeAt(index);
+    index++;
+  }
+  MoveTailTo(recipient, index);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::MoveTailTo(BPlusTreeLeafPage *recipient, int index) {
+  // Both pages get the longest prefix that their keys share.
+  std::vector<MappingType> items = GetItems(0, GetSize());
+  recipient->Rebuild(items.data() + index, GetSize() - index);
+  Rebuild(items.data(), index);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items = recipient->GetItems(0, recipient->GetSize());
+  std::vector<MappingType> moved_items = GetItems(0, GetSize());
+  items.insert(items.end(), moved_items.begin(), moved_items.end());
+  recipient->Rebuild(items.data(), items.size());
+  recipient->SetNextPageId(GetNextPageId());
+  Rebuild(nullptr, 0);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  MappingType item = GetItem(0);
+  recipient->InsertAt(recipient->GetSize(), item.first, item.second);
+  RemoveAt(0);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  MappingType item = GetItem(GetSize() - 1);
+  recipient->InsertAt(0, item.first, item.second);
+  RemoveAt(GetSize() - 1);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  InsertAt(GetSize(), item.first, item.second);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::CanInsert(const KeyType &key) const { return InsertSize(key) <= FreeSpace(); }
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::IsFull() const { return FreeSpace() < MAX_PAIR_SIZE; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::IsSafeToInsert(const KeyType &key) const {
+  return InsertSize(key) <= FreeSpace() - MAX_PAIR_SIZE;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::IsUnderfull() const { return UsedSpace() < GetMaxSize() / 4; }
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::IsSafeToRemove() const {
+  return UsedSpace() - MAX_PAIR_SIZE >= GetMaxSize() / 4;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::CanMoveAllTo(const BPlusTreeLeafPage *recipient) const {
+  if (GetSize() == 0) {
+    return true;
+  }
+  if (recipient->GetSize() == 0) {
+    return UsedSpace() <= recipient->GetMaxSize() - MAX_PAIR_SIZE;
+  }
+  // The merged page has at least the prefix that both prefixes start with. The suffixes grow by what they lose.
+  int prefix_size = 0;
+  while (prefix_size < std::min(prefix_size_, recipient->prefix_size_) &&
+         data_[prefix_offset_ + prefix_size] == recipient->data_[recipient->prefix_offset_ + prefix_size]) {
+    prefix_size++;
+  }
+  int used = prefix_size + UsedSpace() - prefix_size_ + GetSize() * (prefix_size_ - prefix_size) +
+             recipient->UsedSpace() - recipient->prefix_size_ +
+             recipient->GetSize() * (recipient->prefix_size_ - prefix_size);
+  return used <= recipient->GetMaxSize() - MAX_PAIR_SIZE;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::IsFilled(float fill_factor) const {
+  return GetSize() >= 1 &&
+         UsedSpace() >= std::max(static_cast<int>((GetMaxSize() - MAX_PAIR_SIZE) * fill_factor), GetMaxSize() / 4);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::SeparatorKey(const KeyType &left, const KeyType &right) -> KeyType {
+  // left < right, so they differ at the first byte that they do not share, or left ends there.
+  size_t size = 0;
+  while (size < std::min(left.GetSize(), right.GetSize()) && left.GetData()[size] == right.GetData()[size]) {
+    size++;
+  }
+  KeyType key;
+  key.SetFromBytes(right.GetData(), std::min(size + 1, right.GetSize()));
+  return key;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::OffsetAt(int index) const {
+  return reinterpret_cast<const uint16_t *>(data_)[index];
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::SuffixSizeAt(int index) const {
+  uint16_t suffix_size;
+  memcpy(&suffix_size, data_ + OffsetAt(index), sizeof(suffix_size));
+  return suffix_size;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::RecordSizeAt(int index) const {
+  return sizeof(uint16_t) + SuffixSizeAt(index) + sizeof(ValueType);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::UsedSpace() const {
+  return GetSize() * static_cast<int>(sizeof(uint16_t)) + heap_used_;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::FreeSpace() const { return GetMaxSize() - UsedSpace(); }
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::CompareAt(int index, const KeyType &key) const {
+  int cmp = memcmp(data_ + prefix_offset_, key.GetData(), std::min<size_t>(key.GetSize(), prefix_size_));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return key.GetSize() < prefix_size_ ? 1 : CompareSuffixAt(index, key);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::CompareSuffixAt(int index, const KeyType &key) const {
+  return CompareKeyBytes(data_ + OffsetAt(index) + sizeof(uint16_t), SuffixSizeAt(index),
+                         key.GetData() + prefix_size_, key.GetSize() - prefix_size_);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::CommonPrefixSize(const KeyType &key) const {
+  if (GetSize() == 0) {
+    return key.GetSize();
+  }
+  int size = 0;
+  while (size < std::min<int>(key.GetSize(), prefix_size_) && data_[prefix_offset_ + size] == key.GetData()[size]) {
+    size++;
+  }
+  return size;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::InsertSize(const KeyType &key) const {
+  int prefix_size = CommonPrefixSize(key);
+  int record_size = sizeof(uint16_t) + key.GetSize() - prefix_size + sizeof(ValueType);
+  // Every other suffix takes the bytes that the prefix loses.
+  return sizeof(uint16_t) + record_size + (prefix_size - prefix_size_) + GetSize() * (prefix_size_ - prefix_size);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  int prefix_size = CommonPrefixSize(key);
+  int record_size = sizeof(uint16_t) + key.GetSize() - prefix_size + sizeof(ValueType);
+  if (GetSize() == 0 || prefix_size != prefix_size_ ||
+      heap_begin_ - record_size < (GetSize() + 1) * static_cast<int>(sizeof(uint16_t))) {
+    // Lay the page out anew, for the new prefix or to reclaim the holes among the records.
+    std::vector<MappingType> items = GetItems(0, GetSize());
+    Rebuild(items.data(), items.size(), key.GetData(), prefix_size);
+  }
+  auto *offsets = reinterpret_cast<uint16_t *>(data_);
+  std::move_backward(offsets + index, offsets + GetSize(), offsets + GetSize() + 1);
+  offsets[index] = WriteRecord(key, value);
+  IncreaseSize(1);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+uint16_t B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::WriteRecord(const KeyType &key, const ValueType &value) {
+  uint16_t suffix_size = key.GetSize() - prefix_size_;
+  int record_size = sizeof(uint16_t) + suffix_size + sizeof(ValueType);
+  heap_begin_ -= record_size;
+  heap_used_ += record_size;
+  char *record = data_ + heap_begin_;
+  memcpy(record, &suffix_size, sizeof(uint16_t));
+  memcpy(record + sizeof(uint16_t), key.GetData() + prefix_size_, suffix_size);
+  memcpy(record + sizeof(uint16_t) + suffix_size, &value, sizeof(ValueType));
+  return heap_begin_;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  int record_size = RecordSizeAt(index);
+  if (OffsetAt(index) == heap_begin_) {
+    heap_begin_ += record_size;
+  }
+  heap_used_ -= record_size;
+  auto *offsets = reinterpret_cast<uint16_t *>(data_);
+  std::move(offsets + index + 1, offsets + GetSize(), offsets + index);
+  IncreaseSize(-1);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::GetItems(int begin, int end) const -> std::vector<MappingType> {
+  std::vector<MappingType> items;
+  items.reserve(end - begin);
+  for (int i = begin; i < end; i++) {
+    items.push_back(GetItem(i));
+  }
+  return items;
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::Rebuild(const MappingType *items, int size, const char *prefix,
+                                               int prefix_size) {
+  heap_begin_ = GetMaxSize() - prefix_size;
+  heap_used_ = prefix_size;
+  prefix_offset_ = heap_begin_;
+  prefix_size_ = prefix_size;
+  memcpy(data_ + prefix_offset_, prefix, prefix_size);
+  auto *offsets = reinterpret_cast<uint16_t *>(data_);
+  for (int i = 0; i < size; i++) {
+    offsets[i] = WriteRecord(items[i].first, items[i].second);
+  }
+  SetSize(size);
+}
+
+VARLEN_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARLEN_LEAF_PAGE_TYPE::Rebuild(const MappingType *items, int size) {
+  if (size == 0) {
+    Rebuild(items, 0, nullptr, 0);
+    return;
+  }
+  const KeyType &first = items[0].first;
+  const KeyType &last = items[size - 1].first;
+  int prefix_size = 0;
+  while (prefix_size < static_cast<int>(std::min(first.GetSize(), last.GetSize())) &&
+         first.GetData()[prefix_size] == last.GetData()[prefix_size]) {
+    prefix_size++;
+  }
+  Rebuild(items, size, first.GetData(), prefix_size);
+}
+
+template class BPlusTreeLeafPage<VarlenKey<64>, RID, VarlenComparator<64>>;
+template class BPlusTreeLeafPage<VarlenKey<256>, RID, VarlenComparator<256>>;
 }  // namespace bustub
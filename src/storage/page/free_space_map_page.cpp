@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_space_map_page.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetLSN(INVALID_LSN);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetEntryCount(0);
+}
+
+uint32_t FreeSpaceMapPage::Append(page_id_t table_page_id, uint8_t category) {
+  uint32_t slot_num = GetEntryCount();
+  if (slot_num == CAPACITY) {
+    return CAPACITY;
+  }
+  memcpy(GetData() + OFFSET_TABLE_PAGE_IDS + sizeof(page_id_t) * slot_num, &table_page_id, sizeof(page_id_t));
+  SetCategory(slot_num, category);
+  SetEntryCount(slot_num + 1);
+  return slot_num;
+}
+
+bool FreeSpaceMapPage::FindCategoryAtLeast(uint8_t min_category, uint32_t *slot_num) {
+  auto categories = reinterpret_cast<uint8_t *>(GetData() + OFFSET_CATEGORIES);
+  auto end = categories + GetEntryCount();
+  auto found = std::find_if(categories, end, [min_category](uint8_t category) { return category >= min_category; });
+  if (found == end) {
+    return false;
+  }
+  *slot_num = static_cast<uint32_t>(found - categories);
+  return true;
+}
+
+uint8_t FreeSpaceMapPage::GetMaxCategory() {
+  auto categories = reinterpret_cast<uint8_t *>(GetData() + OFFSET_CATEGORIES);
+  auto end = categories + GetEntryCount();
+  return categories == end ? 0 : *std::max_element(categories, end);
+}
+
+}  // namespace bustub
@@ -19,12 +19,13 @@
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
 #include "storage/index/hash_comparator.h"
+#include "storage/index/varlen_key.h"
 #include "storage/table/tmp_tuple.h"
 
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
+bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) const {
   for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
     if (!IsReadable(i)) {
       if (!IsOccupied(i)) {
@@ -128,12 +129,12 @@ void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx, int bit) {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::IsFull() {
+bool HASH_TABLE_BUCKET_TYPE::IsFull() const {
   return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() {
+uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() const {
   uint32_t num_readable = 0;
   for (int i = 0; i < GetNumofChars(); i++) {
     uint8_t readable = readable_[i];
@@ -146,12 +147,12 @@ uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::IsEmpty() {
+bool HASH_TABLE_BUCKET_TYPE::IsEmpty() const {
   return NumReadable() == 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::PrintBucket() {
+void HASH_TABLE_BUCKET_TYPE::PrintBucket() const {
   uint32_t size = 0;
   uint32_t taken = 0;
   uint32_t free = 0;
@@ -176,6 +177,8 @@ template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class HashTableBucketPage<VarlenKey<64>, RID, VarlenComparator<64>>;
+template class HashTableBucketPage<VarlenKey<256>, RID, VarlenComparator<256>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
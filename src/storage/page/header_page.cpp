@@ -24,9 +24,9 @@ bool HeaderPage::InsertRecord(const std::string &name, const page_id_t root_id)
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
-  // check for duplicate name
-  if (FindRecord(name) != -1) {
+  int offset = RECORDS_OFFSET + record_num * RECORD_SIZE;
+  // check for duplicate name, and for room left before the page size
+  if (FindRecord(name) != -1 || record_num == MAX_RECORD_COUNT) {
     return false;
   }
   // copy record content
@@ -46,8 +46,8 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
-  memmove(GetData() + offset, GetData() + offset + 36, (record_num - index - 1) * 36);
+  int offset = RECORDS_OFFSET + index * RECORD_SIZE;
+  memmove(GetData() + offset, GetData() + offset + RECORD_SIZE, (record_num - index - 1) * RECORD_SIZE);
 
   SetRecordCount(record_num - 1);
   return true;
@@ -61,7 +61,7 @@ bool HeaderPage::UpdateRecord(const std::string &name, const page_id_t root_id)
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
+  int offset = RECORDS_OFFSET + index * RECORD_SIZE;
   // update record content, only root_id
   memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -76,7 +76,7 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t *root_id) {
   if (index == -1) {
     return false;
   }
-  int offset = (index + 1) * 36;
+  int offset = RECORDS_OFFSET + index * RECORD_SIZE + 32;
   *root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -90,11 +90,19 @@ int HeaderPage::GetRecordCount() { return *reinterpret_cast<int *>(GetData()); }
 
 void HeaderPage::SetRecordCount(int record_count) { memcpy(GetData(), &record_count, 4); }
 
+// page size
+int HeaderPage::GetPageSize() {
+  int page_size = *reinterpret_cast<int *>(GetData() + PAGE_SIZE_OFFSET);
+  return page_size == 0 ? PAGE_SIZE : page_size;
+}
+
+void HeaderPage::SetPageSize(int page_size) { memcpy(GetData() + PAGE_SIZE_OFFSET, &page_size, 4); }
+
 int HeaderPage::FindRecord(const std::string &name) {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name = reinterpret_cast<char *>(GetData() + (RECORDS_OFFSET + i * RECORD_SIZE));
     if (strcmp(raw_name, name.c_str()) == 0) {
       return i;
     }
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+void FreeSpaceMap::Open(page_id_t first_page_id) {
+  std::scoped_lock latch(latch_);
+  auto map_page_id = first_page_id;
+  while (map_page_id != INVALID_PAGE_ID) {
+    auto guard = buffer_pool_manager_->FetchPageRead(map_page_id);
+    if (!guard.IsValid()) {
+      return;
+    }
+    auto map_page = static_cast<FreeSpaceMapPage *>(guard.GetPage());
+    if (map_page->GetFreeSpaceMapPageId() != map_page_id || map_page->GetEntryCount() > FreeSpaceMapPage::CAPACITY) {
+      return;
+    }
+    size_t index = map_page_ids_.size();
+    map_page_ids_.push_back(map_page_id);
+    max_categories_.push_back(map_page->GetMaxCategory());
+    for (uint32_t slot_num = 0; slot_num < map_page->GetEntryCount(); slot_num++) {
+      last_table_page_id_ = map_page->GetTablePageId(slot_num);
+      locations_[last_table_page_id_] = {index, slot_num};
+      table_page_ids_.push_back(last_table_page_id_);
+    }
+    map_page_id = map_page->GetNextPageId();
+    guard.Release();
+    // Only the last map page may be partially filled, otherwise positions in table_page_ids_ would be off.
+    if (table_page_ids_.size() != map_page_ids_.size() * FreeSpaceMapPage::CAPACITY) {
+      break;
+    }
+  }
+}
+
+page_id_t FreeSpaceMap::GetFirstPageId() {
+  std::scoped_lock latch(latch_);
+  return map_page_ids_.empty() ? INVALID_PAGE_ID : map_page_ids_.front();
+}
+
+page_id_t FreeSpaceMap::GetLastTablePageId() {
+  std::scoped_lock latch(latch_);
+  return last_table_page_id_;
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t required_space) {
+  // Round up, so that any page in the returned category really has enough room.
+  uint32_t min_category = (required_space + BYTES_PER_CATEGORY - 1) / BYTES_PER_CATEGORY;
+  if (min_category > UINT8_MAX) {
+    return INVALID_PAGE_ID;
+  }
+
+  std::scoped_lock latch(latch_);
+  for (size_t i = 0; i < map_page_ids_.size(); i++) {
+    size_t index = (search_hint_ + i) % map_page_ids_.size();
+    if (max_categories_[index] < min_category) {
+      continue;
+    }
+    auto guard = buffer_pool_manager_->FetchPageRead(map_page_ids_[index]);
+    if (!guard.IsValid()) {
+      return INVALID_PAGE_ID;
+    }
+    auto map_page = static_cast<FreeSpaceMapPage *>(guard.GetPage());
+    uint32_t slot_num;
+    page_id_t table_page_id = INVALID_PAGE_ID;
+    if (map_page->FindCategoryAtLeast(static_cast<uint8_t>(min_category), &slot_num)) {
+      table_page_id = map_page->GetTablePageId(slot_num);
+      search_hint_ = index;
+    } else {
+      // The bound was stale, tighten it so that we do not fetch this page again for nothing.
+      max_categories_[index] = map_page->GetMaxCategory();
+    }
+    if (table_page_id != INVALID_PAGE_ID) {
+      return table_page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::GetNextTablePages(page_id_t table_page_id, size_t skip, size_t count,
+                                     std::vector<page_id_t> *table_page_ids) {
+  std::scoped_lock latch(latch_);
+  auto location = locations_.find(table_page_id);
+  if (location == locations_.end()) {
+    return;
+  }
+  auto [index, slot_num] = location->second;
+  size_t begin = index * FreeSpaceMapPage::CAPACITY + slot_num + 1 + skip;
+  size_t end = std::min(begin + count, table_page_ids_.size());
+  for (size_t position = begin; position < end; position++) {
+    table_page_ids->push_back(table_page_ids_[position]);
+  }
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t table_page_id, uint32_t free_space) {
+  auto category = ToCategory(free_space);
+
+  std::scoped_lock latch(latch_);
+  auto location = locations_.find(table_page_id);
+  if (location == locations_.end() && buffer_pool_manager_->IsReadOnly()) {
+    // Without map pages, only the order of the table pages is kept, for GetNextTablePages(). Nothing can be inserted
+    // into a read-only table, so FindPage() need not find anything.
+    auto position = table_page_ids_.size();
+    locations_[table_page_id] = {position / FreeSpaceMapPage::CAPACITY, position % FreeSpaceMapPage::CAPACITY};
+    table_page_ids_.push_back(table_page_id);
+    last_table_page_id_ = table_page_id;
+    return;
+  }
+  if (location == locations_.end()) {
+    if (!Append(table_page_id, category)) {
+      // Not fatal: the page simply stays invisible to FindPage until it is reported again.
+      LOG_DEBUG("Couldn't extend the free space map.");
+    }
+    return;
+  }
+
+  auto [index, slot_num] = location->second;
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return;
+  }
+  auto guard = buffer_pool_manager_->FetchPageWrite(map_page_ids_[index]);
+  if (!guard.IsValid()) {
+    return;
+  }
+  auto map_page = static_cast<FreeSpaceMapPage *>(guard.GetPage());
+  if (map_page->GetCategory(slot_num) != category) {
+    map_page->SetCategory(slot_num, category);
+    guard.SetDirty();
+    max_categories_[index] = std::max(max_categories_[index], category);
+  }
+}
+
+bool FreeSpaceMap::Append(page_id_t table_page_id, uint8_t category) {
+  WritePageGuard guard;
+  if (!map_page_ids_.empty()) {
+    guard = buffer_pool_manager_->FetchPageWrite(map_page_ids_.back());
+    if (!guard.IsValid()) {
+      return false;
+    }
+  }
+
+  // Chain a new map page if there is none yet or the last one is full.
+  if (!guard.IsValid() || static_cast<FreeSpaceMapPage *>(guard.GetPage())->IsFull()) {
+    page_id_t new_page_id;
+    auto new_guard = buffer_pool_manager_->NewPageWrite(&new_page_id);
+    if (!new_guard.IsValid()) {
+      return false;
+    }
+    static_cast<FreeSpaceMapPage *>(new_guard.GetPage())->Init(new_page_id);
+    if (guard.IsValid()) {
+      static_cast<FreeSpaceMapPage *>(guard.GetPage())->SetNextPageId(new_page_id);
+      guard.SetDirty();
+    }
+    guard = std::move(new_guard);
+    map_page_ids_.push_back(new_page_id);
+    max_categories_.push_back(0);
+  }
+
+  size_t index = map_page_ids_.size() - 1;
+  uint32_t slot_num = static_cast<FreeSpaceMapPage *>(guard.GetPage())->Append(table_page_id, category);
+  guard.SetDirty();
+  guard.Release();
+  locations_[table_page_id] = {index, slot_num};
+  table_page_ids_.push_back(table_page_id);
+  max_categories_[index] = std::max(max_categories_[index], category);
+  last_table_page_id_ = table_page_id;
+  return true;
+}
+
+}  // namespace bustub
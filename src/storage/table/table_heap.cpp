@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -22,69 +26,131 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      free_space_map_(buffer_pool_manager) {
+  OpenFreeSpaceMap();
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      free_space_map_(buffer_pool_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
-  BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
-  first_page->WLatch();
+  auto guard = buffer_pool_manager_->NewPageWrite(&first_page_id_);
+  BUSTUB_ASSERT(guard.IsValid(), "Couldn't create a page for the table heap.");
+  auto first_page = static_cast<TablePage *>(guard.GetPage());
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  first_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  // Start the free space map with the first page, and remember where the map lives.
+  free_space_map_.UpdatePage(first_page_id_, first_page->GetFreeSpaceRemaining());
+  first_page->SetFreeSpaceMapPageId(free_space_map_.GetFirstPageId());
+}
+
+void TableHeap::OpenFreeSpaceMap() {
+  page_id_t fsm_page_id;
+  {
+    auto guard = buffer_pool_manager_->FetchPageRead(first_page_id_);
+    BUSTUB_ASSERT(guard.IsValid(), "Couldn't fetch the first page of the table heap.");
+    fsm_page_id = static_cast<TablePage *>(guard.GetPage())->GetFreeSpaceMapPageId();
+  }
+
+  if (fsm_page_id != INVALID_PAGE_ID) {
+    free_space_map_.Open(fsm_page_id);
+    if (free_space_map_.GetFirstPageId() != INVALID_PAGE_ID) {
+      return;
+    }
+  }
+
+  // There is no usable map, e.g. because recovery re-initialized the first page. Rebuild it from the page chain.
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = buffer_pool_manager_->FetchPageRead(page_id);
+    BUSTUB_ASSERT(guard.IsValid(), "Couldn't fetch a page of the table heap.");
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    free_space_map_.UpdatePage(page_id, page->GetFreeSpaceRemaining());
+    page_id = page->GetNextPageId();
+  }
+
+  // A read-only table keeps the rebuilt map in memory only.
+  if (buffer_pool_manager_->IsReadOnly()) {
+    return;
+  }
+  auto guard = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+  BUSTUB_ASSERT(guard.IsValid(), "Couldn't fetch the first page of the table heap.");
+  static_cast<TablePage *>(guard.GetPage())->SetFreeSpaceMapPageId(free_space_map_.GetFirstPageId());
+  guard.SetDirty();
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ + 36 > PAGE_SIZE || buffer_pool_manager_->IsReadOnly()) {  // larger than one page size, or read-only
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // Go straight to a page that the free space map says has room. The map is only approximate, so the page may turn
+  // out to be full after all; its real free space is then reported back and we ask again.
+  auto required_space = TablePage::SpaceRequired(tuple);
+  for (auto page_id = free_space_map_.FindPage(required_space); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map_.FindPage(required_space)) {
+    auto guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    if (!guard.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    bool is_inserted = page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    free_space_map_.UpdatePage(page_id, page->GetFreeSpaceRemaining());
+    if (is_inserted) {
+      guard.SetDirty();
+      // Update the transaction's write set.
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+  }
+
+  // No page has room, so we append to the end of the chain. Start from the last page the map knows about; another
+  // inserter may have appended since (or the map may lag behind the chain after a crash), so walk to the real end.
+  auto last_page_id = free_space_map_.GetLastTablePageId();
+  auto cur_guard =
+      buffer_pool_manager_->FetchPageWrite(last_page_id != INVALID_PAGE_ID ? last_page_id : first_page_id_);
+  if (!cur_guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
   // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
+  // INVARIANT: cur_guard holds the write latch of cur_page if you leave the loop normally.
+  auto cur_page = static_cast<TablePage *>(cur_guard.GetPage());
   while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
     auto next_page_id = cur_page->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
+      // Repeat the process with the next page; moving the guard releases the current page.
+      cur_guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      BUSTUB_ASSERT(cur_guard.IsValid(), "Couldn't fetch a page of the table heap.");
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_guard = buffer_pool_manager_->NewPageWrite(&next_page_id);
       // If we could not create a new page,
-      if (new_page == nullptr) {
+      if (!new_guard.IsValid()) {
         // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
       // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      cur_guard.SetDirty();
+      static_cast<TablePage *>(new_guard.GetPage())
+          ->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      cur_guard = std::move(new_guard);
     }
+    cur_page = static_cast<TablePage *>(cur_guard.GetPage());
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  cur_guard.SetDirty();
+  // The page we inserted into may be new to the free space map, this starts tracking it.
+  free_space_map_.UpdatePage(cur_page->GetTablePageId(), cur_page->GetFreeSpaceRemaining());
+  cur_guard.Release();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
@@ -92,37 +158,46 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
-  // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  // Find the page which contains the tuple, unless the pages of the table can not be modified.
+  WritePageGuard guard;
+  if (!buffer_pool_manager_->IsReadOnly()) {
+    guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  }
+  // If the page could not be found or can not be modified, then abort the transaction.
+  if (!guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (static_cast<TablePage *>(guard.GetPage())->MarkDelete(rid, txn, lock_manager_, log_manager_)) {
+    guard.SetDirty();
+  }
+  guard.Release();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
-  // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  // Find the page which contains the tuple, unless the pages of the table can not be modified.
+  WritePageGuard guard;
+  if (!buffer_pool_manager_->IsReadOnly()) {
+    guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  }
+  // If the page could not be found or can not be modified, then abort the transaction.
+  if (!guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Update the tuple; but first save the old value for rollbacks.
+  auto page = static_cast<TablePage *>(guard.GetPage());
   Tuple old_tuple;
-  page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (is_updated) {
+    guard.SetDirty();
+    free_space_map_.UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  }
+  guard.Release();
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -132,41 +207,83 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(guard.IsValid(), "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
-  page->WLatch();
+  auto page = static_cast<TablePage *>(guard.GetPage());
   page->ApplyDelete(rid, txn, log_manager_);
+  guard.SetDirty();
+  free_space_map_.UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(guard.IsValid(), "Couldn't find a page containing that RID.");
   // Rollback the delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  static_cast<TablePage *>(guard.GetPage())->RollbackDelete(rid, txn, log_manager_);
+  guard.SetDirty();
 }
 
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto guard = buffer_pool_manager_->FetchPageRead(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Read the tuple from the page.
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return static_cast<TablePage *>(guard.GetPage())->GetTuple(rid, tuple, txn, lock_manager_);
+}
+
+bool TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn) {
+  // Visit the rids page by page.
+  std::vector<size_t> order(rids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&rids](size_t lhs, size_t rhs) { return rids[lhs].GetPageId() < rids[rhs].GetPageId(); });
+  std::vector<Tuple> read(rids.size());
+  std::vector<bool> found(rids.size(), false);
+  for (size_t begin = 0, end; begin < order.size(); begin = end) {
+    page_id_t page_id = rids[order[begin]].GetPageId();
+    auto guard = buffer_pool_manager_->FetchPageRead(page_id);
+    // If the page could not be found, then abort the transaction.
+    if (!guard.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    auto *page = static_cast<TablePage *>(guard.GetPage());
+    for (end = begin; end < order.size() && rids[order[end]].GetPageId() == page_id; end++) {
+      found[order[end]] = page->GetTuple(rids[order[end]], &read[order[end]], txn, lock_manager_);
+    }
+  }
+  for (size_t i = 0; i < rids.size(); i++) {
+    if (found[i]) {
+      tuples->push_back(read[i]);
+    }
+  }
+  return true;
+}
+
+size_t TableHeap::GetReadAheadPages() {
+  // Never let read-ahead push out more than a small part of the buffer pool.
+  return std::min(read_ahead_pages_, buffer_pool_manager_->GetPoolSize() / 4);
+}
+
+size_t TableHeap::ReadAhead(page_id_t page_id, size_t prefetched) {
+  auto window = GetReadAheadPages();
+  if (prefetched >= window) {
+    return prefetched;
+  }
+  // The free space map knows the pages of the heap in chain order, so we need not read the pages to find them.
+  std::vector<page_id_t> page_ids;
+  free_space_map_.GetNextTablePages(page_id, prefetched, window - prefetched, &page_ids);
+  for (auto next_page_id : page_ids) {
+    buffer_pool_manager_->PrefetchPage(next_page_id);
+  }
+  return prefetched + page_ids.size();
 }
 
 TableIterator TableHeap::Begin(Transaction *txn) {
@@ -175,13 +292,10 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
+    auto guard = buffer_pool_manager_->FetchPageRead(page_id);
+    auto page = static_cast<TablePage *>(guard.GetPage());
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    if (found_tuple) {
+    if (page->GetFirstTupleRid(&rid)) {
       break;
     }
     page_id = page->GetNextPageId();
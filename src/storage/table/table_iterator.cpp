@@ -35,19 +35,18 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  auto cur_guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId());
+  assert(cur_guard.IsValid());  // all pages are pinned
+  auto cur_page = static_cast<TablePage *>(cur_guard.GetPage());
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      // The current page is only let go of once the next one is latched.
+      cur_guard = buffer_pool_manager->FetchPageRead(cur_page->GetNextPageId());
+      cur_page = static_cast<TablePage *>(cur_guard.GetPage());
+      OnNextPage(cur_page->GetTablePageId());
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -59,11 +58,23 @@ TableIterator &TableIterator::operator++() {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
   // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
   return *this;
 }
 
+void TableIterator::OnNextPage(page_id_t page_id) {
+  // A single step onto the next page may just be the end of a short range; from the second one on, assume the scan
+  // keeps going. The window is refilled once half of it has been used up.
+  if (pages_prefetched_ > 0) {
+    pages_prefetched_--;
+  }
+  if (++pages_scanned_ < 2) {
+    return;
+  }
+  if (pages_prefetched_ <= table_heap_->GetReadAheadPages() / 2) {
+    pages_prefetched_ = table_heap_->ReadAhead(page_id, pages_prefetched_);
+  }
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
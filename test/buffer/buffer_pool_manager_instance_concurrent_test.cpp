@@ -0,0 +1,436 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance_concurrent_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_instance_concurrent_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+const char *db_name = "test.db";
+
+/** Create num_pages pages on disk, each of which starts with its own page id. */
+void CreatePages(BufferPoolManager *bpm, size_t num_pages) {
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(static_cast<page_id_t>(i), page_id);
+    memcpy(page->GetData() + PAGE_SIZE / 2, &page_id, sizeof(page_id_t));
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+}
+
+/**
+ * Each thread fetches random pages, checks that it got the right page and unpins it again, dirtying every tenth
+ * page so that victims have to be written back too.
+ * @return the number of fetches per second over all threads
+ */
+double RunRandomFetchWorkload(BufferPoolManager *bpm, size_t num_pages, size_t num_threads, size_t ops_per_thread) {
+  std::atomic<size_t> failed_fetches{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back([&, thread_itr] {
+      std::default_random_engine rng(thread_itr);
+      std::uniform_int_distribution<page_id_t> page_dist(0, static_cast<page_id_t>(num_pages) - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = page_dist(rng);
+        auto page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          failed_fetches++;
+          continue;
+        }
+        EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData() + PAGE_SIZE / 2));
+        bpm->UnpinPage(page_id, i % 10 == 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(0, failed_fetches);
+  return static_cast<double>(num_threads * ops_per_thread) / elapsed.count();
+}
+
+/**
+ * Counts the data TLB misses of the calling thread in user space, if the hardware and the kernel let us.
+ */
+class DtlbMissCounter {
+ public:
+  DtlbMissCounter() {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+  ~DtlbMissCounter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  void Start() {
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  /** @return the number of misses since Start(), or -1 if they cannot be counted */
+  int64_t Stop() {
+    uint64_t count;
+    if (fd_ < 0 || ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) != 0 || read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      return -1;
+    }
+    return static_cast<int64_t>(count);
+  }
+
+ private:
+  int fd_;
+};
+
+/**
+ * One thread scans pages [num_hot_pages, num_hot_pages + num_scan_pages) in order, num_passes times, while another
+ * keeps doing point lookups of random pages in [0, num_hot_pages), like the inner pages of an index. Like
+ * TableIterator, the scan fetches each page again for every tuple; it keeps the page pinned meanwhile, so that these
+ * fetches are all hits and can be told apart from those of the point lookups.
+ * @param[out] num_point_lookups the number of point lookups
+ * @param[out] scan_refetches the number of fetches of the scan that found the page pinned by the scan itself
+ */
+void RunScanAndPointWorkload(BufferPoolManager *bpm, size_t num_hot_pages, size_t num_scan_pages,
+                             size_t tuples_per_page, size_t num_passes, size_t *num_point_lookups,
+                             size_t *scan_refetches) {
+  std::atomic<bool> done{false};
+  *num_point_lookups = 0;
+  std::thread point_lookups([&] {
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> page_dist(0, static_cast<page_id_t>(num_hot_pages) - 1);
+    while (!done) {
+      page_id_t page_id = page_dist(rng);
+      auto page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData() + PAGE_SIZE / 2));
+      bpm->UnpinPage(page_id, false);
+      (*num_point_lookups)++;
+      std::this_thread::yield();
+    }
+  });
+
+  *scan_refetches = 0;
+  for (size_t pass = 0; pass < num_passes; pass++) {
+    for (size_t i = num_hot_pages; i < num_hot_pages + num_scan_pages; i++) {
+      auto page_id = static_cast<page_id_t>(i);
+      auto page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      for (size_t tuple = 0; tuple < tuples_per_page; tuple++) {
+        EXPECT_EQ(page, bpm->FetchPage(page_id));
+        bpm->UnpinPage(page_id, false);
+        (*scan_refetches)++;
+      }
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData() + PAGE_SIZE / 2));
+      bpm->UnpinPage(page_id, false);
+      std::this_thread::yield();
+    }
+  }
+  done = true;
+  point_lookups.join();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, ConcurrentFetchSamePageTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 8;
+  const size_t num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  CreatePages(bpm, num_pages);
+
+  // Everybody goes after the same page at the same time, only one of them should read it in.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+    std::vector<std::thread> threads;
+    std::vector<Page *> fetched(num_threads);
+    for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+      threads.emplace_back([&, thread_itr] { fetched[thread_itr] = bpm->FetchPage(page_id); });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (auto page : fetched) {
+      ASSERT_EQ(fetched[0], page);
+    }
+    EXPECT_EQ(num_threads, fetched[0]->GetPinCount());
+    EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(fetched[0]->GetData() + PAGE_SIZE / 2));
+    for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name);
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, ConcurrentFlushPageTest) {
+  const int num_updates = 2000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager);
+  CreatePages(bpm, 1);
+
+  // One thread keeps changing the page while another keeps flushing it; a change that lands during a flush must
+  // leave the page dirty, so that the last flush writes it.
+  std::thread writer([&] {
+    for (int i = 1; i <= num_updates; i++) {
+      auto page = bpm->FetchPage(0);
+      ASSERT_NE(nullptr, page);
+      page->WLatch();
+      memcpy(page->GetData(), &i, sizeof(i));
+      page->WUnlatch();
+      bpm->UnpinPage(0, true);
+    }
+  });
+  std::thread flusher([&] {
+    for (int i = 0; i < num_updates; i++) {
+      EXPECT_TRUE(bpm->FlushPage(0));
+    }
+  });
+  writer.join();
+  flusher.join();
+  EXPECT_TRUE(bpm->FlushPage(0));
+
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(0, data);
+  EXPECT_EQ(num_updates, *reinterpret_cast<int *>(data));
+
+  disk_manager->ShutDown();
+  remove(db_name);
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, DISABLED_MissHeavyBenchmark) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 1024;
+  const size_t total_ops = 40000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  CreatePages(bpm, num_pages);
+
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    double ops_per_sec = RunRandomFetchWorkload(bpm, num_pages, num_threads, total_ops / num_threads);
+    printf("miss-heavy fetch: %zu thread(s), %.0f fetches/sec\n", num_threads, ops_per_sec);
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name);
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, DISABLED_HitHeavyBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_pages = 48;
+  const size_t total_ops = 400000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::CLOCK);
+  CreatePages(bpm, num_pages);
+
+  // Every page fits, so after the first fetches every fetch is a hit that does not need the latch.
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    auto before = bpm->GetStats();
+    double ops_per_sec = RunRandomFetchWorkload(bpm, num_pages, num_threads, total_ops / num_threads);
+    auto after = bpm->GetStats();
+    EXPECT_EQ(0, after.misses_ - before.misses_);
+    printf("hit-heavy fetch: %zu thread(s), %.0f fetches/sec\n", num_threads, ops_per_sec);
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name);
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, DISABLED_BackgroundFlusherBenchmark) {
+  const size_t buffer_pool_size = 256;
+  const size_t num_pages = 1024;
+  const size_t num_threads = 4;
+  const size_t total_ops = 40000;
+
+  // The same miss-heavy workload, with misses writing back their own dirty victims and with the flusher doing it.
+  for (bool flusher : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    CreatePages(bpm, num_pages);
+    if (flusher) {
+      BackgroundFlusherOptions options;
+      options.target_clean_fraction_ = 1.0;
+      bpm->StartBackgroundFlusher(options);
+    }
+    auto before = bpm->GetStats();
+    double ops_per_sec = RunRandomFetchWorkload(bpm, num_pages, num_threads, total_ops / num_threads);
+    auto after = bpm->GetStats();
+    printf("%s: %.0f fetches/sec, %lu dirty and %lu clean evictions, %lu background flushes\n",
+           flusher ? "background flusher" : "no flusher", ops_per_sec, after.dirty_evictions_ - before.dirty_evictions_,
+           after.clean_evictions_ - before.clean_evictions_, after.background_flushes_ - before.background_flushes_);
+    bpm->StopBackgroundFlusher();
+
+    disk_manager->ShutDown();
+    remove(db_name);
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, DISABLED_FlushAllPagesBenchmark) {
+  const size_t buffer_pool_size = 4096;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  CreatePages(bpm, buffer_pool_size);
+
+  // Dirty every page, then write them all back: one FlushPage() at a time, and with FlushAllPages().
+  auto dirty_all = [&] {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+  };
+  dirty_all();
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    bpm->FlushPage(page_id);
+  }
+  disk_manager->SyncDbFile();
+  std::chrono::duration<double> one_by_one = std::chrono::steady_clock::now() - start;
+  dirty_all();
+  start = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  std::chrono::duration<double> all = std::chrono::steady_clock::now() - start;
+  printf("flush %zu dirty pages: %.1f ms one by one, %.1f ms with FlushAllPages()\n", buffer_pool_size,
+         one_by_one.count() * 1000, all.count() * 1000);
+
+  disk_manager->ShutDown();
+  remove(db_name);
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, DISABLED_FrameMemoryBenchmark) {
+  // 64MB of frames, far more than the TLB covers with 4KB pages.
+  const size_t buffer_pool_size = 16384;
+  const size_t total_ops = 2000000;
+
+  FrameMemoryOptions huge_pages;
+  huge_pages.huge_pages_ = true;
+  const std::vector<std::pair<FrameMemoryOptions, std::string>> allocations{{FrameMemoryOptions{}, "4KB pages"},
+                                                                           {huge_pages, "huge pages"}};
+  for (const auto &[frame_memory, name] : allocations) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm =
+        new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::CLOCK, frame_memory);
+    CreatePages(bpm, buffer_pool_size);
+
+    // Every page is resident, so this measures how fast hits get at their frames.
+    DtlbMissCounter counter;
+    counter.Start();
+    double ops_per_sec = RunRandomFetchWorkload(bpm, buffer_pool_size, 1, total_ops);
+    auto dtlb_misses = counter.Stop();
+    printf("frame memory, %s (%s): %.0f fetches/sec, ", name.c_str(),
+           bpm->GetFrameMemory().UsesHugePages() ? "huge pages used" : "huge pages not used", ops_per_sec);
+    if (dtlb_misses >= 0) {
+      printf("%.3f dTLB misses/fetch\n", static_cast<double>(dtlb_misses) / total_ops);
+    } else {
+      printf("dTLB misses not available\n");
+    }
+
+    disk_manager->ShutDown();
+    remove(db_name);
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceConcurrentTest, DISABLED_ScanResistanceBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 40;
+  const size_t num_scan_pages = 1024;
+  const size_t tuples_per_page = 20;
+  const size_t num_passes = 4;
+
+  const std::vector<std::pair<ReplacerType, std::string>> replacers{{ReplacerType::LRU, "LRU"},
+                                                                   {ReplacerType::CLOCK, "Clock"},
+                                                                   {ReplacerType::LRU_K, "LRU-K"},
+                                                                   {ReplacerType::TWO_Q, "2Q"}};
+  for (const auto &[replacer_type, name] : replacers) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    CreatePages(bpm, num_hot_pages + num_scan_pages);
+
+    auto before = bpm->GetStats();
+    size_t num_point_lookups;
+    size_t scan_refetches;
+    RunScanAndPointWorkload(bpm, num_hot_pages, num_scan_pages, tuples_per_page, num_passes, &num_point_lookups,
+                            &scan_refetches);
+    auto after = bpm->GetStats();
+    auto hits = after.hits_ - before.hits_;
+    auto misses = after.misses_ - before.misses_;
+    // The scan finds its own pinned page every time it fetches it again; every other hit is a point lookup.
+    printf("scan + point lookups, %s: %zu lookups, hit ratio %.3f, point lookup hit ratio %.3f\n", name.c_str(),
+           num_point_lookups, static_cast<double>(hits) / static_cast<double>(hits + misses),
+           static_cast<double>(hits - scan_refetches) / static_cast<double>(num_point_lookups));
+
+    disk_manager->ShutDown();
+    remove(db_name);
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
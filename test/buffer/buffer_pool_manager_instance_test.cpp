@@ -11,9 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <unistd.h>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -80,6 +86,7 @@ TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
 
   delete bpm;
   delete disk_manager;
@@ -136,9 +143,362 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
 
   delete bpm;
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Write out 2 * buffer_pool_size pages. Half of them are dirty when they get evicted.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(buffer_pool_size, stats.dirty_evictions_);
+  EXPECT_EQ(0, stats.clean_evictions_);
+  bpm->FlushAllPages();
+
+  // Scenario: Pages that are only read are never written back, no matter how often they are fetched or evicted.
+  for (int round = 0; round < 3; ++round) {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * 2); ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size * 2 * 3, stats.hits_);
+  EXPECT_EQ(buffer_pool_size * 2 * 3, stats.misses_);
+  EXPECT_EQ(buffer_pool_size, stats.dirty_evictions_);
+  EXPECT_EQ(buffer_pool_size * 2 * 3, stats.clean_evictions_);
+
+  // Scenario: A clean unpin does not hide an earlier dirty one.
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_TRUE(page0->IsDirty());
+
+  // Scenario: A frame counts as pinned once, however many pins it has.
+  EXPECT_EQ(0, bpm->GetNumPinnedFrames());
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(2, bpm->GetNumPinnedFrames());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(2, bpm->GetNumPinnedFrames());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(0, bpm->GetNumPinnedFrames());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeletePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+  }
+
+  // Scenario: A pinned page cannot be deleted, and its page id stays taken.
+  EXPECT_EQ(false, bpm->DeletePage(1));
+  EXPECT_TRUE(disk_manager->IsAllocated(1));
+
+  // Scenario: The page id of a deleted page is handed out again, whether the page was in the buffer pool or not.
+  EXPECT_EQ(true, bpm->UnpinPage(1, true));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  EXPECT_FALSE(disk_manager->IsAllocated(1));
+
+  // Scenario: A page that has been deleted already cannot be deleted again.
+  EXPECT_EQ(false, bpm->DeletePage(1));
+  EXPECT_EQ(false, bpm->DeletePage(100));
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(0, page->GetData()[0]);
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(2, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ChecksumTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, DiskManager::Backend::PREAD, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Flip a bit of page 1 on disk.
+  std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(PAGE_SIZE + 2);
+  file.put('G');
+  file.close();
+
+  // Scenario: A page that does not match its checksum cannot be fetched or prefetched, the others can.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(1, bpm->GetStats().read_errors_);
+  bpm->PrefetchPage(1);
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_LE(2, bpm->GetStats().read_errors_);
+  auto *page = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 2"));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  // Scenario: The failed reads left no frame behind.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.crc");
+  remove("test.alloc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Only dirty pages are written, pinned or not, and each of them once.
+  page_id_t page_ids[buffer_pool_size];
+  Page *pages[buffer_pool_size];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pages[i] = bpm->NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, pages[i]);
+    snprintf(pages[i]->GetData(), PAGE_SIZE, "Page %zu", i);
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    // Every third page is clean, which splits the dirty ones into runs. Page 1 stays pinned.
+    if (i == 1) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], i % 3 != 0));
+  }
+  bpm->FlushAllPages();
+  auto num_dirty = buffer_pool_size - (buffer_pool_size + 2) / 3;
+  EXPECT_EQ(num_dirty, disk_manager->GetNumWrites());
+  for (auto *page : pages) {
+    EXPECT_FALSE(page->IsDirty());
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_dirty, disk_manager->GetNumWrites());
+
+  // Scenario: The pages made it to disk.
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], false));
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    if (i % 3 != 0) {
+      auto *page = bpm->FetchPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      char expected[PAGE_SIZE];
+      snprintf(expected, PAGE_SIZE, "Page %zu", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundFlusherTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+  auto wait_for = [](const std::function<bool()> &condition) {
+    for (int i = 0; i < 1000 && !condition(); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return condition();
+  };
+  BackgroundFlusherOptions options;
+  options.target_clean_fraction_ = 1.0;
+  options.interval_ = std::chrono::milliseconds(1);
+  bpm->StartBackgroundFlusher(options);
+
+  // Scenario: The flusher writes back dirty pages once they are unpinned, so evicting them needs no write.
+  page_id_t page_ids[buffer_pool_size];
+  Page *pages[buffer_pool_size];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pages[i] = bpm->NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, pages[i]);
+    snprintf(pages[i]->GetData(), PAGE_SIZE, "Page %zu", i);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(0, bpm->GetStats().background_flushes_);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+  }
+  EXPECT_TRUE(wait_for([&] { return bpm->GetStats().background_flushes_ == buffer_pool_size; }));
+  for (auto *page : pages) {
+    EXPECT_FALSE(page->IsDirty());
+  }
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetStats().dirty_evictions_);
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().clean_evictions_);
+  auto *page0 = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Page 0"));
+
+  // Scenario: With logging enabled, a page is not written back before the log is persistent up to its LSN.
+  enable_logging = true;
+  page0->SetLSN(5);
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], true));
+  auto flushes = bpm->GetStats().background_flushes_;
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_TRUE(page0->IsDirty());
+  log_manager->SetPersistentLSN(5);
+  EXPECT_TRUE(wait_for([&] { return bpm->GetStats().background_flushes_ == flushes + 1; }));
+  EXPECT_FALSE(page0->IsDirty());
+  enable_logging = false;
+
+  bpm->StopBackgroundFlusher();
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, FailedWriteBackTest) {
+  // Every write to /dev/full fails with ENOSPC, while reads return zeros.
+  const std::string db_name = "full.db";
+  remove(db_name.c_str());
+  ASSERT_EQ(0, symlink("/dev/full", db_name.c_str()));
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id0;
+  auto *page0 = bpm->NewPage(&page_id0);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(true, bpm->UnpinPage(page_id0, true));
+
+  // Scenario: A failed flush keeps the page dirty.
+  EXPECT_FALSE(bpm->FlushPage(page_id0));
+  EXPECT_TRUE(page0->IsDirty());
+
+  // Scenario: The dirty page cannot be evicted, so once the other frame is pinned there is no frame left.
+  page_id_t page_id1;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id1));
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: The page is still in memory with its data.
+  page0 = bpm->FetchPage(page_id0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_TRUE(page0->IsDirty());
+  EXPECT_EQ(true, bpm->UnpinPage(page_id0, false));
+
+  // Scenario: Once unpinned again, evicting the page fails the same way and the caller gets no frame.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  page0 = bpm->FetchPage(page_id0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id1, true));
+
+  // Scenario: Pages whose batched write-back fails stay dirty.
+  bpm->FlushAllPages();
+  page0 = bpm->FetchPage(page_id0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_TRUE(page0->IsDirty());
+  auto *page1 = bpm->FetchPage(page_id1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_TRUE(page1->IsDirty());
+  EXPECT_EQ(true, bpm->UnpinPage(page_id0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id1, false));
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("full.log");
+  remove("full.alloc");
+}
+
 }  // namespace bustub
@@ -10,16 +10,47 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <mutex>   // NOLINT
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+namespace {
+
+/**
+ * Each thread pins and unpins frames of its own, like concurrent fetches of different pages.
+ * @return the number of pins and unpins per second over all threads
+ */
+double RunPinUnpinWorkload(Replacer *replacer, size_t frames_per_thread, size_t num_threads, size_t ops_per_thread) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back([&, thread_itr] {
+      for (size_t i = 0; i < ops_per_thread; i += 2) {
+        auto frame_id = static_cast<frame_id_t>(thread_itr * frames_per_thread + i / 2 % frames_per_thread);
+        replacer->Pin(frame_id);
+        replacer->Unpin(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * ops_per_thread) / elapsed.count();
+}
+
+}  // namespace
+
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +90,70 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, ConcurrentTest) {
+  const size_t num_threads = 8;
+  const size_t frames_per_thread = 64;
+  const size_t num_frames = num_threads * frames_per_thread;
+  ClockReplacer clock_replacer(num_frames);
+
+  // Scenario: everybody pins and unpins their own frames, then leaves every other one unpinned.
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back([&, thread_itr] {
+      for (size_t round = 0; round < 100; round++) {
+        for (size_t i = 0; i < frames_per_thread; i++) {
+          clock_replacer.Unpin(static_cast<frame_id_t>(thread_itr * frames_per_thread + i));
+        }
+        for (size_t i = 0; i < frames_per_thread; i += round % 2 + 1) {
+          clock_replacer.Pin(static_cast<frame_id_t>(thread_itr * frames_per_thread + i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_frames / 2, clock_replacer.Size());
+
+  // Scenario: everybody looks for victims at the same time. Every unpinned frame is handed out exactly once.
+  std::vector<frame_id_t> victims;
+  std::mutex victims_latch;
+  threads.clear();
+  for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back([&] {
+      frame_id_t frame_id;
+      while (clock_replacer.Victim(&frame_id)) {
+        std::scoped_lock latch(victims_latch);
+        victims.push_back(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+  std::sort(victims.begin(), victims.end());
+  ASSERT_EQ(num_frames / 2, victims.size());
+  for (size_t i = 0; i < victims.size(); i++) {
+    EXPECT_EQ(static_cast<frame_id_t>(2 * i + 1), victims[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, DISABLED_PinUnpinBenchmark) {
+  const size_t frames_per_thread = 64;
+  const size_t total_ops = 1 << 20;
+
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    ClockReplacer clock_replacer(num_threads * frames_per_thread);
+    LRUReplacer lru_replacer(num_threads * frames_per_thread);
+    size_t ops_per_thread = total_ops / num_threads;
+    double clock_ops_per_sec = RunPinUnpinWorkload(&clock_replacer, frames_per_thread, num_threads, ops_per_thread);
+    double lru_ops_per_sec = RunPinUnpinWorkload(&lru_replacer, frames_per_thread, num_threads, ops_per_thread);
+    printf("pin/unpin: %zu thread(s), clock %.0f ops/sec, lru %.0f ops/sec\n", num_threads, clock_ops_per_sec,
+           lru_ops_per_sec);
+  }
+}
+
 }  // namespace bustub
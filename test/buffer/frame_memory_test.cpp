@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_memory_test.cpp
+//
+// Identification: test/buffer/frame_memory_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/frame_memory.h"
+#include "common/config.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameMemoryTest, SampleTest) {
+  const size_t size = 300 * PAGE_SIZE;
+
+  // Scenario: every way of allocating gives PAGE_SIZE aligned, zeroed and writable memory. Huge pages and NUMA nodes
+  // may not be available, in which case the memory is still there.
+  FrameMemoryOptions huge_pages;
+  huge_pages.huge_pages_ = true;
+  FrameMemoryOptions node_zero;
+  node_zero.numa_node_ = 0;
+  for (const auto &options : {FrameMemoryOptions{}, huge_pages, node_zero}) {
+    FrameMemory memory(size, options);
+    ASSERT_NE(nullptr, memory.GetData());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(memory.GetData()) % PAGE_SIZE);
+    EXPECT_EQ(0, memory.GetData()[size - 1]);
+    memset(memory.GetData(), 1, size);
+    EXPECT_EQ(1, memory.GetData()[size - 1]);
+    EXPECT_FALSE(!options.huge_pages_ && memory.UsesHugePages());
+    EXPECT_FALSE(options.numa_node_ < 0 && memory.IsBoundToNode());
+  }
+
+  // Scenario: a node that does not exist leaves the memory unbound.
+  FrameMemoryOptions no_such_node;
+  no_such_node.numa_node_ = 1000;
+  FrameMemory memory(size, no_such_node);
+  ASSERT_NE(nullptr, memory.GetData());
+  EXPECT_FALSE(memory.IsBoundToNode());
+  memset(memory.GetData(), 1, size);
+}
+
+}  // namespace bustub
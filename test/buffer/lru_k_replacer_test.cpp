@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  // Accesses right after each other are correlated.
+  LRUKReplacer lru_k_replacer(7, 2, 1);
+
+  // Scenario: access frames 1 to 4, then 1 and 2 again. Accessing 5 twice in a row counts as one access.
+  for (frame_id_t frame_id = 1; frame_id <= 4; frame_id++) {
+    lru_k_replacer.RecordAccess(frame_id, frame_id);
+  }
+  lru_k_replacer.RecordAccess(1, 1);
+  lru_k_replacer.RecordAccess(2, 2);
+  lru_k_replacer.RecordAccess(5, 5);
+  lru_k_replacer.RecordAccess(5, 5);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // Scenario: unpin all of them.
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // Scenario: frames accessed only once go first, least recently accessed first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+
+  // Scenario: pin 5, and remove 4 for good. A victim keeps its history until it is removed.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Remove(4);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: 3 is accessed again, which is its second access. 4 starts over.
+  lru_k_replacer.RecordAccess(3, 3);
+  lru_k_replacer.RecordAccess(4, 4);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+
+  // Scenario: the frames accessed once go first, then by their second most recent access.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+}  // namespace bustub
@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/execution_engine.h"
+#include "execution/executor_context.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class MmapBufferPoolManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { TearDown(); }
+
+  void TearDown() override {
+    for (const char *file : {"test.db", "test.log", "test.alloc", "test.crc", "test.map"}) {
+      remove(file);
+    }
+  }
+};
+
+namespace {
+
+/**
+ * Fill a new table with rows (i, "row i").
+ * @return the id of the first page of the table
+ */
+page_id_t CreateTable(BufferPoolManager *bpm, const Schema &schema, int num_rows) {
+  LockManager lock_manager;
+  Transaction txn(0);
+  TableHeap table(bpm, &lock_manager, nullptr, &txn);
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue("row " + std::to_string(i))};
+    Tuple tuple(values, &schema);
+    RID rid;
+    EXPECT_TRUE(table.InsertTuple(tuple, &rid, &txn));
+  }
+  bpm->FlushAllPages();
+  return table.GetFirstPageId();
+}
+
+/**
+ * Scan a table through the execution engine.
+ * @return the rows of the table
+ */
+std::vector<Tuple> ScanTable(BufferPoolManager *bpm, const Schema &schema, page_id_t first_page_id) {
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager, nullptr);
+  Catalog catalog(bpm, &lock_manager, nullptr);
+  auto *table_info = catalog.OpenTable("t", schema, first_page_id);
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  auto *txn = txn_mgr.Begin(nullptr, IsolationLevel::READ_UNCOMMITTED);
+  ExecutorContext exec_ctx(txn, &catalog, bpm, &txn_mgr, &lock_manager);
+  ExecutionEngine engine(bpm, &txn_mgr, &catalog);
+  SeqScanPlanNode plan(&table_info->schema_, nullptr, table_info->oid_);
+  std::vector<Tuple> result_set;
+  EXPECT_TRUE(engine.Execute(&plan, &result_set, txn, &exec_ctx));
+  txn_mgr.Commit(txn);
+  delete txn;
+  return result_set;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, SampleTest) {
+  const page_id_t num_pages = 10;
+  {
+    DiskManager disk_manager("test.db");
+    char data[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      memset(data, page_id + 1, PAGE_SIZE);
+      disk_manager.WritePage(page_id, data);
+    }
+    disk_manager.ShutDown();
+  }
+
+  MmapBufferPoolManager bpm("test.db");
+  EXPECT_EQ(num_pages, bpm.GetPoolSize());
+
+  // Scenario: pages are views into the file, and fetching a page again gives the same view.
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ(page_id + 1, page->GetData()[0]);
+    EXPECT_EQ(page_id + 1, page->GetData()[PAGE_SIZE - 1]);
+    EXPECT_EQ(page, bpm.FetchPage(page_id));
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(2 * num_pages, bpm.GetStats().hits_);
+  bpm.PrefetchPage(num_pages - 1);
+
+  // Scenario: pages beyond the file do not exist.
+  EXPECT_EQ(nullptr, bpm.FetchPage(num_pages));
+  EXPECT_EQ(nullptr, bpm.FetchPage(-1));
+
+  // Scenario: nothing can be modified.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id);
+  EXPECT_FALSE(bpm.UnpinPage(0, true));
+  EXPECT_FALSE(bpm.DeletePage(0));
+  EXPECT_FALSE(bpm.DeletePage(num_pages));
+  EXPECT_TRUE(bpm.FlushPage(0));
+  bpm.FlushAllPages();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, CompressedTest) {
+  {
+    DiskManager disk_manager("test.db", DiskManager::Backend::PREAD, false, true);
+    char data[PAGE_SIZE] = {};
+    disk_manager.WritePage(0, data);
+    disk_manager.ShutDown();
+  }
+
+  // Scenario: a compressed database file does not hold its pages where the mapping would look for them.
+  EXPECT_THROW(MmapBufferPoolManager("test.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, TableScanTest) {
+  const int num_rows = 1000;
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 16}}};
+  page_id_t first_page_id;
+  {
+    DiskManager disk_manager("test.db");
+    BufferPoolManagerInstance bpm(10, &disk_manager);
+    first_page_id = CreateTable(&bpm, schema, num_rows);
+    disk_manager.ShutDown();
+  }
+
+  // Scenario: a table written through a buffer pool can be scanned by the execution engine straight from the mapping.
+  MmapBufferPoolManager bpm("test.db");
+  auto result_set = ScanTable(&bpm, schema, first_page_id);
+  ASSERT_EQ(num_rows, result_set.size());
+  for (int i = 0; i < num_rows; i++) {
+    EXPECT_EQ(i, result_set[i].GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ("row " + std::to_string(i), result_set[i].GetValue(&schema, 1).ToString());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, ReadOnlyTableTest) {
+  const int num_rows = 1000;
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 16}}};
+  // Without a free space map, and with one that points at a page that is no map page.
+  for (bool stale_map : {false, true}) {
+    TearDown();
+    page_id_t first_page_id;
+    {
+      DiskManager disk_manager("test.db");
+      BufferPoolManagerInstance bpm(10, &disk_manager);
+      first_page_id = CreateTable(&bpm, schema, num_rows);
+      {
+        auto guard = bpm.FetchPageWrite(first_page_id);
+        static_cast<TablePage *>(guard.GetPage())->SetFreeSpaceMapPageId(stale_map ? first_page_id : INVALID_PAGE_ID);
+        guard.SetDirty();
+      }
+      bpm.FlushAllPages();
+      disk_manager.ShutDown();
+    }
+
+    // Scenario: a table whose free space map has to be rebuilt opens, and the map is kept in memory only.
+    MmapBufferPoolManager bpm("test.db");
+    auto result_set = ScanTable(&bpm, schema, first_page_id);
+    ASSERT_EQ(num_rows, result_set.size());
+    LockManager lock_manager;
+    TableHeap table(&bpm, &lock_manager, nullptr, first_page_id);
+    {
+      auto guard = bpm.FetchPageRead(first_page_id);
+      EXPECT_EQ(stale_map ? first_page_id : INVALID_PAGE_ID,
+                static_cast<TablePage *>(guard.GetPage())->GetFreeSpaceMapPageId());
+    }
+
+    // Scenario: the table can be read, but not modified.
+    Transaction txn(0);
+    Tuple tuple = *table.Begin(&txn);
+    RID rid = tuple.GetRid();
+    EXPECT_TRUE(table.GetTuple(rid, &tuple, &txn));
+    EXPECT_EQ(0, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_FALSE(table.InsertTuple(tuple, &rid, &txn));
+    EXPECT_FALSE(table.MarkDelete(rid, &txn));
+    EXPECT_FALSE(table.UpdateTuple(tuple, rid, &txn));
+    EXPECT_EQ(TransactionState::ABORTED, txn.GetState());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapBufferPoolManagerTest, DISABLED_ScanBenchmark) {
+  const int num_rows = 50000;
+  const int num_scans = 3;
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 16}}};
+  page_id_t first_page_id;
+  {
+    DiskManager disk_manager("test.db");
+    BufferPoolManagerInstance bpm(64, &disk_manager);
+    first_page_id = CreateTable(&bpm, schema, num_rows);
+    disk_manager.ShutDown();
+  }
+
+  // Both scan a file that is in the OS page cache; the buffer pool is smaller than the table, so it copies every page.
+  DiskManager disk_manager("test.db");
+  BufferPoolManagerInstance buffer_pool(64, &disk_manager);
+  MmapBufferPoolManager mapping("test.db");
+  for (auto *bpm : std::vector<BufferPoolManager *>{&buffer_pool, &mapping}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_scans; i++) {
+      EXPECT_EQ(num_rows, ScanTable(bpm, schema, first_page_id).size());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s: %.0f rows/sec\n", bpm == &mapping ? "mmap" : "buffer pool", num_scans * num_rows / elapsed.count());
+  }
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
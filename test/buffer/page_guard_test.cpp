@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/buffer/page_guard_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_guard.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: a new page starts out pinned and dirty, and is unpinned when its guard goes away.
+  page_id_t page_id;
+  Page *page;
+  {
+    auto guard = bpm->NewPageWrite(&page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(page_id, guard.PageId());
+    page = guard.GetPage();
+    EXPECT_EQ(1, page->GetPinCount());
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_FALSE(page->IsDirty());
+
+  // Scenario: reading through a write guard does not dirty the page, changing it does.
+  {
+    auto guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  }
+  EXPECT_FALSE(page->IsDirty());
+  {
+    auto guard = bpm->FetchPageWrite(page_id);
+    guard.AsMut<char>()[0] = 'J';
+  }
+  EXPECT_TRUE(page->IsDirty());
+
+  // Scenario: read guards share the page, and moving a guard moves its pin rather than adding one.
+  {
+    auto guard1 = bpm->FetchPageRead(page_id);
+    auto guard2 = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(guard1.As<char>(), "Jello"));
+    auto guard3 = std::move(guard1);
+    EXPECT_FALSE(guard1.IsValid());  // NOLINT
+    EXPECT_EQ(2, page->GetPinCount());
+    guard2 = std::move(guard3);
+    EXPECT_EQ(1, page->GetPinCount());
+    guard2.Release();
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: when every frame is held by a guard there is no page left, which gives an empty guard. Letting go of
+  // a guard frees its frame.
+  {
+    page_id_t other_page_id;
+    auto guard1 = bpm->FetchPageWrite(page_id);
+    auto guard2 = bpm->NewPageWrite(&other_page_id);
+    ASSERT_TRUE(guard2.IsValid());
+    EXPECT_FALSE(bpm->NewPageWrite(&other_page_id).IsValid());
+    guard2.Release();
+    EXPECT_TRUE(bpm->NewPageWrite(&other_page_id).IsValid());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
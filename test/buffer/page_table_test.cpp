@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::default_random_engine rng(0);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 1000);
+
+  // Scenario: random inserts and erases, keeping the table at most full.
+  for (size_t i = 0; i < 100000; i++) {
+    page_id_t page_id = page_dist(rng);
+    if (expected.count(page_id) != 0) {
+      EXPECT_EQ(expected[page_id], page_table.Find(page_id));
+      page_table.Erase(page_id);
+      expected.erase(page_id);
+    } else if (expected.size() < num_frames) {
+      auto frame_id = static_cast<frame_id_t>(i % num_frames);
+      page_table.Insert(page_id, frame_id);
+      expected[page_id] = frame_id;
+    }
+    EXPECT_EQ(-1, page_table.Find(page_dist(rng) + 2000));
+  }
+  for (page_id_t page_id = 0; page_id <= 1000; page_id++) {
+    EXPECT_EQ(expected.count(page_id) != 0 ? expected[page_id] : -1, page_table.Find(page_id));
+  }
+
+  // Scenario: erasing a page that is not there does nothing.
+  page_table.Erase(5000);
+  EXPECT_EQ(-1, page_table.Find(5000));
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t num_frames = 64;
+  const size_t num_readers = 4;
+  PageTable page_table(num_frames);
+
+  // Page i, if present, is always in frame i % num_frames. Readers may miss a page, but never get a wrong frame.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (size_t thread_itr = 0; thread_itr < num_readers; thread_itr++) {
+    readers.emplace_back([&, thread_itr] {
+      std::default_random_engine rng(thread_itr);
+      std::uniform_int_distribution<page_id_t> page_dist(0, 4 * num_frames);
+      while (!done) {
+        page_id_t page_id = page_dist(rng);
+        auto frame_id = page_table.Find(page_id);
+        EXPECT_TRUE(frame_id == -1 || frame_id == static_cast<frame_id_t>(page_id % num_frames));
+      }
+    });
+  }
+
+  std::default_random_engine rng(num_readers);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 4 * num_frames);
+  std::vector<bool> present(4 * num_frames + 1, false);
+  size_t size = 0;
+  for (size_t i = 0; i < 200000; i++) {
+    page_id_t page_id = page_dist(rng);
+    if (present[page_id]) {
+      page_table.Erase(page_id);
+      present[page_id] = false;
+      size--;
+    } else if (size < num_frames) {
+      page_table.Insert(page_id, static_cast<frame_id_t>(page_id % num_frames));
+      present[page_id] = true;
+      size++;
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
@@ -11,9 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -82,6 +84,7 @@ TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
 
   delete bpm;
   delete disk_manager;
@@ -143,9 +146,82 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
   EXPECT_EQ(nullptr, bpm->FetchPage(4));
 
+  // Scenario: Flushing writes back the dirty pages of every instance.
+  bpm->FlushAllPages();
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_FALSE(page->IsDirty());
+  }
+
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, RoutingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const uint32_t num_instances = 4;
+
+  // Scenario: Every group of num_instances consecutive page ids has one page in every instance, and pages with a
+  // stride of num_instances do not all end up in the same instance.
+  std::vector<size_t> strided(num_instances, 0);
+  for (page_id_t group = 0; group < 1000; ++group) {
+    std::vector<bool> seen(num_instances, false);
+    for (uint32_t i = 0; i < num_instances; ++i) {
+      auto instance = BufferPoolManagerInstance::InstanceOf(group * num_instances + i, num_instances);
+      ASSERT_LT(instance, num_instances);
+      EXPECT_FALSE(seen[instance]);
+      seen[instance] = true;
+    }
+    strided[BufferPoolManagerInstance::InstanceOf(group * num_instances, num_instances)]++;
+  }
+  for (auto count : strided) {
+    EXPECT_GT(count, 1000 / num_instances / 2);
+  }
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: New pages go to the instance with the fewest pinned frames.
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+    std::vector<size_t> num_pinned(num_instances, 0);
+    for (auto pinned_page_id : pinned) {
+      num_pinned[BufferPoolManagerInstance::InstanceOf(pinned_page_id, num_instances)]++;
+    }
+    EXPECT_LE(*std::max_element(num_pinned.begin(), num_pinned.end()) -
+                  *std::min_element(num_pinned.begin(), num_pinned.end()),
+              1);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: Page ids are handed out without gaps, and every page can be found again.
+  std::sort(pinned.begin(), pinned.end());
+  for (size_t i = 0; i < pinned.size(); ++i) {
+    EXPECT_EQ(static_cast<page_id_t>(i), pinned[i]);
+    EXPECT_EQ(true, bpm->UnpinPage(pinned[i], true));
+  }
+  EXPECT_EQ(false, bpm->UnpinPage(pinned[0], false));
+  for (auto pinned_page_id : pinned) {
+    auto *page = bpm->FetchPage(pinned_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(pinned_page_id, page->GetPageId());
+    EXPECT_EQ(true, bpm->UnpinPage(pinned_page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
 
   delete bpm;
   delete disk_manager;
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer_test.cpp
+//
+// Identification: test/buffer/two_q_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+
+#include "buffer/two_q_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TwoQReplacerTest, SampleTest) {
+  // A1in may hold 2 frames, A1out 4 page ids.
+  TwoQReplacer two_q_replacer(8);
+
+  // Scenario: read pages 10 to 13 into frames 0 to 3. Accessing page 10 again does not matter while it is in A1in.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_q_replacer.RecordAccess(frame_id, 10 + frame_id);
+  }
+  two_q_replacer.RecordAccess(0, 10);
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_q_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(4, two_q_replacer.Size());
+
+  // Scenario: evict pages 10 and 11 in FIFO order, they are remembered in A1out.
+  int value;
+  two_q_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  two_q_replacer.Remove(0);
+  two_q_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  two_q_replacer.Remove(1);
+  EXPECT_EQ(2, two_q_replacer.Size());
+
+  // Scenario: page 10 is read in again, into frame 0. It goes to Am. Pages 20 and 21 are read into frames 1 and 4.
+  two_q_replacer.RecordAccess(0, 10);
+  two_q_replacer.RecordAccess(1, 20);
+  two_q_replacer.RecordAccess(4, 21);
+  two_q_replacer.Unpin(0);
+  two_q_replacer.Unpin(1);
+  two_q_replacer.Unpin(4);
+  EXPECT_EQ(5, two_q_replacer.Size());
+
+  // Scenario: as long as A1in holds more than its share, the victims come from A1in, oldest first.
+  two_q_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  two_q_replacer.Remove(2);
+  two_q_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  two_q_replacer.Remove(3);
+
+  // Scenario: now A1in is small enough, Am goes first.
+  two_q_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  two_q_replacer.Remove(0);
+
+  // Scenario: with Am empty, A1in goes.
+  two_q_replacer.Pin(4);
+  two_q_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(two_q_replacer.Victim(&value));
+  EXPECT_EQ(0, two_q_replacer.Size());
+}
+
+}  // namespace bustub
@@ -59,6 +59,7 @@ TEST(CatalogTest, DISABLED_CreateTable1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable2) {
@@ -87,6 +88,7 @@ TEST(CatalogTest, DISABLED_CreateTable2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable3) {
@@ -119,6 +121,7 @@ TEST(CatalogTest, DISABLED_CreateTable3) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 TEST(CatalogTest, DISABLED_CreateTableTest) {
@@ -215,6 +218,7 @@ TEST(CatalogTest, DISABLED_CreateIndex1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Attempts to create an index with duplicate name should fail
@@ -264,6 +268,7 @@ TEST(CatalogTest, DISABLED_CreateIndex2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 TEST(CatalogTest, DISABLED_CreateIndex3) {
@@ -338,6 +343,7 @@ TEST(CatalogTest, DISABLED_QueryIndex1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Vanilla index queries by index OID
@@ -388,6 +394,7 @@ TEST(CatalogTest, DISABLED_QueryIndex2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Query for nonexistent index on table should fail
@@ -410,6 +417,7 @@ TEST(CatalogTest, DISABLED_FailedQuery1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Query for index on nonexistent table should fail
@@ -423,6 +431,7 @@ TEST(CatalogTest, DISABLED_FailedQuery2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Query for nonexistent index OID should throw
@@ -437,6 +446,7 @@ TEST(CatalogTest, DISABLED_FailedQuery3) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Query for all indexes on nonexistent table should give empty collection
@@ -451,6 +461,7 @@ TEST(CatalogTest, DISABLED_FailedQuery4) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Query for all indexes on existing table with no
@@ -475,6 +486,7 @@ TEST(CatalogTest, DISABLED_FailedQuery5) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Should be able to create and interact with an index with a single BIGINT key
@@ -527,6 +539,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction0) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Should be able to create and interact with an index that is keyed by two INTEGER values
@@ -579,6 +592,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 // Should be able to create and interact with an index that is keyed by a single INTEGER column
@@ -631,6 +645,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 TEST(CatalogTest, DISABLED_IndexInteraction3) {
@@ -686,6 +701,70 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.alloc");
+}
+
+// Should be able to create an ordered index over the rows of a table, and interact with it
+TEST(CatalogTest, BPlusTreeIndexInteraction) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  const std::string index_name{"index1"};
+  const int64_t num_rows = 1000;
+
+  // Construct a new table with rows in descending key order
+  std::vector<Column> columns{{"A", TypeId::BIGINT}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  for (int64_t i = num_rows - 1; i >= 0; i--) {
+    RID rid{};
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(i)}, &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  // Index construction should succeed, and index the rows already in the table
+  std::vector<Column> key_columns{{"A", TypeId::BIGINT}};
+  std::vector<uint32_t> key_attrs{0};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), index_name, table_name, table_schema, key_schema, key_attrs, BIGINT_SIZE, BigintHashFunctionType{},
+      IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = dynamic_cast<BPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType> *>(
+      index_info->index_.get());
+  ASSERT_NE(nullptr, index);
+
+  // Point lookups find the row of the key
+  for (int64_t i = 0; i < num_rows; i++) {
+    Tuple key{std::vector<Value>{ValueFactory::GetBigIntValue(i)}, &key_schema};
+    std::vector<RID> results{};
+    index->ScanKey(key, &results, txn.get());
+    ASSERT_EQ(1, results.size());
+    Tuple tuple{};
+    ASSERT_TRUE(table_info->table_->GetTuple(results[0], &tuple, txn.get()));
+    EXPECT_EQ(i, tuple.GetValue(&table_schema, 0).GetAs<int64_t>());
+  }
+
+  // The index keeps the keys in order, and leaves the table alone
+  int64_t expected = 0;
+  for (auto it = index->GetBeginIterator(); it != index->GetEndIterator(); ++it) {
+    EXPECT_EQ(expected, (*it).first.ToValue(&key_schema, 0).GetAs<int64_t>());
+    expected++;
+  }
+  EXPECT_EQ(num_rows, expected);
+  int64_t num_tuples = 0;
+  for (auto it = table_info->table_->Begin(txn.get()); it != table_info->table_->End(); ++it) {
+    num_tuples++;
+  }
+  EXPECT_EQ(num_rows, num_tuples);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  remove("catalog_test.alloc");
 }
 
 }  // namespace bustub
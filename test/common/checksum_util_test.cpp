@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_util_test.cpp
+//
+// Identification: test/common/checksum_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "common/util/checksum_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ChecksumUtilTest, Crc32cTest) {
+  // Scenario: the check values of CRC32C.
+  const char *digits = "123456789";
+  EXPECT_EQ(0xE3069283, ChecksumUtil::Crc32c(digits, strlen(digits)));
+  EXPECT_EQ(0xE3069283, ChecksumUtil::Crc32cSoftware(digits, strlen(digits)));
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8A9136AA, ChecksumUtil::Crc32c(zeros.data(), zeros.size()));
+  EXPECT_EQ(0, ChecksumUtil::Crc32c(digits, 0));
+
+  // Scenario: whatever the length and alignment, the crc32 instruction agrees with the table, and data can be
+  // checksummed in pieces.
+  std::mt19937 generator(0);
+  std::vector<char> data(3 * 4096 + 7);
+  for (auto &byte : data) {
+    byte = static_cast<char>(generator());
+  }
+  for (size_t offset : {0, 1, 5}) {
+    for (size_t length : {1, 7, 8, 100, 4080, 4096, 4097, 3 * 4096}) {
+      auto expected = ChecksumUtil::Crc32cSoftware(data.data() + offset, length);
+      EXPECT_EQ(expected, ChecksumUtil::Crc32c(data.data() + offset, length));
+      auto first = ChecksumUtil::Crc32c(data.data() + offset, length / 3);
+      EXPECT_EQ(expected, ChecksumUtil::Crc32c(data.data() + offset + length / 3, length - length / 3, first));
+    }
+  }
+
+  // Scenario: a single flipped bit changes the checksum.
+  auto checksum = ChecksumUtil::Crc32c(data.data(), 4096);
+  data[1000] ^= 0x10;
+  EXPECT_NE(checksum, ChecksumUtil::Crc32c(data.data(), 4096));
+}
+
+}  // namespace bustub
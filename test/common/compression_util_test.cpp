@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util_test.cpp
+//
+// Identification: test/common/compression_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/compression_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(CompressionUtilTest, SampleTest) {
+  const size_t size = 4096;
+  std::mt19937 generator(0);
+  std::vector<char> zeros(size, 0);
+  std::vector<char> random(size);
+  for (auto &byte : random) {
+    byte = static_cast<char>(generator());
+  }
+  // Rows of small integers and a handful of repeated strings, like a table page.
+  std::vector<char> rows(size, 0);
+  const std::vector<std::string> names{"alice", "bob", "carol", "dave"};
+  for (size_t offset = 0, row = 0; offset + 16 <= size; offset += 16, row++) {
+    auto id = static_cast<int32_t>(row);
+    auto value = static_cast<int32_t>(generator() % 100);
+    memcpy(&rows[offset], &id, sizeof(id));
+    memcpy(&rows[offset + 4], &value, sizeof(value));
+    memcpy(&rows[offset + 8], names[row % names.size()].c_str(), names[row % names.size()].size());
+  }
+
+  // Scenario: whatever the data, it decompresses to what it was. Data with repetitions compresses well.
+  std::vector<char> compressed(2 * size);
+  std::vector<char> decompressed(size);
+  for (const auto *data : {&zeros, &random, &rows}) {
+    auto length = CompressionUtil::Compress(data->data(), size, compressed.data(), compressed.size());
+    ASSERT_NE(0, length);
+    ASSERT_TRUE(CompressionUtil::Decompress(compressed.data(), length, decompressed.data(), size));
+    EXPECT_EQ(0, memcmp(data->data(), decompressed.data(), size));
+    if (data == &zeros) {
+      EXPECT_GT(100, length);
+    }
+    if (data == &rows) {
+      EXPECT_GT(size / 2, length);
+    }
+  }
+  for (size_t length : {0, 1, 12, 13, 100}) {
+    auto compressed_length = CompressionUtil::Compress(rows.data(), length, compressed.data(), compressed.size());
+    ASSERT_NE(0, compressed_length);
+    ASSERT_TRUE(CompressionUtil::Decompress(compressed.data(), compressed_length, decompressed.data(), length));
+    EXPECT_EQ(0, memcmp(rows.data(), decompressed.data(), length));
+  }
+
+  // Scenario: data that does not compress into the room given is refused.
+  EXPECT_EQ(0, CompressionUtil::Compress(random.data(), size, compressed.data(), size - 512));
+
+  // Scenario: damaged or truncated compressed data, or the wrong length, is detected rather than overrunning.
+  auto length = CompressionUtil::Compress(rows.data(), size, compressed.data(), compressed.size());
+  EXPECT_FALSE(CompressionUtil::Decompress(compressed.data(), length - 1, decompressed.data(), size));
+  EXPECT_FALSE(CompressionUtil::Decompress(compressed.data(), length, decompressed.data(), size - 1));
+  for (size_t i = 0; i < length; i++) {
+    auto damaged = compressed;
+    damaged[i] = static_cast<char>(damaged[i] ^ 0xFF);
+    CompressionUtil::Decompress(damaged.data(), length, decompressed.data(), size);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter_test.cpp
+//
+// Identification: test/common/external_sorter_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "common/util/external_sorter.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Sort random numbers with a memory limit. @return the numbers as read back from the sorter */
+std::vector<int64_t> SortRandom(size_t num_records, size_t memory_limit, size_t *num_runs) {
+  std::mt19937_64 generator(0);
+  ExternalSorter<int64_t, std::less<>> sorter(memory_limit, std::less<>());
+  for (size_t i = 0; i < num_records; i++) {
+    sorter.Add(static_cast<int64_t>(generator() % 1000));
+  }
+  sorter.Sort();
+  *num_runs = sorter.GetNumRuns();
+  std::vector<int64_t> result;
+  int64_t record;
+  while (sorter.Next(&record)) {
+    result.push_back(record);
+  }
+  EXPECT_FALSE(sorter.Next(&record));
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ExternalSorterTest, InMemoryTest) {
+  size_t num_runs;
+  // Scenario: records that fit in memory are not written anywhere.
+  auto result = SortRandom(1000, 1000 * sizeof(int64_t), &num_runs);
+  EXPECT_EQ(0, num_runs);
+  EXPECT_EQ(1000, result.size());
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end()));
+
+  // Scenario: nothing to sort.
+  EXPECT_TRUE(SortRandom(0, 1024, &num_runs).empty());
+}
+
+// NOLINTNEXTLINE
+TEST(ExternalSorterTest, SpillTest) {
+  size_t num_runs;
+  // Scenario: records that do not fit in memory are sorted in runs and merged, the last run being partial.
+  auto result = SortRandom(10050, 100 * sizeof(int64_t), &num_runs);
+  EXPECT_EQ(101, num_runs);
+  EXPECT_EQ(10050, result.size());
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end()));
+
+  // Scenario: the same numbers as an in-memory sort.
+  auto expected = SortRandom(10050, 10050 * sizeof(int64_t), &num_runs);
+  EXPECT_EQ(expected, result);
+}
+
+}  // namespace bustub
@@ -52,6 +52,7 @@ TEST(HashTablePageTest, DirectoryPageSampleTest) {
   bpm->UnpinPage(directory_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
   delete disk_manager;
   delete bpm;
 }
@@ -110,6 +111,7 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   bpm->UnpinPage(bucket_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
   delete disk_manager;
   delete bpm;
 }
@@ -113,6 +113,7 @@ TEST(HashTableTest, SampleTest) {
 
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.alloc");
   delete disk_manager;
   delete bpm;
 }
@@ -31,6 +31,7 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
@@ -46,6 +47,7 @@
  * particular, the tests in this file include:
  *
  * - Sequential Scan
+ * - Index Scan
  * - Insert (Raw)
  * - Insert (Select)
  * - Update
@@ -110,6 +112,51 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
   }
 }
 
+// SELECT colA, colB FROM test_1 WHERE colA BETWEEN 100 AND 199 AND colB < 5 ORDER BY colA (DESC), through an index
+TEST_F(ExecutorTest, SimpleIndexScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a integer");
+  ComparatorType comparator{key_schema.get()};
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE);
+
+  // Construct query plans
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(col_b, const5, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  Tuple low_key{{ValueFactory::GetIntegerValue(100)}, key_schema.get()};
+  Tuple high_key{{ValueFactory::GetIntegerValue(199)}, key_schema.get()};
+  IndexScanPlanNode forward_plan{out_schema, predicate, index_info->index_oid_, low_key, high_key};
+  IndexScanPlanNode backward_plan{out_schema, nullptr, index_info->index_oid_, std::nullopt, high_key,
+                                  ScanDirection::BACKWARD};
+
+  // Execute
+  std::vector<Tuple> forward_result_set{};
+  GetExecutionEngine()->Execute(&forward_plan, &forward_result_set, GetTxn(), GetExecutorContext());
+  std::vector<Tuple> backward_result_set{};
+  GetExecutionEngine()->Execute(&backward_plan, &backward_result_set, GetTxn(), GetExecutorContext());
+
+  // Verify: keys in range and in order, and the predicate holds
+  ASSERT_FALSE(forward_result_set.empty());
+  int32_t last_key = 99;
+  for (const auto &tuple : forward_result_set) {
+    auto key = tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_LT(last_key, key);
+    ASSERT_LE(key, 199);
+    ASSERT_TRUE(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() < 5);
+    last_key = key;
+  }
+  ASSERT_EQ(backward_result_set.size(), 200);
+  for (auto i = 0UL; i < backward_result_set.size(); ++i) {
+    auto &tuple = backward_result_set[i];
+    ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(),
+              static_cast<int32_t>(199 - i));
+  }
+}
+
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
 TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // Create Values to insert
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_engine_test.cpp
+//
+// Identification: test/storage/async_io_engine_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/io_uring_engine.h"
+#include "storage/disk/thread_pool_io_engine.h"
+
+namespace bustub {
+
+namespace {
+
+/** Write num_blocks blocks with one engine, read them back with the same engine, and check what came back. */
+void ReadWriteBlocks(std::unique_ptr<AsyncIoEngine> engine, size_t num_blocks) {
+  const size_t block_size = 4096;
+  int fd = open("test.db", O_RDWR | O_CREAT | O_TRUNC, 0644);
+  ASSERT_NE(-1, fd);
+
+  std::vector<char> data(num_blocks * block_size);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i % 253);
+  }
+  std::atomic<size_t> num_written{0};
+  for (size_t i = 0; i < num_blocks; i++) {
+    engine->Submit({IoRequest::Type::WRITE, fd, i * block_size, &data[i * block_size], block_size,
+                    [&num_written](ssize_t result) {
+                      EXPECT_EQ(static_cast<ssize_t>(block_size), result);
+                      num_written++;
+                    }});
+  }
+  while (num_written != num_blocks) {
+    std::this_thread::yield();
+  }
+
+  // Reading past the end of the file comes back short.
+  std::vector<char> buf((num_blocks + 1) * block_size);
+  std::atomic<size_t> num_read{0};
+  for (size_t i = 0; i <= num_blocks; i++) {
+    engine->Submit({IoRequest::Type::READ, fd, i * block_size, &buf[i * block_size], block_size,
+                    [&num_read, i, num_blocks](ssize_t result) {
+                      EXPECT_EQ(i < num_blocks ? static_cast<ssize_t>(block_size) : 0, result);
+                      num_read++;
+                    }});
+  }
+  // Destroying the engine completes everything that was submitted.
+  engine.reset();
+  EXPECT_EQ(num_blocks + 1, num_read);
+  EXPECT_EQ(0, memcmp(data.data(), buf.data(), data.size()));
+
+  close(fd);
+  remove("test.db");
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(AsyncIoEngineTest, ThreadPoolReadWriteTest) { ReadWriteBlocks(std::make_unique<ThreadPoolIoEngine>(4), 200); }
+
+// NOLINTNEXTLINE
+TEST(AsyncIoEngineTest, IoUringReadWriteTest) {
+  auto engine = IoUringEngine::Create(8);
+  if (engine == nullptr) {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  // More blocks than ring entries, so that submissions have to wait for completions.
+  ReadWriteBlocks(std::move(engine), 200);
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIoEngineTest, IdleShutdownTest) {
+  // Engines that never did anything shut down cleanly.
+  ThreadPoolIoEngine thread_pool_engine(2);
+  auto engine = AsyncIoEngine::Create(8);
+  ASSERT_NE(nullptr, engine);
+}
+
+}  // namespace bustub
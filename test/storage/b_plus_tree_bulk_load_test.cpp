@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using Pair = std::pair<GenericKey<8>, RID>;
+
+/** Bulk load keys, in the order given. */
+void BulkLoadKeys(Tree *tree, const std::vector<int64_t> &keys, float fill_factor) {
+  size_t next = 0;
+  tree->BulkLoad(
+      [&keys, &next](Pair *pair) {
+        if (next == keys.size()) {
+          return false;
+        }
+        pair->first.SetFromInteger(keys[next]);
+        pair->second.Set(static_cast<int32_t>(keys[next] >> 32), static_cast<uint32_t>(keys[next]));
+        next++;
+        return true;
+      },
+      fill_factor);
+}
+
+/** Check that the tree holds exactly the keys 1 to num_keys. */
+void CheckKeys(Tree *tree, int64_t num_keys) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree->GetValue(index_key, &rids));
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key++;
+  }
+  EXPECT_EQ(num_keys + 1, current_key);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const size_t pool_size = 32;
+  // Node counts that fill one leaf, overflow it by one, and fill several levels; the last node of each level is
+  // short of half full for some of them.
+  for (int64_t num_keys : {1, 2, 3, 4, 5, 9, 17, 100, 1000, 2001}) {
+    for (float fill_factor : {0.5F, 0.7F, 1.0F}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+      Tree tree("foo_pk", bpm, comparator, 4, 4);
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+
+      std::vector<int64_t> keys;
+      for (int64_t key = 1; key <= num_keys; key++) {
+        keys.push_back(key);
+        // Scenario: keys that do not increase are skipped.
+        keys.push_back(key);
+      }
+      BulkLoadKeys(&tree, keys, fill_factor);
+      // Scenario: no page is left pinned, only the header page.
+      std::vector<page_id_t> page_ids(pool_size - 1);
+      for (auto &new_page_id : page_ids) {
+        EXPECT_NE(nullptr, bpm->NewPage(&new_page_id));
+      }
+      for (auto new_page_id : page_ids) {
+        bpm->UnpinPage(new_page_id, false);
+        bpm->DeletePage(new_page_id);
+      }
+      CheckKeys(&tree, num_keys);
+
+      // Scenario: the loaded tree splits and merges like any other.
+      GenericKey<8> index_key;
+      RID rid;
+      for (int64_t key = num_keys + 1; key <= 2 * num_keys; key++) {
+        index_key.SetFromInteger(key);
+        rid.Set(0, key);
+        EXPECT_TRUE(tree.Insert(index_key, rid));
+      }
+      CheckKeys(&tree, 2 * num_keys);
+      for (int64_t key = 1; key <= 2 * num_keys; key++) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      EXPECT_TRUE(tree.IsEmpty());
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete disk_manager;
+      delete bpm;
+      remove("test.db");
+      remove("test.log");
+      remove("test.alloc");
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, NonEmptyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // Scenario: loading into a tree that is not empty inserts the pairs one at a time, in any order.
+  BulkLoadKeys(&tree, {1, 3, 5}, 1.0F);
+  BulkLoadKeys(&tree, {6, 2, 4}, 1.0F);
+  CheckKeys(&tree, 6);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, FailureTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const size_t pool_size = 4;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+
+  // Scenario: a tree too deep for the buffer pool, which pins one page per level, fails to load.
+  EXPECT_THROW(BulkLoadKeys(&tree, keys, 1.0F), Exception);
+  // Scenario: so does a load whose pairs fail to come.
+  size_t next = 0;
+  auto next_pair = [&next](Pair *pair) {
+    if (++next == 10) {
+      throw Exception("can't read the next pair");
+    }
+    pair->first.SetFromInteger(next);
+    pair->second.Set(0, next);
+    return true;
+  };
+  EXPECT_THROW(tree.BulkLoad(next_pair, 1.0F), Exception);
+
+  // Scenario: a failed load leaves the tree empty, unlatched, and with none of its pages pinned.
+  EXPECT_TRUE(tree.IsEmpty());
+  std::vector<page_id_t> page_ids(pool_size - 1);
+  for (auto &new_page_id : page_ids) {
+    EXPECT_NE(nullptr, bpm->NewPage(&new_page_id));
+  }
+  for (auto new_page_id : page_ids) {
+    bpm->UnpinPage(new_page_id, false);
+    bpm->DeletePage(new_page_id);
+  }
+  keys.resize(9);
+  BulkLoadKeys(&tree, keys, 1.0F);
+  CheckKeys(&tree, 9);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, DISABLED_BulkLoadBenchmark) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 200000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    keys.push_back(key);
+  }
+
+  for (bool bulk_load : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    Tree tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+
+    auto start = std::chrono::steady_clock::now();
+    if (bulk_load) {
+      BulkLoadKeys(&tree, keys, 1.0F);
+    } else {
+      GenericKey<8> index_key;
+      RID rid;
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        rid.Set(0, key);
+        tree.Insert(index_key, rid);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int num_writes = disk_manager->GetNumWrites();
+    printf("%s: %.0f keys/sec, %d page writes\n", bulk_load ? "bulk load" : "insert", num_keys / elapsed.count(),
+           num_writes);
+    CheckKeys(&tree, num_keys);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+    remove("test.alloc");
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -100,7 +101,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -150,9 +151,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -201,9 +203,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -243,9 +246,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -286,9 +290,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -331,6 +336,133 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
+}
+
+TEST(BPlusTreeConcurrentTest, SplitMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // create b+ tree with small nodes, so that most inserts and removes split or merge
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int num_threads = 4;
+  std::vector<int64_t> keys;
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    keys.push_back(key);
+    if (key % 2 == 1) {
+      remove_keys.push_back(key);
+    }
+  }
+
+  // Scenario: readers scan the tree while it grows and shrinks, and always see keys in order.
+  std::atomic<bool> done{false};
+  auto scan = [&tree, &done]() {
+    while (!done) {
+      int64_t last_key = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        EXPECT_LT(last_key, key);
+        last_key = key;
+      }
+    }
+  };
+  std::thread scanner(scan);
+  LaunchParallelTest(num_threads, InsertHelperSplit, &tree, keys, num_threads);
+  LaunchParallelTest(num_threads, DeleteHelperSplit, &tree, remove_keys, num_threads);
+  done = true;
+  scanner.join();
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids));
+  }
+  int64_t current_key = 2;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key = current_key + 2;
+  }
+  EXPECT_EQ(current_key, keys.size() + 2);
+
+  // Scenario: removing every key leaves an empty tree, which can grow again.
+  std::vector<int64_t> even_keys;
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      even_keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(num_threads, DeleteHelperSplit, &tree, even_keys, num_threads);
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin() == tree.End());
+  InsertHelper(&tree, {42});
+  EXPECT_FALSE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+TEST(BPlusTreeConcurrentTest, DISABLED_MixBenchmark) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 10000;
+  const int num_ops = 40000;
+
+  // Every run preloads the even keys, then its threads split num_ops between inserting odd keys and looking up even
+  // ones, half and half.
+  for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+    DiskManager disk_manager("test.db");
+    BufferPoolManagerInstance bpm(1024, &disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", &bpm, comparator);
+    page_id_t page_id;
+    bpm.NewPage(&page_id);
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; key += 2) {
+      keys.push_back(key);
+    }
+    InsertHelper(&tree, keys);
+
+    auto mix = [&tree, num_threads, num_ops, num_keys](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      int64_t key = static_cast<int64_t>(thread_itr) * 2 + 1;
+      for (int i = 0; i < num_ops / num_threads; i++) {
+        if (i % 2 == 0) {
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, RID(static_cast<int32_t>(key)));
+          key += 2 * num_threads;
+        } else {
+          index_key.SetFromInteger((i * 7919LL) % num_keys / 2 * 2);
+          rids.clear();
+          EXPECT_TRUE(tree.GetValue(index_key, &rids));
+        }
+      }
+    };
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, mix);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%2d threads: %.0f ops/sec\n", num_threads, num_ops / elapsed.count());
+
+    bpm.UnpinPage(HEADER_PAGE_ID, true);
+    disk_manager.ShutDown();
+    remove("test.db");
+    remove("test.log");
+    remove("test.alloc");
+  }
 }
 
 }  // namespace bustub
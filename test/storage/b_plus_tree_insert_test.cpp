@@ -11,16 +11,24 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -76,9 +84,10 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -144,5 +153,181 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   delete bpm;
   remove("test.db");
   remove("test.log");
+  remove("test.alloc");
+}
+
+TEST(BPlusTreeTests, IntegerKeyTest) {
+  // Scenario: keys of a single integer column are searched as integers, negative ones included.
+  for (const char *type : {"tinyint", "smallint", "integer", "bigint"}) {
+    auto key_schema = ParseCreateStatement(std::string("a ") + type);
+    GenericComparator<8> comparator(key_schema.get());
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+
+    // Even keys from -126 to 126, which fit in any integer type.
+    std::vector<int64_t> keys;
+    for (int64_t key = -126; key <= 126; key += 2) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    GenericKey<8> index_key;
+    RID rid;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      rid.Set(0, key + 128);
+      EXPECT_TRUE(tree.Insert(index_key, rid));
+    }
+
+    std::vector<RID> rids;
+    for (int64_t key = -127; key <= 127; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids)) << type << " " << key;
+      if (key % 2 == 0) {
+        EXPECT_EQ(key + 128, rids[0].GetSlotNum());
+      }
+    }
+    for (int64_t start_key : {int64_t{-127}, int64_t{-3}, int64_t{0}, int64_t{125}, int64_t{127}}) {
+      int64_t current_key = start_key + (start_key % 2 == 0 ? 0 : 1);
+      index_key.SetFromInteger(start_key);
+      for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+        EXPECT_EQ(current_key + 128, (*iterator).second.GetSlotNum());
+        current_key += 2;
+      }
+      EXPECT_EQ(128, current_key) << type << " " << start_key;
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+    remove("test.alloc");
+  }
+
+  // Scenario: the extremes of the key type bound the search.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  std::vector<int64_t> values{std::numeric_limits<int64_t>::min(), -1, 0, std::numeric_limits<int64_t>::max()};
+  std::vector<GenericKey<8>> keys(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    keys[i].SetFromInteger(values[i]);
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(i, comparator.LowerBound(keys.data(), sizeof(GenericKey<8>), keys.size(), keys[i]));
+    EXPECT_EQ(i + 1, comparator.LowerBound(keys.data(), sizeof(GenericKey<8>), keys.size(), keys[i], true));
+  }
+  EXPECT_EQ(0, comparator.LowerBound(keys.data(), sizeof(GenericKey<8>), 0, keys[0]));
+}
+
+TEST(BPlusTreeTests, HeaderPageFetchFailureTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(2, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  bpm->NewPage(&page_id);
+
+  // Scenario: the new root takes the last frame, so the header page can not be fetched to record it.
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(1);
+  RID rid(0, 1);
+  EXPECT_THROW(tree.Insert(index_key, rid), Exception);
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+TEST(BPlusTreeTests, PageSizeMismatchTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto *header_page = static_cast<HeaderPage *>(bpm->NewPage(&page_id));
+  header_page->Init();
+
+  // Scenario: the header page of a database file created with other pages than this build's is refused.
+  int other_page_size = PAGE_SIZE * 2;
+  memcpy(header_page->GetData() + 4092, &other_page_size, sizeof(other_page_size));
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(1);
+  RID rid(0, 1);
+  EXPECT_THROW(tree.Insert(index_key, rid), Exception);
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+TEST(BPlusTreeTests, DISABLED_LookupBenchmark) {
+  const int num_keys = 50000;
+  const int num_lookups = 200000;
+  std::vector<int64_t> lookups(num_lookups);
+  std::mt19937 generator(15445);
+  for (auto &key : lookups) {
+    key = generator() % num_keys;
+  }
+
+  // Both keys take 8 bytes, so both trees have the same shape; only bigint keys are searched as integers.
+  for (const char *type : {"double", "bigint"}) {
+    auto key_schema = ParseCreateStatement(std::string("a ") + type);
+    GenericComparator<8> comparator(key_schema.get());
+    auto make_key = [&](int64_t key) {
+      bool is_integer = std::string(type) == "bigint";
+      Value value = is_integer ? ValueFactory::GetBigIntValue(key) : ValueFactory::GetDecimalValue(key);
+      GenericKey<8> index_key;
+      index_key.SetFromKey(Tuple({value}, key_schema.get()));
+      return index_key;
+    };
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    RID rid;
+    for (int64_t key = 0; key < num_keys; key++) {
+      rid.Set(0, key);
+      tree.Insert(make_key(key), rid);
+    }
+    std::vector<GenericKey<8>> index_keys;
+    for (auto key : lookups) {
+      index_keys.push_back(make_key(key));
+    }
+
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &index_key : index_keys) {
+      rids.clear();
+      tree.GetValue(index_key, &rids);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s keys: %.0f lookups/sec\n", type, num_lookups / elapsed.count());
+    for (int i = 0; i < 100; i++) {
+      rids.clear();
+      EXPECT_TRUE(tree.GetValue(index_keys[i], &rids));
+      EXPECT_EQ(lookups[i], rids[0].GetSlotNum());
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+    remove("test.alloc");
+  }
 }
 }  // namespace bustub
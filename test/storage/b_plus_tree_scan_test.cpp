@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_scan_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/**
+ * Scan a tree a batch at a time.
+ * @param start the key to start at, or 0 to start at the first or last key
+ * @param remove whether to remove the keys of each batch from the tree before getting the next one
+ * @return the keys, in scan order
+ */
+std::vector<int64_t> Scan(Tree *tree, int64_t start, bool exclusive, bool forward, bool remove) {
+  Tree::ScanCursor cursor;
+  if (start != 0) {
+    cursor.key_.emplace();
+    cursor.key_->SetFromInteger(start);
+    cursor.exclusive_ = exclusive;
+  }
+  std::vector<int64_t> keys;
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  while (!cursor.done_) {
+    batch.clear();
+    tree->ScanBatch(&cursor, forward, 5, &batch);
+    for (const auto &pair : batch) {
+      keys.push_back(pair.second.GetSlotNum());
+      if (remove) {
+        tree->Remove(pair.first);
+      }
+    }
+  }
+  return keys;
+}
+
+/** @return the even keys from first to last, in either order */
+std::vector<int64_t> EvenKeys(int64_t first, int64_t last) {
+  std::vector<int64_t> keys;
+  for (int64_t key = first; first <= last ? key <= last : key >= last; key += first <= last ? 2 : -2) {
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeScanTest, ScanBatchTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // Scenario: an empty tree has nothing to scan.
+  EXPECT_TRUE(Scan(&tree, 0, false, true, false).empty());
+  EXPECT_TRUE(Scan(&tree, 0, false, false, false).empty());
+
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 2; key <= 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    tree.Insert(index_key, rid);
+  }
+
+  // Scenario: scans cover the whole tree, in either direction.
+  EXPECT_EQ(EvenKeys(2, 1000), Scan(&tree, 0, false, true, false));
+  EXPECT_EQ(EvenKeys(1000, 2), Scan(&tree, 0, false, false, false));
+
+  // Scenario: scans start at a key, whether it is in the tree or not, and leave it out if asked.
+  EXPECT_EQ(EvenKeys(500, 1000), Scan(&tree, 500, false, true, false));
+  EXPECT_EQ(EvenKeys(502, 1000), Scan(&tree, 500, true, true, false));
+  EXPECT_EQ(EvenKeys(502, 1000), Scan(&tree, 501, false, true, false));
+  EXPECT_EQ(EvenKeys(500, 2), Scan(&tree, 500, false, false, false));
+  EXPECT_EQ(EvenKeys(498, 2), Scan(&tree, 500, true, false, false));
+  EXPECT_EQ(EvenKeys(500, 2), Scan(&tree, 501, true, false, false));
+  EXPECT_TRUE(Scan(&tree, 1001, false, true, false).empty());
+  EXPECT_TRUE(Scan(&tree, 2, true, false, false).empty());
+
+  // Scenario: the tree can be modified between batches, which an iterator would block. Removing the keys scanned so
+  // far merges the leaves the scan has left behind.
+  EXPECT_EQ(EvenKeys(500, 1000), Scan(&tree, 500, false, true, true));
+  EXPECT_EQ(EvenKeys(498, 2), Scan(&tree, 0, false, false, true));
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+}  // namespace bustub
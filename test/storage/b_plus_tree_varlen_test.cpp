@@ -0,0 +1,288 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_varlen_test.cpp
+//
+// Identification: test/storage/b_plus_tree_varlen_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<VarlenKey<64>, RID, VarlenComparator<64>>;
+using Pair = std::pair<VarlenKey<64>, RID>;
+
+// Leaf and internal pages that hold 4 keys of 64 bytes, so that trees of short keys are still a few levels deep.
+const int small_leaf_max_size = 4 * (2 * sizeof(uint16_t) + 64 + sizeof(RID));
+const int small_internal_max_size = 4 * (2 * sizeof(uint16_t) + 64 + sizeof(page_id_t));
+
+/** Keys that share prefixes of all lengths, with a few that share nothing with the others. */
+std::vector<std::string> MakeKeys(int num_keys) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < num_keys; i++) {
+    char key[64];
+    switch (i % 4) {
+      case 0:
+        snprintf(key, sizeof(key), "customers/%06d", i);
+        break;
+      case 1:
+        snprintf(key, sizeof(key), "customers/%06d/orders/%d", i - 1, i);
+        break;
+      case 2:
+        snprintf(key, sizeof(key), "%c%d", 'a' + i % 26, i);
+        break;
+      default:
+        snprintf(key, sizeof(key), "products/%d", i);
+    }
+    keys.emplace_back(key);
+  }
+  return keys;
+}
+
+/** Check that the tree holds exactly keys, and that the i-th one maps to slot i. */
+void CheckKeys(Tree *tree, const std::vector<std::string> &keys, const std::vector<bool> &present) {
+  VarlenKey<64> index_key;
+  std::vector<RID> rids;
+  std::vector<std::string> sorted_keys;
+  for (size_t i = 0; i < keys.size(); i++) {
+    rids.clear();
+    index_key.SetFromString(keys[i]);
+    EXPECT_EQ(present[i], tree->GetValue(index_key, &rids)) << keys[i];
+    if (present[i]) {
+      EXPECT_EQ(i, rids[0].GetSlotNum());
+      sorted_keys.push_back(keys[i]);
+    }
+  }
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+  size_t current = 0;
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+    ASSERT_LT(current, sorted_keys.size());
+    const VarlenKey<64> &key = (*iterator).first;
+    EXPECT_EQ(sorted_keys[current], std::string(key.GetData() + 1, key.GetSize() - 1));
+    EXPECT_EQ(keys[(*iterator).second.GetSlotNum()], sorted_keys[current]);
+    current++;
+  }
+  EXPECT_EQ(sorted_keys.size(), current);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenTest, KeyEncodingTest) {
+  auto key_schema = ParseCreateStatement("a integer,b varchar(16),c bigint");
+  std::vector<std::vector<Value>> rows;
+  for (int32_t a : {-1000, -1, 0, 1, 1000}) {
+    for (const std::string &b : std::vector<std::string>{"", "a", std::string("a\0", 2), "ab", "b"}) {
+      for (int64_t c : {INT64_MIN + 1, int64_t{-1}, int64_t{0}, int64_t{1} << 40}) {
+        rows.push_back(
+            {ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b), ValueFactory::GetBigIntValue(c)});
+      }
+    }
+  }
+
+  // Scenario: keys compare by their bytes as their tuples compare column by column, rows being built in order.
+  VarlenComparator<64> comparator(key_schema.get());
+  VarlenKey<64> prev_key;
+  for (size_t i = 0; i < rows.size(); i++) {
+    VarlenKey<64> key;
+    key.SetFromKey(Tuple(rows[i], key_schema.get()), *key_schema);
+    if (i > 0) {
+      EXPECT_LT(comparator(prev_key, key), 0) << prev_key << " " << key;
+      EXPECT_GT(comparator(key, prev_key), 0);
+    }
+    EXPECT_EQ(0, comparator(key, key));
+    prev_key = key;
+  }
+
+  // Scenario: keys longer than KeySize can not be indexed.
+  VarlenKey<16> short_key;
+  EXPECT_THROW(short_key.SetFromString(std::string(16, 'x')), Exception);
+  short_key.SetFromString(std::string(15, 'x'));
+  EXPECT_EQ(16, short_key.GetSize());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenTest, InsertRemoveTest) {
+  auto key_schema = ParseCreateStatement("a varchar(64)");
+  VarlenComparator<64> comparator(key_schema.get());
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, small_leaf_max_size, small_internal_max_size);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  std::vector<std::string> keys = MakeKeys(2000);
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::mt19937 generator(15445);
+  std::shuffle(order.begin(), order.end(), generator);
+
+  // Scenario: keys of any length, inserted in any order, split pages whose prefix they do not start with.
+  VarlenKey<64> index_key;
+  RID rid;
+  std::vector<bool> present(keys.size(), true);
+  for (auto i : order) {
+    index_key.SetFromString(keys[i]);
+    rid.Set(0, i);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  CheckKeys(&tree, keys, present);
+  index_key.SetFromString(keys[0]);
+  EXPECT_FALSE(tree.Insert(index_key, rid));
+
+  // Scenario: removing keys merges and redistributes pages, and changes their prefixes.
+  std::shuffle(order.begin(), order.end(), generator);
+  for (size_t j = 0; j < order.size() / 2; j++) {
+    index_key.SetFromString(keys[order[j]]);
+    tree.Remove(index_key);
+    present[order[j]] = false;
+  }
+  CheckKeys(&tree, keys, present);
+  for (size_t j = order.size() / 2; j < order.size(); j++) {
+    index_key.SetFromString(keys[order[j]]);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.alloc");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a varchar(64)");
+  VarlenComparator<64> comparator(key_schema.get());
+  std::vector<std::string> keys = MakeKeys(1000);
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&keys](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
+
+  for (float fill_factor : {0.5F, 1.0F}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, small_leaf_max_size, small_internal_max_size);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+
+    // Scenario: bulk loading fills pages by bytes, and the loaded tree splits and merges like any other.
+    size_t next = 0;
+    tree.BulkLoad(
+        [&](Pair *pair) {
+          if (next == order.size() / 2) {
+            return false;
+          }
+          pair->first.SetFromString(keys[order[next]]);
+          pair->second.Set(0, order[next]);
+          next += 1;
+          return true;
+        },
+        fill_factor);
+    std::vector<bool> present(keys.size(), false);
+    for (size_t j = 0; j < order.size() / 2; j++) {
+      present[order[j]] = true;
+    }
+    CheckKeys(&tree, keys, present);
+
+    VarlenKey<64> index_key;
+    RID rid;
+    for (size_t j = order.size() / 2; j < order.size(); j++) {
+      index_key.SetFromString(keys[order[j]]);
+      rid.Set(0, order[j]);
+      EXPECT_TRUE(tree.Insert(index_key, rid));
+      present[order[j]] = true;
+    }
+    CheckKeys(&tree, keys, present);
+    for (const auto &key : keys) {
+      index_key.SetFromString(key);
+      tree.Remove(index_key);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+    remove("test.alloc");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenTest, DISABLED_FanOutBenchmark) {
+  auto key_schema = ParseCreateStatement("a varchar(40)");
+  const int num_keys = 100000;
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < num_keys; i++) {
+    char key[64];
+    snprintf(key, sizeof(key), "user%08d@example.com", i * 7919 % num_keys);
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetVarcharValue(key)}, key_schema.get());
+  }
+
+  // Both trees take the same string keys, of 24 characters; GenericKey pads them to 64 bytes.
+  page_id_t num_pages[2];
+  for (bool varlen : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    RID rid;
+    if (varlen) {
+      VarlenComparator<64> comparator(key_schema.get());
+      Tree tree("foo_pk", bpm, comparator);
+      VarlenKey<64> index_key;
+      for (int i = 0; i < num_keys; i++) {
+        index_key.SetFromKey(tuples[i], *key_schema);
+        rid.Set(0, i);
+        EXPECT_TRUE(tree.Insert(index_key, rid));
+      }
+    } else {
+      GenericComparator<64> comparator(key_schema.get());
+      BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm, comparator);
+      GenericKey<64> index_key;
+      for (int i = 0; i < num_keys; i++) {
+        index_key.SetFromKey(tuples[i], *key_schema);
+        rid.Set(0, i);
+        EXPECT_TRUE(tree.Insert(index_key, rid));
+      }
+    }
+    // Page ids are handed out in order, and no page is deleted.
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    bpm->NewPage(&num_pages[varlen ? 1 : 0]);
+    printf("%s: %d pages, %.1f keys per page\n", varlen ? "VarlenKey<64>" : "GenericKey<64>", num_pages[varlen ? 1 : 0],
+           static_cast<double>(num_keys) / num_pages[varlen ? 1 : 0]);
+
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+    remove("test.alloc");
+  }
+  EXPECT_GE(num_pages[0], 2 * num_pages[1]);
+}
+
+}  // namespace bustub
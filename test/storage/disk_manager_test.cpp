@@ -10,9 +10,22 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <future>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
+#include "common/util/checksum_util.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 
@@ -24,37 +37,562 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.alloc");
+    remove("test.crc");
+    remove("test.map");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.alloc");
+    remove("test.crc");
+    remove("test.map");
   };
 };
 
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWritePageTest) {
-  char buf[PAGE_SIZE] = {0};
-  char data[PAGE_SIZE] = {0};
+  for (auto backend :
+       {DiskManager::Backend::FSTREAM, DiskManager::Backend::PREAD, DiskManager::Backend::PREAD_DIRECT}) {
+    remove("test.db");
+    char buf[PAGE_SIZE] = {0};
+    char data[PAGE_SIZE] = {0};
+    std::string db_file("test.db");
+    auto dm = DiskManager(db_file, backend);
+    std::strncpy(data, "A test string.", sizeof(data));
+
+    dm.ReadPage(0, buf);  // tolerate empty read
+    int reads = dm.GetNumReads();
+
+    dm.WritePage(0, data);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+    std::memset(buf, 0, sizeof(buf));
+    dm.WritePage(5, data);
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_EQ(reads + 2, dm.GetNumReads());
+
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReopenTest) {
+  // Pages written by one backend can be read by another, and reads of holes and of pages past the end are all zeros.
+  alignas(PAGE_SIZE) char buf[PAGE_SIZE] = {0};
+  alignas(PAGE_SIZE) char data[PAGE_SIZE] = {0};
+  alignas(PAGE_SIZE) char zeros[PAGE_SIZE] = {0};
   std::string db_file("test.db");
-  auto dm = DiskManager(db_file);
   std::strncpy(data, "A test string.", sizeof(data));
+  {
+    auto dm = DiskManager(db_file, DiskManager::Backend::PREAD_DIRECT);
+    dm.WritePage(3, data);
+    dm.ShutDown();
+  }
+  for (auto backend : {DiskManager::Backend::PREAD, DiskManager::Backend::PREAD_DIRECT}) {
+    auto dm = DiskManager(db_file, backend);
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(1, buf);
+    EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(10, buf);
+    EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+}
 
-  dm.ReadPage(0, buf);  // tolerate empty read
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LegacyFileTest) {
+  // Scenario: a database file written before any of the files next to it existed opens, with all of its pages in use.
+  char data[PAGE_SIZE];
+  std::memset(data, 'x', sizeof(data));
+  int fd = open("test.db", O_WRONLY | O_CREAT, 0644);
+  ASSERT_NE(-1, fd);
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    ASSERT_EQ(PAGE_SIZE, pwrite(fd, data, PAGE_SIZE, page_id * PAGE_SIZE));
+  }
+  close(fd);
+  auto dm = DiskManager("test.db");
+  EXPECT_EQ(4, dm.GetNumAllocatedPages());
+  EXPECT_EQ(4, dm.AllocatePage());
+  char buf[PAGE_SIZE];
+  EXPECT_TRUE(dm.ReadPage(3, buf));
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  dm.ShutDown();
+}
 
-  dm.WritePage(0, data);
-  dm.ReadPage(0, buf);
-  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  // A run of pages lands where the pages would have landed one by one, whether or not the pages are aligned.
+  const size_t num_pages = 5;
+  for (auto backend :
+       {DiskManager::Backend::FSTREAM, DiskManager::Backend::PREAD, DiskManager::Backend::PREAD_DIRECT}) {
+    for (size_t misalignment : {0, 1}) {
+      remove("test.db");
+      auto dm = DiskManager("test.db", backend);
+      auto *data = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, (num_pages + 1) * PAGE_SIZE));
+      std::vector<const char *> pages;
+      for (size_t i = 0; i < num_pages; i++) {
+        char *page_data = data + i * PAGE_SIZE + (i == num_pages - 1 ? misalignment : 0);
+        std::memset(page_data, static_cast<int>('a' + i), PAGE_SIZE);
+        pages.push_back(page_data);
+      }
+      int writes = dm.GetNumWrites();
+      dm.WritePages(2, pages);
+      dm.SyncDbFile();
+      EXPECT_EQ(writes + static_cast<int>(num_pages), dm.GetNumWrites());
 
-  std::memset(buf, 0, sizeof(buf));
-  dm.WritePage(5, data);
-  dm.ReadPage(5, buf);
-  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      alignas(PAGE_SIZE) char buf[PAGE_SIZE];
+      for (size_t i = 0; i < num_pages; i++) {
+        dm.ReadPage(static_cast<page_id_t>(2 + i), buf);
+        EXPECT_EQ(0, std::memcmp(buf, pages[i], PAGE_SIZE));
+      }
+      dm.ReadPage(1, buf);
+      EXPECT_EQ(0, buf[0]);
+      dm.ShutDown();
+      std::free(data);
+    }
+  }
+}
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  char data[PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager("test.db");
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      EXPECT_EQ(page_id, dm.AllocatePage());
+      dm.WritePage(page_id, data);
+    }
+
+    // Deallocated pages are handed out again, lowest first, before the file grows. A page is deallocated only once.
+    EXPECT_TRUE(dm.DeallocatePage(5));
+    EXPECT_TRUE(dm.DeallocatePage(3));
+    EXPECT_FALSE(dm.DeallocatePage(3));
+    EXPECT_FALSE(dm.DeallocatePage(10));
+    EXPECT_FALSE(dm.IsAllocated(3));
+    EXPECT_EQ(8, dm.GetNumAllocatedPages());
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_TRUE(dm.IsAllocated(3));
+
+    // Page ids that are not eligible are skipped, and stay free for others.
+    auto is_even = [](page_id_t page_id) { return page_id % 2 == 0; };
+    EXPECT_EQ(10, dm.AllocatePage(is_even));
+    EXPECT_EQ(12, dm.AllocatePage(is_even));
+    EXPECT_EQ(5, dm.AllocatePage());
+    EXPECT_EQ(11, dm.AllocatePage());
+    dm.DeallocatePage(7);
+    dm.ShutDown();
+  }
+
+  // Scenario: The allocation map survives a restart.
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_EQ(12, dm.GetNumAllocatedPages());
+    EXPECT_FALSE(dm.IsAllocated(7));
+    EXPECT_TRUE(dm.IsAllocated(12));
+    EXPECT_EQ(7, dm.AllocatePage());
+    EXPECT_EQ(13, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // Scenario: A database file that is created anew does not inherit the allocation map of a removed one.
+  remove("test.db");
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_EQ(0, dm.GetNumAllocatedPages());
+    EXPECT_EQ(0, dm.AllocatePage());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompactTest) {
+  char data[PAGE_SIZE];
+  std::memset(data, 1, sizeof(data));
+  auto dm = DiskManager("test.db");
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+    dm.WritePage(page_id, data);
+  }
+  for (page_id_t page_id = 10; page_id < 20; page_id++) {
+    dm.DeallocatePage(page_id);
+  }
+  dm.DeallocatePage(4);
+
+  // Scenario: The file ends at the last allocated page, at least. Holes are punched where the file system can.
+  EXPECT_GE(dm.Compact(), 10 * PAGE_SIZE);
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_EQ(10 * PAGE_SIZE, stat_buf.st_size);
+
+  // Scenario: The pages that are left are untouched, and page ids keep being handed out lowest first.
+  char buf[PAGE_SIZE];
+  dm.ReadPage(9, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(4, dm.AllocatePage());
+  EXPECT_EQ(10, dm.AllocatePage());
   dm.ShutDown();
 }
 
+/** Overwrite a byte of a page behind the back of the disk manager. */
+static void CorruptPage(page_id_t page_id, size_t offset) {
+  int fd = open("test.db", O_RDWR);
+  ASSERT_NE(-1, fd);
+  char byte;
+  ASSERT_EQ(1, pread(fd, &byte, 1, page_id * PAGE_SIZE + offset));
+  byte ^= 1;
+  ASSERT_EQ(1, pwrite(fd, &byte, 1, page_id * PAGE_SIZE + offset));
+  close(fd);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  alignas(PAGE_SIZE) char data[PAGE_SIZE];
+  alignas(PAGE_SIZE) char buf[PAGE_SIZE];
+  std::memset(data, 'x', sizeof(data));
+  for (auto backend :
+       {DiskManager::Backend::FSTREAM, DiskManager::Backend::PREAD, DiskManager::Backend::PREAD_DIRECT}) {
+    remove("test.db");
+    {
+      auto dm = DiskManager("test.db", backend, true);
+      EXPECT_TRUE(dm.UsesChecksums());
+      dm.WritePage(0, data);
+      dm.WritePages(1, {data, data});
+      EXPECT_TRUE(dm.SubmitWritePage(3, data).get());
+      for (page_id_t page_id = 0; page_id < 4; page_id++) {
+        EXPECT_TRUE(dm.ReadPage(page_id, buf));
+      }
+      // A page that was never written has no checksum to fail.
+      EXPECT_TRUE(dm.ReadPage(10, buf));
+      dm.ShutDown();
+    }
+
+    // Scenario: a page that changed on disk fails its checksum after a restart, through every way of reading it.
+    CorruptPage(1, 100);
+    CorruptPage(3, PAGE_SIZE - 1);
+    {
+      auto dm = DiskManager("test.db", backend, true);
+      EXPECT_TRUE(dm.ReadPage(0, buf));
+      EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+      EXPECT_FALSE(dm.ReadPage(1, buf));
+      EXPECT_TRUE(dm.ReadPage(2, buf));
+      EXPECT_FALSE(dm.SubmitReadPage(3, buf).get());
+      EXPECT_EQ(2, dm.GetNumChecksumFailures());
+
+      // Scenario: writing the page again gives it a checksum that matches.
+      dm.WritePage(1, data);
+      EXPECT_TRUE(dm.ReadPage(1, buf));
+      dm.ShutDown();
+    }
+
+    // Scenario: opening the database without checksums keeps them, but a page written meanwhile loses its own.
+    {
+      auto dm = DiskManager("test.db", backend);
+      EXPECT_FALSE(dm.UsesChecksums());
+      EXPECT_TRUE(dm.ReadPage(3, buf));
+      std::memset(buf, 'y', sizeof(buf));
+      dm.WritePage(2, buf);
+      dm.ShutDown();
+    }
+    struct stat stat_buf;
+    EXPECT_EQ(0, stat("test.crc", &stat_buf));
+    CorruptPage(0, 0);
+    CorruptPage(2, 0);
+    {
+      auto dm = DiskManager("test.db", backend, true);
+      EXPECT_FALSE(dm.ReadPage(0, buf));
+      EXPECT_TRUE(dm.ReadPage(2, buf));
+      EXPECT_FALSE(dm.ReadPage(3, buf));
+      dm.ShutDown();
+    }
+  }
+}
+
+/** Overwrite a whole page behind the back of the disk manager. */
+static void OverwritePage(page_id_t page_id, const char *data) {
+  int fd = open("test.db", O_RDWR);
+  ASSERT_NE(-1, fd);
+  ASSERT_EQ(PAGE_SIZE, pwrite(fd, data, PAGE_SIZE, page_id * PAGE_SIZE));
+  close(fd);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumCrashTest) {
+  alignas(PAGE_SIZE) char old_data[PAGE_SIZE];
+  alignas(PAGE_SIZE) char new_data[PAGE_SIZE];
+  alignas(PAGE_SIZE) char buf[PAGE_SIZE];
+  std::memset(old_data, 'x', sizeof(old_data));
+  std::memset(new_data, 'y', sizeof(new_data));
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true);
+    dm.WritePages(0, {old_data, old_data, old_data});
+
+    // Scenario: a write of page 1 does not make it to disk, as if the process crashed before it could. Writes past
+    // the first page of a file fail with the file size limit lowered, while the checksum file stays below it.
+    struct rlimit saved_limit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_FSIZE, &saved_limit));
+    struct rlimit limit = saved_limit;
+    limit.rlim_cur = PAGE_SIZE;
+    auto saved_handler = signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &limit));
+    EXPECT_FALSE(dm.WritePage(1, new_data));
+    setrlimit(RLIMIT_FSIZE, &saved_limit);
+    signal(SIGXFSZ, saved_handler);
+    EXPECT_TRUE(dm.ReadPage(1, buf));
+    EXPECT_EQ(0, std::memcmp(buf, old_data, sizeof(buf)));
+    dm.ShutDown();
+  }
+
+  // Scenario: after a restart, the page matches both what it held before the write and what the write wrote.
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true);
+    EXPECT_TRUE(dm.ReadPage(1, buf));
+    dm.ShutDown();
+  }
+  OverwritePage(1, new_data);
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true);
+    EXPECT_TRUE(dm.ReadPage(1, buf));
+    EXPECT_EQ(0, std::memcmp(buf, new_data, sizeof(buf)));
+    dm.ShutDown();
+  }
+  // Scenario: a torn page matches neither.
+  CorruptPage(1, PAGE_SIZE / 2);
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true);
+    EXPECT_FALSE(dm.ReadPage(1, buf));
+    dm.ShutDown();
+  }
+
+  // Scenario: once a write has completed, the page only matches what it wrote.
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true);
+    EXPECT_TRUE(dm.WritePage(2, new_data));
+    dm.ShutDown();
+  }
+  OverwritePage(2, old_data);
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true);
+    EXPECT_FALSE(dm.ReadPage(2, buf));
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ChecksumBenchmark) {
+  // Read throughput of 16MB of pages, without and with checksums. The pages are in the OS page cache after the first
+  // round, so this is the worst case for checksums: with reads that go to the disk their share is far smaller.
+  const size_t num_pages = 4096;
+  const int rounds = 5;
+  alignas(PAGE_SIZE) char buf[PAGE_SIZE];
+  for (auto backend : {DiskManager::Backend::PREAD, DiskManager::Backend::PREAD_DIRECT}) {
+    double pages_per_sec[2];
+    for (bool checksums : {false, true}) {
+      remove("test.db");
+      auto dm = DiskManager("test.db", backend, checksums);
+      for (size_t i = 0; i < num_pages; i++) {
+        std::memset(buf, static_cast<int>(i), sizeof(buf));
+        dm.WritePage(static_cast<page_id_t>(i), buf);
+      }
+      auto start = std::chrono::steady_clock::now();
+      for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < num_pages; i++) {
+          ASSERT_TRUE(dm.ReadPage(static_cast<page_id_t>(i), buf));
+        }
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      pages_per_sec[checksums ? 1 : 0] = rounds * num_pages / elapsed.count();
+      dm.ShutDown();
+    }
+    printf("%s reads: %.0f pages/sec without checksums, %.0f pages/sec with checksums (%.1f%% slower)\n",
+           backend == DiskManager::Backend::PREAD ? "buffered" : "direct", pages_per_sec[0], pages_per_sec[1],
+           (1 - pages_per_sec[1] / pages_per_sec[0]) * 100);
+  }
+
+  // The cost of a checksum on its own.
+  const size_t num_checksums = 100000;
+  uint32_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_checksums; i++) {
+    checksum = ChecksumUtil::Crc32c(buf, PAGE_SIZE, checksum);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("crc32c of a page: %.0f ns (%u)\n", elapsed.count() * 1e9 / num_checksums, checksum);
+}
+
+/** Fill a page with rows of small integers and repeated strings, the way a table page of ours looks. */
+static void FillWithRows(char *page_data, uint32_t seed) {
+  static const char *names[] = {"alice", "bob", "carol", "dave", "eve"};
+  std::memset(page_data, 0, PAGE_SIZE);
+  for (uint32_t offset = 0, row = 0; offset + 24 <= PAGE_SIZE; offset += 24, row++) {
+    uint32_t id = seed * 1000 + row;
+    uint32_t value = (id * 2654435761U) % 100;
+    std::memcpy(page_data + offset, &id, sizeof(id));
+    std::memcpy(page_data + offset + 4, &value, sizeof(value));
+    std::strncpy(page_data + offset + 8, names[id % 5], 16);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressionTest) {
+  alignas(PAGE_SIZE) char data[PAGE_SIZE];
+  alignas(PAGE_SIZE) char buf[PAGE_SIZE];
+  alignas(PAGE_SIZE) char random[PAGE_SIZE];
+  for (size_t i = 0; i < PAGE_SIZE; i++) {
+    random[i] = static_cast<char>((i * 2654435761U) >> 13);
+  }
+  const page_id_t num_pages = 20;
+  {
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD_DIRECT, true, true);
+    EXPECT_TRUE(dm.IsCompressed());
+    EXPECT_EQ(DiskManager::Backend::PREAD, dm.GetBackend());
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      EXPECT_EQ(page_id, dm.AllocatePage());
+      FillWithRows(data, page_id);
+      dm.WritePage(page_id, data);
+    }
+    // A page that does not compress is stored as it is, and a page that grows moves.
+    dm.WritePage(3, random);
+    EXPECT_TRUE(dm.SubmitWritePage(4, random).get());
+    dm.WritePages(5, {random, data});
+    dm.ShutDown();
+  }
+
+  // Scenario: compressed pages take up less room, and read back as they were written after a restart.
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_GT(num_pages * PAGE_SIZE / 2, stat_buf.st_size);
+  {
+    // Asking for no compression does not change how an existing file is stored.
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, true, false);
+    EXPECT_TRUE(dm.IsCompressed());
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      EXPECT_TRUE(dm.ReadPage(page_id, buf));
+      if (page_id >= 3 && page_id <= 5) {
+        EXPECT_EQ(0, std::memcmp(buf, random, PAGE_SIZE));
+      } else {
+        FillWithRows(data, page_id == 6 ? num_pages - 1 : page_id);
+        EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+      }
+    }
+    EXPECT_TRUE(dm.SubmitReadPage(7, buf).get());
+    EXPECT_TRUE(dm.ReadPage(num_pages + 3, buf));
+    EXPECT_EQ(0, buf[0]);
+    EXPECT_GT(num_pages * PAGE_SIZE / 2, dm.GetNumBytesRead());
+
+    // Scenario: the room of deallocated pages is reused, and compaction gives back what is left at the end.
+    for (page_id_t page_id = 10; page_id < num_pages; page_id++) {
+      dm.DeallocatePage(page_id);
+    }
+    dm.DeallocatePage(3);
+    EXPECT_TRUE(dm.ReadPage(3, buf));
+    EXPECT_EQ(0, buf[0]);
+    EXPECT_LT(0, dm.Compact());
+    EXPECT_EQ(3, dm.AllocatePage());
+    FillWithRows(data, 3);
+    dm.WritePage(3, data);
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      EXPECT_TRUE(dm.ReadPage(page_id, buf));
+    }
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+    dm.ShutDown();
+  }
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_GT(10 * PAGE_SIZE / 2, stat_buf.st_size);
+
+  // Scenario: a database file that is created anew is compressed only if asked to be.
+  remove("test.db");
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_FALSE(dm.IsCompressed());
+    dm.ShutDown();
+  }
+  EXPECT_NE(0, stat("test.map", &stat_buf));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_CompressionBenchmark) {
+  // Bytes read from the file and read throughput for pages full of rows, stored as they are and compressed. The file
+  // is in the OS page cache, so this shows the cost of decompressing rather than what the smaller reads save.
+  const size_t num_pages = 4096;
+  const int rounds = 5;
+  alignas(PAGE_SIZE) char buf[PAGE_SIZE];
+  for (bool compression : {false, true}) {
+    remove("test.db");
+    auto dm = DiskManager("test.db", DiskManager::Backend::PREAD, false, compression);
+    for (size_t i = 0; i < num_pages; i++) {
+      FillWithRows(buf, static_cast<uint32_t>(i));
+      dm.WritePage(static_cast<page_id_t>(i), buf);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+      for (size_t i = 0; i < num_pages; i++) {
+        ASSERT_TRUE(dm.ReadPage(static_cast<page_id_t>(i), buf));
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s: %.0f bytes read per page, %.0f pages/sec\n", compression ? "compressed" : "uncompressed",
+           static_cast<double>(dm.GetNumBytesRead()) / (rounds * num_pages), rounds * num_pages / elapsed.count());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const size_t num_pages = 100;
+  for (auto backend :
+       {DiskManager::Backend::FSTREAM, DiskManager::Backend::PREAD, DiskManager::Backend::PREAD_DIRECT}) {
+    remove("test.db");
+    auto *buf = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, (num_pages + 1) * PAGE_SIZE));
+    auto *data = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE));
+    for (size_t i = 0; i < num_pages * PAGE_SIZE; i++) {
+      data[i] = static_cast<char>(i % 251);
+    }
+    std::string db_file("test.db");
+    auto dm = DiskManager(db_file, backend);
+
+    std::vector<std::future<bool>> futures;
+    for (size_t i = 0; i < num_pages; i++) {
+      futures.push_back(dm.SubmitWritePage(i, data + i * PAGE_SIZE));
+    }
+    for (auto &future : futures) {
+      EXPECT_TRUE(future.get());
+    }
+    futures.clear();
+
+    std::memset(buf, 1, (num_pages + 1) * PAGE_SIZE);
+    std::atomic<size_t> num_read{0};
+    for (size_t i = 0; i < num_pages; i++) {
+      dm.SubmitReadPage(i, buf + i * PAGE_SIZE, [&num_read](bool success) {
+        EXPECT_TRUE(success);
+        num_read++;
+      });
+    }
+    // A page past the end of the file reads as zeros.
+    char *past_end = buf + num_pages * PAGE_SIZE;
+    futures.push_back(dm.SubmitReadPage(num_pages + 1, past_end));
+    EXPECT_TRUE(futures.back().get());
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+      ASSERT_EQ(0, past_end[i]);
+    }
+
+    // Shutting down waits for outstanding I/O.
+    dm.ShutDown();
+    EXPECT_EQ(num_pages, num_read);
+    EXPECT_EQ(std::memcmp(buf, data, num_pages * PAGE_SIZE), 0);
+    std::free(buf);
+    std::free(data);
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
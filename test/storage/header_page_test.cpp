@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// header_page_test.cpp
+//
+// Identification: test/storage/header_page_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HeaderPageTest, SampleTest) {
+  Page page{};
+  auto *header_page = static_cast<HeaderPage *>(&page);
+
+  // Scenario: records can be inserted once per name.
+  header_page->Init();
+  EXPECT_TRUE(header_page->InsertRecord("foo", 1));
+  EXPECT_TRUE(header_page->InsertRecord("bar", 2));
+  EXPECT_TRUE(header_page->InsertRecord("baz", 3));
+  EXPECT_FALSE(header_page->InsertRecord("bar", 4));
+  EXPECT_EQ(3, header_page->GetRecordCount());
+
+  // Scenario: records can be looked up, updated and deleted.
+  page_id_t root_id;
+  EXPECT_TRUE(header_page->GetRootId("bar", &root_id));
+  EXPECT_EQ(2, root_id);
+  EXPECT_TRUE(header_page->UpdateRecord("bar", 5));
+  EXPECT_TRUE(header_page->DeleteRecord("foo"));
+  EXPECT_FALSE(header_page->GetRootId("foo", &root_id));
+  EXPECT_TRUE(header_page->GetRootId("bar", &root_id));
+  EXPECT_EQ(5, root_id);
+  EXPECT_TRUE(header_page->GetRootId("baz", &root_id));
+  EXPECT_EQ(3, root_id);
+  EXPECT_EQ(2, header_page->GetRecordCount());
+}
+
+// NOLINTNEXTLINE
+TEST(HeaderPageTest, PageSizeTest) {
+  Page page{};
+  auto *header_page = static_cast<HeaderPage *>(&page);
+
+  // Scenario: a header page written before the page size was recorded is taken to match this build.
+  EXPECT_EQ(PAGE_SIZE, header_page->GetPageSize());
+
+  // Scenario: the page size is recorded at the end of the smallest page, and records stop short of it.
+  header_page->Init();
+  int page_size;
+  memcpy(&page_size, page.GetData() + 4092, sizeof(page_size));
+  EXPECT_EQ(PAGE_SIZE, page_size);
+  int record_count = 0;
+  while (header_page->InsertRecord("index_" + std::to_string(record_count), record_count + 1)) {
+    record_count++;
+  }
+  EXPECT_EQ(113, record_count);
+  EXPECT_EQ(PAGE_SIZE, header_page->GetPageSize());
+
+  // Scenario: another recorded page size is reported as it is.
+  page_size = PAGE_SIZE * 2;
+  memcpy(page.GetData() + 4092, &page_size, sizeof(page_size));
+  EXPECT_EQ(PAGE_SIZE * 2, header_page->GetPageSize());
+}
+
+}  // namespace bustub
@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_test.cpp
+//
+// Identification: test/table/free_space_map_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/table/free_space_map.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, FindAndUpdateTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  FreeSpaceMap fsm(bpm);
+
+  EXPECT_EQ(INVALID_PAGE_ID, fsm.GetFirstPageId());
+  EXPECT_EQ(INVALID_PAGE_ID, fsm.FindPage(1));
+
+  fsm.UpdatePage(100, 10);
+  fsm.UpdatePage(101, 2000);
+  fsm.UpdatePage(102, 500);
+  EXPECT_NE(INVALID_PAGE_ID, fsm.GetFirstPageId());
+  EXPECT_EQ(102, fsm.GetLastTablePageId());
+
+  // The first page with enough room wins, and free space is never overestimated.
+  EXPECT_EQ(101, fsm.FindPage(400));
+  EXPECT_EQ(101, fsm.FindPage(1900));
+  EXPECT_EQ(INVALID_PAGE_ID, fsm.FindPage(2001));
+
+  fsm.UpdatePage(101, 0);
+  EXPECT_EQ(102, fsm.FindPage(400));
+
+  // The map survives being reopened from its first page.
+  FreeSpaceMap reopened(bpm);
+  reopened.Open(fsm.GetFirstPageId());
+  EXPECT_EQ(fsm.GetFirstPageId(), reopened.GetFirstPageId());
+  EXPECT_EQ(102, reopened.GetLastTablePageId());
+  EXPECT_EQ(102, reopened.FindPage(400));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, TableHeapReuseTest) {
+  Column col{"a", TypeId::VARCHAR, 200};
+  Schema schema{std::vector<Column>{col}};
+  std::vector<Value> values{ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+  Tuple tuple(values, &schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+
+  std::vector<RID> rids;
+  std::set<page_id_t> table_pages;
+  // Enough tuples for a handful of pages, whatever the page size.
+  const int num_tuples = 200 * PAGE_SIZE / 4096;
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rids.push_back(rid);
+    table_pages.insert(rid.GetPageId());
+  }
+  ASSERT_GT(table_pages.size(), 5);
+
+  // Free up the first page; new tuples should land there rather than at the end of the heap.
+  page_id_t first_page_id = table->GetFirstPageId();
+  size_t deleted_count = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == first_page_id) {
+      table->ApplyDelete(rid, transaction);
+      deleted_count++;
+    }
+  }
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  EXPECT_EQ(first_page_id, rid.GetPageId());
+
+  // Reopening the heap finds its free space map again.
+  delete table;
+  table = new TableHeap(bpm, lock_manager, nullptr, first_page_id);
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  EXPECT_EQ(first_page_id, rid.GetPageId());
+
+  size_t tuple_count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    tuple_count++;
+  }
+  EXPECT_EQ(rids.size() - deleted_count + 2, tuple_count);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+  delete table;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, LegacyTableTest) {
+  Column col{"a", TypeId::VARCHAR, 200};
+  Schema schema{std::vector<Column>{col}};
+  std::vector<Value> values{ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+  Tuple tuple(values, &schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  RID rid;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  delete table;
+
+  // Scenario: table pages keep the layout they had before free space maps: the slot of the first tuple follows the
+  // 24 byte header. A first page without a map is what a table from before free space maps looks like.
+  {
+    auto guard = bpm->FetchPageWrite(first_page_id);
+    auto *first_page = static_cast<TablePage *>(guard.GetPage());
+    EXPECT_EQ(PAGE_SIZE - tuple.GetLength(), *reinterpret_cast<uint32_t *>(first_page->GetData() + 24));
+    first_page->SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+    guard.SetDirty();
+  }
+
+  // Scenario: such a table opens with a rebuilt map, which is recorded in its first page.
+  table = new TableHeap(bpm, lock_manager, nullptr, first_page_id);
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  {
+    auto guard = bpm->FetchPageRead(first_page_id);
+    EXPECT_NE(INVALID_PAGE_ID, static_cast<TablePage *>(guard.GetPage())->GetFreeSpaceMapPageId());
+  }
+  size_t tuple_count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    tuple_count++;
+  }
+  EXPECT_EQ(101, tuple_count);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+  delete table;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+}
+
+}  // namespace bustub
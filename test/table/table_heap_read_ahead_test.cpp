@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_read_ahead_test.cpp
+//
+// Identification: test/table/table_heap_read_ahead_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fill a new table with num_tuples tuples of about 200 bytes, about 19 of which fit on a page. */
+TableHeap *CreateTable(BufferPoolManager *bpm, LockManager *lock_manager, Transaction *txn, size_t num_tuples) {
+  Column col{"a", TypeId::VARCHAR, 200};
+  Schema schema{std::vector<Column>{col}};
+  std::vector<Value> values{ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+  Tuple tuple(values, &schema);
+
+  auto table = new TableHeap(bpm, lock_manager, nullptr, txn);
+  for (size_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(tuple, &rid, txn));
+  }
+  return table;
+}
+
+/**
+ * Scan the whole table.
+ * @param[out] num_pages the number of pages the tuples were on
+ * @return the number of tuples
+ */
+size_t Scan(TableHeap *table, Transaction *txn, size_t *num_pages) {
+  size_t num_tuples = 0;
+  std::set<page_id_t> page_ids;
+  for (auto itr = table->Begin(txn); itr != table->End(); ++itr) {
+    page_ids.insert(itr->GetRid().GetPageId());
+    num_tuples++;
+  }
+  *num_pages = page_ids.size();
+  return num_tuples;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TableHeapReadAheadTest, ScanTest) {
+  const size_t buffer_pool_size = 40;
+  // The table spans more pages than the buffer pool has frames, whatever the page size.
+  const size_t num_tuples = 2000 * PAGE_SIZE / 4096;
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = CreateTable(bpm, lock_manager, transaction, num_tuples);
+
+  // The window is capped to a quarter of the buffer pool.
+  table->SetReadAheadPages(100);
+  EXPECT_EQ(buffer_pool_size / 4, table->GetReadAheadPages());
+
+  size_t num_pages;
+  auto prefetches_before = bpm->GetStats().prefetches_;
+  EXPECT_EQ(num_tuples, Scan(table, transaction, &num_pages));
+  EXPECT_GT(num_pages, buffer_pool_size);
+  EXPECT_GT(bpm->GetStats().prefetches_, prefetches_before);
+
+  // Without read-ahead, the scan sees the same tuples and prefetches nothing.
+  table->SetReadAheadPages(0);
+  prefetches_before = bpm->GetStats().prefetches_;
+  EXPECT_EQ(num_tuples, Scan(table, transaction, &num_pages));
+  EXPECT_EQ(prefetches_before, bpm->GetStats().prefetches_);
+
+  delete table;
+  delete lock_manager;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapReadAheadTest, DISABLED_ScanBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_tuples = 20000;
+
+  // Direct I/O, so that every page the scan misses really comes from the disk rather than the OS page cache.
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db", DiskManager::Backend::PREAD_DIRECT);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = CreateTable(bpm, lock_manager, transaction, num_tuples);
+  bpm->FlushAllPages();
+
+  for (size_t read_ahead_pages : {0, 4, 16}) {
+    table->SetReadAheadPages(read_ahead_pages);
+    size_t num_pages;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_tuples, Scan(table, transaction, &num_pages));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("sequential scan, read-ahead %zu pages: %zu pages, %.0f pages/sec\n", table->GetReadAheadPages(), num_pages,
+           static_cast<double>(num_pages) / elapsed.count());
+  }
+
+  delete table;
+  delete lock_manager;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.alloc");
+  delete disk_manager;
+  delete transaction;
+}
+
+}  // namespace bustub
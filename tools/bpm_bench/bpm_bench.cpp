@@ -0,0 +1,384 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bpm_bench.cpp
+//
+// Identification: tools/bpm_bench/bpm_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/exception.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+/** The settings of a benchmark run, see Usage(). */
+struct BenchOptions {
+  std::string db_file_{"bench.db"};
+  std::string bpm_{"instance"};
+  size_t num_instances_{4};
+  size_t pool_size_{1024};
+  std::string replacer_{"lru"};
+  std::string backend_{"pread"};
+  size_t num_pages_{8192};
+  std::string workload_{"uniform"};
+  double zipf_theta_{0.99};
+  double scan_fraction_{0.01};
+  size_t scan_length_{64};
+  double write_fraction_{0.0};
+  size_t num_threads_{1};
+  size_t num_ops_{100000};
+  uint64_t seed_{0};
+};
+
+void Usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--option=value ...]\n"
+          "  --db=FILE                 database file, created and removed by the run (bench.db)\n"
+          "  --bpm=instance|parallel   BufferPoolManagerInstance or ParallelBufferPoolManager (instance)\n"
+          "  --instances=N             instances of a parallel buffer pool (4)\n"
+          "  --pool-size=N             frames per instance (1024)\n"
+          "  --replacer=lru|clock|lru_k|two_q (lru)\n"
+          "  --backend=fstream|pread|pread_direct (pread)\n"
+          "  --pages=N                 pages in the database file (8192)\n"
+          "  --workload=uniform|zipfian|scan\n"
+          "                            which pages are fetched: uniformly at random, zipfian distributed, or\n"
+          "                            uniformly with some operations scanning consecutive pages (uniform)\n"
+          "  --theta=X                 skew of the zipfian workload (0.99)\n"
+          "  --scan-fraction=X         fraction of operations that are scans in the scan workload (0.01)\n"
+          "  --scan-length=N           pages per scan (64)\n"
+          "  --write-fraction=X        fraction of fetches that modify the page (0)\n"
+          "  --threads=N               threads fetching pages (1)\n"
+          "  --ops=N                   operations per thread (100000)\n"
+          "  --seed=N                  random seed (0)\n",
+          program);
+}
+
+bool ParseReplacer(const std::string &name, ReplacerType *replacer_type) {
+  static const std::map<std::string, ReplacerType> replacer_types{{"lru", ReplacerType::LRU},
+                                                                   {"clock", ReplacerType::CLOCK},
+                                                                   {"lru_k", ReplacerType::LRU_K},
+                                                                   {"two_q", ReplacerType::TWO_Q}};
+  auto it = replacer_types.find(name);
+  if (it == replacer_types.end()) {
+    return false;
+  }
+  *replacer_type = it->second;
+  return true;
+}
+
+bool ParseBackend(const std::string &name, DiskManager::Backend *backend) {
+  static const std::map<std::string, DiskManager::Backend> backends{{"fstream", DiskManager::Backend::FSTREAM},
+                                                                    {"pread", DiskManager::Backend::PREAD},
+                                                                    {"pread_direct",
+                                                                     DiskManager::Backend::PREAD_DIRECT}};
+  auto it = backends.find(name);
+  if (it == backends.end()) {
+    return false;
+  }
+  *backend = it->second;
+  return true;
+}
+
+bool ParseOptions(int argc, char **argv, BenchOptions *options) {
+  std::map<std::string, std::string> values;
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    auto equals = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || equals == std::string::npos) {
+      return false;
+    }
+    values[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+  }
+  try {
+    for (const auto &[name, value] : values) {
+      if (name == "db") {
+        options->db_file_ = value;
+      } else if (name == "bpm") {
+        options->bpm_ = value;
+      } else if (name == "instances") {
+        options->num_instances_ = std::stoul(value);
+      } else if (name == "pool-size") {
+        options->pool_size_ = std::stoul(value);
+      } else if (name == "replacer") {
+        options->replacer_ = value;
+      } else if (name == "backend") {
+        options->backend_ = value;
+      } else if (name == "pages") {
+        options->num_pages_ = std::stoul(value);
+      } else if (name == "workload") {
+        options->workload_ = value;
+      } else if (name == "theta") {
+        options->zipf_theta_ = std::stod(value);
+      } else if (name == "scan-fraction") {
+        options->scan_fraction_ = std::stod(value);
+      } else if (name == "scan-length") {
+        options->scan_length_ = std::stoul(value);
+      } else if (name == "write-fraction") {
+        options->write_fraction_ = std::stod(value);
+      } else if (name == "threads") {
+        options->num_threads_ = std::stoul(value);
+      } else if (name == "ops") {
+        options->num_ops_ = std::stoul(value);
+      } else if (name == "seed") {
+        options->seed_ = std::stoull(value);
+      } else {
+        return false;
+      }
+    }
+  } catch (const std::exception &e) {
+    return false;
+  }
+  ReplacerType replacer_type;
+  DiskManager::Backend backend;
+  return ParseReplacer(options->replacer_, &replacer_type) && ParseBackend(options->backend_, &backend) &&
+         (options->bpm_ == "instance" || options->bpm_ == "parallel") && options->num_instances_ > 0 &&
+         options->pool_size_ > 0 && options->num_pages_ > 0 && options->num_threads_ > 0 &&
+         (options->workload_ == "uniform" || options->workload_ == "zipfian" || options->workload_ == "scan") &&
+         options->zipf_theta_ > 0 && options->zipf_theta_ < 1 && options->scan_length_ > 0;
+}
+
+/**
+ * Draws ranks from 0 to n - 1 with probability proportional to 1 / (rank + 1)^theta, as the YCSB benchmark does
+ * (Gray et al., "Quickly Generating Billion-Record Synthetic Databases"). Rank 0 is the most popular.
+ */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(size_t n, double theta) : n_(n), theta_(theta) {
+    double zeta_2 = 0;
+    for (size_t i = 1; i <= n_; i++) {
+      zeta_n_ += 1 / std::pow(static_cast<double>(i), theta_);
+      if (i == 2) {
+        zeta_2 = zeta_n_;
+      }
+    }
+    alpha_ = 1 / (1 - theta_);
+    eta_ = (1 - std::pow(2.0 / static_cast<double>(n_), 1 - theta_)) / (1 - zeta_2 / zeta_n_);
+  }
+
+  size_t Next(std::mt19937_64 *generator) const {
+    double u = std::uniform_real_distribution<double>(0, 1)(*generator);
+    double uz = u * zeta_n_;
+    if (uz < 1) {
+      return 0;
+    }
+    if (uz < 1 + std::pow(0.5, theta_)) {
+      return std::min<size_t>(1, n_ - 1);
+    }
+    auto rank = static_cast<size_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1, alpha_));
+    return std::min(rank, n_ - 1);
+  }
+
+ private:
+  size_t n_;
+  double theta_;
+  double zeta_n_{0};
+  double alpha_;
+  double eta_;
+};
+
+/** What a benchmark thread measured. */
+struct ThreadResult {
+  /** Latency of every page fetch, including the unpin, in nanoseconds. */
+  std::vector<uint64_t> latencies_;
+  size_t num_failed_fetches_{0};
+};
+
+/** Fetch a page, read or modify it, and unpin it. */
+void AccessPage(BufferPoolManager *bpm, page_id_t page_id, bool write, ThreadResult *result) {
+  auto start = std::chrono::steady_clock::now();
+  Page *page = bpm->FetchPage(page_id);
+  if (page == nullptr) {
+    result->num_failed_fetches_++;
+    return;
+  }
+  if (write) {
+    page->WLatch();
+    page->GetData()[sizeof(page_id_t)]++;
+    page->WUnlatch();
+  } else {
+    page->RLatch();
+    volatile char byte = page->GetData()[sizeof(page_id_t)];
+    (void)byte;
+    page->RUnlatch();
+  }
+  bpm->UnpinPage(page_id, write);
+  result->latencies_.push_back(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void RunThread(BufferPoolManager *bpm, const BenchOptions &options, const ZipfianGenerator *zipfian,
+               const std::vector<page_id_t> &page_ids, size_t thread_index, std::atomic<bool> *start,
+               ThreadResult *result) {
+  std::mt19937_64 generator(options.seed_ * 1000003 + thread_index);
+  std::uniform_int_distribution<size_t> uniform(0, page_ids.size() - 1);
+  std::uniform_real_distribution<double> coin(0, 1);
+  result->latencies_.reserve(options.workload_ == "scan"
+                                 ? static_cast<size_t>(options.num_ops_ *
+                                                       (1 + options.scan_fraction_ * options.scan_length_))
+                                 : options.num_ops_);
+  while (!start->load()) {
+    std::this_thread::yield();
+  }
+  for (size_t op = 0; op < options.num_ops_; op++) {
+    bool write = coin(generator) < options.write_fraction_;
+    if (options.workload_ == "zipfian") {
+      AccessPage(bpm, page_ids[zipfian->Next(&generator)], write, result);
+    } else if (options.workload_ == "scan" && coin(generator) < options.scan_fraction_) {
+      size_t first = uniform(generator);
+      for (size_t i = 0; i < options.scan_length_; i++) {
+        AccessPage(bpm, page_ids[(first + i) % page_ids.size()], write, result);
+      }
+    } else {
+      AccessPage(bpm, page_ids[uniform(generator)], write, result);
+    }
+  }
+}
+
+/** Remove the database file and the files the DiskManager keeps next to it. */
+void RemoveDbFiles(const std::string &db_file) {
+  remove(db_file.c_str());
+  auto base = db_file.substr(0, db_file.rfind('.'));
+  for (const char *suffix : {".log", ".alloc", ".crc", ".map"}) {
+    remove((base + suffix).c_str());
+  }
+}
+
+int RunBenchmark(const BenchOptions &options) {
+  ReplacerType replacer_type;
+  DiskManager::Backend backend;
+  ParseReplacer(options.replacer_, &replacer_type);
+  ParseBackend(options.backend_, &backend);
+  RemoveDbFiles(options.db_file_);
+
+  int exit_code = 0;
+  {
+    DiskManager disk_manager(options.db_file_, backend);
+    std::unique_ptr<BufferPoolManager> bpm;
+    if (options.bpm_ == "parallel") {
+      bpm = std::make_unique<ParallelBufferPoolManager>(options.num_instances_, options.pool_size_, &disk_manager,
+                                                        nullptr, replacer_type);
+    } else {
+      bpm = std::make_unique<BufferPoolManagerInstance>(options.pool_size_, &disk_manager, nullptr, replacer_type);
+    }
+
+    // Create the pages, each holding its page id.
+    std::vector<page_id_t> page_ids(options.num_pages_);
+    for (auto &page_id : page_ids) {
+      Page *page = bpm->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception("can't create page");
+      }
+      memcpy(page->GetData(), &page_id, sizeof(page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    bpm->FlushAllPages();
+
+    std::unique_ptr<ZipfianGenerator> zipfian;
+    if (options.workload_ == "zipfian") {
+      zipfian = std::make_unique<ZipfianGenerator>(page_ids.size(), options.zipf_theta_);
+    }
+
+    auto stats_before = bpm->GetStats();
+    auto reads_before = disk_manager.GetNumReads();
+    auto writes_before = disk_manager.GetNumWrites();
+    std::atomic<bool> start{false};
+    std::vector<ThreadResult> results(options.num_threads_);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.num_threads_; i++) {
+      threads.emplace_back(RunThread, bpm.get(), std::cref(options), zipfian.get(), std::cref(page_ids), i, &start,
+                           &results[i]);
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    start.store(true);
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    auto stats = bpm->GetStats();
+    auto num_reads = disk_manager.GetNumReads() - reads_before;
+    auto num_writes = disk_manager.GetNumWrites() - writes_before;
+
+    std::vector<uint64_t> latencies;
+    size_t num_failed_fetches = 0;
+    for (auto &result : results) {
+      latencies.insert(latencies.end(), result.latencies_.begin(), result.latencies_.end());
+      num_failed_fetches += result.num_failed_fetches_;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    // In microseconds.
+    auto percentile = [&latencies](double fraction) {
+      if (latencies.empty()) {
+        return 0.0;
+      }
+      return static_cast<double>(latencies[static_cast<size_t>(fraction * (latencies.size() - 1))]) / 1000;
+    };
+    uint64_t hits = stats.hits_ - stats_before.hits_;
+    uint64_t misses = stats.misses_ - stats_before.misses_;
+
+    printf("%s buffer pool, %zu frames, %s replacer, %s workload, %zu pages, %zu threads\n", options.bpm_.c_str(),
+           bpm->GetPoolSize(), options.replacer_.c_str(), options.workload_.c_str(), options.num_pages_,
+           options.num_threads_);
+    printf("fetches:       %zu in %.3f s, %.0f ops/sec\n", latencies.size(), elapsed.count(),
+           static_cast<double>(latencies.size()) / elapsed.count());
+    printf("latency:       p50 %.2f us, p99 %.2f us\n", percentile(0.5), percentile(0.99));
+    printf("hit ratio:     %.4f (%llu hits, %llu misses)\n",
+           hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses),
+           static_cast<unsigned long long>(hits), static_cast<unsigned long long>(misses));  // NOLINT
+    printf("disk:          %d reads, %d writes\n", num_reads, num_writes);
+    if (num_failed_fetches > 0) {
+      printf("failed:        %zu fetches found no free frame\n", num_failed_fetches);
+      exit_code = 1;
+    }
+
+    bpm.reset();
+    disk_manager.ShutDown();
+  }
+  RemoveDbFiles(options.db_file_);
+  return exit_code;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+/**
+ * Measure the throughput, latency and hit ratio of a buffer pool under a synthetic workload of page fetches.
+ *
+ * Usage: bustub-bench-bpm [--option=value ...], see Usage() for the options.
+ */
+int main(int argc, char **argv) {
+  bustub::BenchOptions options;
+  if (!bustub::ParseOptions(argc, argv, &options)) {
+    bustub::Usage(argv[0]);
+    return 1;
+  }
+  try {
+    return bustub::RunBenchmark(options);
+  } catch (const std::exception &e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// db_compact.cpp
+//
+// Identification: tools/db_compact/db_compact.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+#include "storage/disk/disk_manager.h"
+
+/**
+ * Shrink a database file that no BusTub instance has open: cut it off after its last allocated page, and release the
+ * disk blocks of the deallocated pages before that.
+ *
+ * Usage: bustub-compact <db file>
+ */
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <db file>\n", argv[0]);
+    return 1;
+  }
+  std::string db_file(argv[1]);
+  struct stat stat_buf;
+  if (stat(db_file.c_str(), &stat_buf) != 0) {
+    fprintf(stderr, "%s does not exist\n", db_file.c_str());
+    return 1;
+  }
+  // Blocks as stat() counts them are 512 bytes, whatever the block size of the file system.
+  auto size_before = stat_buf.st_size;
+  auto disk_usage_before = stat_buf.st_blocks * 512;
+
+  // Keep verifying the checksums of a database that has them.
+  auto checksum_file = db_file.substr(0, db_file.rfind('.')) + ".crc";
+  bool checksums = stat(checksum_file.c_str(), &stat_buf) == 0;
+
+  try {
+    bustub::DiskManager disk_manager(db_file, bustub::DiskManager::Backend::PREAD, checksums);
+    auto num_allocated_pages = disk_manager.GetNumAllocatedPages();
+    auto released = disk_manager.Compact();
+    disk_manager.SyncDbFile();
+    disk_manager.ShutDown();
+    printf("%zu allocated pages, %zu bytes released\n", num_allocated_pages, released);
+  } catch (const std::exception &e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+
+  stat(db_file.c_str(), &stat_buf);
+  printf("file size %lld -> %lld bytes, disk usage %lld -> %lld bytes\n", static_cast<long long>(size_before),  // NOLINT
+         static_cast<long long>(stat_buf.st_size), static_cast<long long>(disk_usage_before),                  // NOLINT
+         static_cast<long long>(stat_buf.st_blocks * 512));                                                    // NOLINT
+  return 0;
+}